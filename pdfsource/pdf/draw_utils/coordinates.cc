@@ -123,6 +123,38 @@ gfx::Rect GetSurroundingRect(int page_y,
       page_height + insets.top() + insets.bottom() + bottom_separator);
 }
 
+std::vector<gfx::Rect> GetTilesForRect(const gfx::Rect& rect,
+                                       const gfx::Point& grid_origin,
+                                       int tile_size) {
+  DCHECK_GT(tile_size, 0);
+
+  std::vector<gfx::Rect> tiles;
+  if (rect.IsEmpty())
+    return tiles;
+
+  // Snap the first row and column down to the grid. Use floor division so
+  // rects above or left of `grid_origin` snap correctly too.
+  auto snap_to_grid = [tile_size](int value, int origin) {
+    int offset = value - origin;
+    int cell = offset / tile_size;
+    if (offset % tile_size < 0)
+      --cell;
+    return origin + cell * tile_size;
+  };
+
+  const int first_x = snap_to_grid(rect.x(), grid_origin.x());
+  const int first_y = snap_to_grid(rect.y(), grid_origin.y());
+  for (int y = first_y; y < rect.bottom(); y += tile_size) {
+    for (int x = first_x; x < rect.right(); x += tile_size) {
+      gfx::Rect tile(x, y, tile_size, tile_size);
+      tile.Intersect(rect);
+      DCHECK(!tile.IsEmpty());
+      tiles.push_back(tile);
+    }
+  }
+  return tiles;
+}
+
 gfx::Rect GetLeftFillRect(const gfx::Rect& page_rect,
                           const gfx::Insets& insets,
                           int bottom_separator) {
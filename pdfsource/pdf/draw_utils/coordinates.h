@@ -94,6 +94,16 @@ gfx::Rect GetSurroundingRect(int page_y,
                              int doc_width,
                              int bottom_separator);
 
+// Given `rect` and a square grid of `tile_size` cells anchored at
+// `grid_origin`, all in the same coordinate space, return the pieces of `rect`
+// that fall into each grid cell, in row-major order. Anchoring the grid to a
+// fixed origin (e.g. a page's top-left corner) keeps tile boundaries stable
+// across different dirty rects. Returns an empty vector if `rect` is empty.
+// `tile_size` must be positive.
+std::vector<gfx::Rect> GetTilesForRect(const gfx::Rect& rect,
+                                       const gfx::Point& grid_origin,
+                                       int tile_size);
+
 // Given `page_rect` in document coordinates, `insets`, and `bottom_separator`,
 // return a gfx::Rect object representing the gap on the left side of the page
 // created by insetting the page. I.e. the difference, on the left side, between
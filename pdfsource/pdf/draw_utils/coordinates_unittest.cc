@@ -206,6 +206,46 @@ TEST(CoordinateTest, GetSurroundingRect) {
       GetSurroundingRect(-100, 300, kSingleViewInsets, 200, kBottomSeparator));
 }
 
+TEST(CoordinateTest, GetTilesForRect) {
+  // Empty rect produces no tiles.
+  EXPECT_TRUE(GetTilesForRect(gfx::Rect(), {0, 0}, 256).empty());
+  EXPECT_TRUE(GetTilesForRect(gfx::Rect(10, 10, 0, 50), {0, 0}, 256).empty());
+
+  // Rect within a single grid cell.
+  std::vector<gfx::Rect> tiles =
+      GetTilesForRect(gfx::Rect(10, 20, 30, 40), {0, 0}, 256);
+  ASSERT_EQ(1u, tiles.size());
+  EXPECT_EQ(gfx::Rect(10, 20, 30, 40), tiles[0]);
+
+  // Rect spanning four cells, split in row-major order.
+  tiles = GetTilesForRect(gfx::Rect(50, 60, 100, 100), {0, 0}, 100);
+  ASSERT_EQ(4u, tiles.size());
+  EXPECT_EQ(gfx::Rect(50, 60, 50, 40), tiles[0]);
+  EXPECT_EQ(gfx::Rect(100, 60, 50, 40), tiles[1]);
+  EXPECT_EQ(gfx::Rect(50, 100, 50, 60), tiles[2]);
+  EXPECT_EQ(gfx::Rect(100, 100, 50, 60), tiles[3]);
+
+  // Rect exactly matching the grid.
+  tiles = GetTilesForRect(gfx::Rect(0, 0, 200, 100), {0, 0}, 100);
+  ASSERT_EQ(2u, tiles.size());
+  EXPECT_EQ(gfx::Rect(0, 0, 100, 100), tiles[0]);
+  EXPECT_EQ(gfx::Rect(100, 0, 100, 100), tiles[1]);
+
+  // Grid anchored at an offset origin.
+  tiles = GetTilesForRect(gfx::Rect(10, 10, 100, 50), {30, 5}, 100);
+  ASSERT_EQ(2u, tiles.size());
+  EXPECT_EQ(gfx::Rect(10, 10, 20, 50), tiles[0]);
+  EXPECT_EQ(gfx::Rect(30, 10, 80, 50), tiles[1]);
+
+  // Rect with negative coordinates relative to the grid origin.
+  tiles = GetTilesForRect(gfx::Rect(-150, -20, 100, 40), {0, 0}, 100);
+  ASSERT_EQ(4u, tiles.size());
+  EXPECT_EQ(gfx::Rect(-150, -20, 50, 20), tiles[0]);
+  EXPECT_EQ(gfx::Rect(-100, -20, 50, 20), tiles[1]);
+  EXPECT_EQ(gfx::Rect(-150, 0, 50, 20), tiles[2]);
+  EXPECT_EQ(gfx::Rect(-100, 0, 50, 20), tiles[3]);
+}
+
 TEST(CoordinateTest, GetLeftFillRect) {
   // Testing various rectangles with different positions and sizes.
   gfx::Rect page_rect(10, 20, 400, 500);
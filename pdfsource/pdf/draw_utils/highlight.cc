@@ -0,0 +1,114 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/draw_utils/highlight.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+namespace draw_utils {
+
+namespace {
+
+// Returns `channel * factor / 255`, rounded down, without a division. Exact for
+// inputs up to 255.
+inline uint32_t MultiplyChannel(uint32_t channel, uint32_t factor) {
+  const uint32_t product = channel * factor;
+  return (product + 1 + (product >> 8)) >> 8;
+}
+
+// Tints every pixel of `row`, which is in SkColor layout, with the given color
+// channels. The loop is branch-free integer math, so compilers vectorize it.
+void TintRow(base::span<uint32_t> row,
+             uint32_t red,
+             uint32_t green,
+             uint32_t blue) {
+  for (uint32_t& pixel : row) {
+    pixel = (pixel & 0xFF000000) |
+            (MultiplyChannel((pixel >> 16) & 0xFF, red) << 16) |
+            (MultiplyChannel((pixel >> 8) & 0xFF, green) << 8) |
+            MultiplyChannel(pixel & 0xFF, blue);
+  }
+}
+
+}  // namespace
+
+std::vector<gfx::Rect> GetDisjointRects(base::span<const gfx::Rect> rects) {
+  // Split the rectangles into horizontal bands, at every top and bottom edge.
+  // Within a band, every rectangle spans the full height, so merging their
+  // horizontal extents yields disjoint spans.
+  std::vector<int> edges;
+  edges.reserve(rects.size() * 2);
+  for (const gfx::Rect& rect : rects) {
+    if (rect.IsEmpty())
+      continue;
+    edges.push_back(rect.y());
+    edges.push_back(rect.bottom());
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  std::vector<gfx::Rect> disjoint_rects;
+  std::vector<std::pair<int, int>> spans;
+  for (size_t i = 1; i < edges.size(); ++i) {
+    const int top = edges[i - 1];
+    const int bottom = edges[i];
+
+    spans.clear();
+    for (const gfx::Rect& rect : rects) {
+      if (!rect.IsEmpty() && rect.y() <= top && rect.bottom() >= bottom)
+        spans.emplace_back(rect.x(), rect.right());
+    }
+    std::sort(spans.begin(), spans.end());
+
+    for (size_t j = 0; j < spans.size();) {
+      const int left = spans[j].first;
+      int right = spans[j].second;
+      for (++j; j < spans.size() && spans[j].first <= right; ++j)
+        right = std::max(right, spans[j].second);
+      disjoint_rects.emplace_back(left, top, right - left, bottom - top);
+    }
+  }
+  return disjoint_rects;
+}
+
+void HighlightRects(base::span<const gfx::Rect> rects,
+                    SkColor color,
+                    SkBitmap& image) {
+  if (image.isNull() || !image.getPixels())
+    return;
+
+  DCHECK_EQ(image.colorType(), kN32_SkColorType);
+
+  const gfx::Rect image_rect(image.width(), image.height());
+  std::vector<gfx::Rect> clipped_rects;
+  clipped_rects.reserve(rects.size());
+  for (const gfx::Rect& rect : rects)
+    clipped_rects.push_back(gfx::IntersectRects(rect, image_rect));
+
+  const uint32_t red = SkColorGetR(color);
+  const uint32_t green = SkColorGetG(color);
+  const uint32_t blue = SkColorGetB(color);
+  for (const gfx::Rect& rect : GetDisjointRects(clipped_rects)) {
+    for (int y = rect.y(); y < rect.bottom(); ++y) {
+      // SAFETY: `rect` is within the bounds of `image`.
+      TintRow(UNSAFE_BUFFERS(base::span<uint32_t>(
+                  image.getAddr32(rect.x(), y),
+                  static_cast<size_t>(rect.width()))),
+              red, green, blue);
+    }
+  }
+}
+
+}  // namespace draw_utils
+}  // namespace chrome_pdf
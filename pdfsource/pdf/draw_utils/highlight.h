@@ -0,0 +1,37 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_DRAW_UTILS_HIGHLIGHT_H_
+#define PDF_DRAW_UTILS_HIGHLIGHT_H_
+
+#include <vector>
+
+#include "base/containers/span.h"
+#include "third_party/skia/include/core/SkColor.h"
+
+class SkBitmap;
+
+namespace gfx {
+class Rect;
+}  // namespace gfx
+
+namespace chrome_pdf {
+namespace draw_utils {
+
+// Returns rectangles that cover exactly the same pixels as `rects`, without
+// overlapping each other. Empty rectangles are ignored.
+std::vector<gfx::Rect> GetDisjointRects(base::span<const gfx::Rect> rects);
+
+// Tints the pixels of `image` covered by `rects`, by multiplying each of their
+// color channels with the matching channel of `color`. Pixels covered by more
+// than one rectangle get tinted only once. Alpha is left unchanged, and
+// `rects` get clipped to `image`, which must be an N32 bitmap.
+void HighlightRects(base::span<const gfx::Rect> rects,
+                    SkColor color,
+                    SkBitmap& image);
+
+}  // namespace draw_utils
+}  // namespace chrome_pdf
+
+#endif  // PDF_DRAW_UTILS_HIGHLIGHT_H_
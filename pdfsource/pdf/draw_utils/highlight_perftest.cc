@@ -0,0 +1,144 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/containers/span.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "pdf/draw_utils/highlight.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+namespace draw_utils {
+
+namespace {
+
+constexpr SkColor kHighlightColor = SkColorSetRGB(153, 193, 218);
+
+// A page at high zoom.
+constexpr int kImageSize = 2048;
+
+constexpr int kWarmupRuns = 5;
+constexpr base::TimeDelta kTimeLimit = base::Seconds(2);
+constexpr int kTimeCheckInterval = 5;
+
+// The per-pixel highlighting that HighlightRects() replaced, for comparison.
+// Highlights the rectangles one after another, skipping pixels covered by an
+// earlier one.
+void LegacyHighlightRects(base::span<const gfx::Rect> rects,
+                          SkColor color,
+                          SkBitmap& image) {
+  std::vector<gfx::Rect> highlighted_rects;
+  SkColor4f color_f = SkColor4f::FromColor(color);
+  for (const gfx::Rect& rect : rects) {
+    gfx::Rect new_rect = rect;
+    for (const auto& highlighted : highlighted_rects) {
+      new_rect.Subtract(highlighted);
+    }
+    if (new_rect.IsEmpty()) {
+      continue;
+    }
+
+    std::vector<size_t> overlapping_rect_indices;
+    for (size_t i = 0; i < highlighted_rects.size(); ++i) {
+      if (new_rect.Intersects(highlighted_rects[i])) {
+        overlapping_rect_indices.push_back(i);
+      }
+    }
+
+    highlighted_rects.push_back(new_rect);
+    for (int y = new_rect.y(); y < new_rect.bottom(); ++y) {
+      for (int x = new_rect.x(); x < new_rect.right(); ++x) {
+        bool overlaps = false;
+        for (size_t i : overlapping_rect_indices) {
+          if (highlighted_rects[i].Contains(x, y)) {
+            overlaps = true;
+            break;
+          }
+        }
+        if (overlaps) {
+          continue;
+        }
+
+        // SAFETY: `new_rect` is within the bounds of `image`.
+        base::span<uint8_t> pixel = UNSAFE_BUFFERS(base::span<uint8_t>(
+            reinterpret_cast<uint8_t*>(image.getAddr32(x, y)), 4u));
+        pixel[0] = static_cast<uint8_t>(pixel[0] * color_f.fB);
+        pixel[1] = static_cast<uint8_t>(pixel[1] * color_f.fG);
+        pixel[2] = static_cast<uint8_t>(pixel[2] * color_f.fR);
+      }
+    }
+  }
+}
+
+// Returns the selection rectangles of a fully selected page: one per line of
+// text, each slightly overlapping the next, like PDFium reports them.
+std::vector<gfx::Rect> GetFullPageSelection() {
+  constexpr int kLineHeight = 40;
+  constexpr int kLineOverlap = 4;
+  std::vector<gfx::Rect> rects;
+  for (int y = 0; y + kLineHeight <= kImageSize; y += kLineHeight) {
+    rects.emplace_back(0, y, kImageSize, kLineHeight + kLineOverlap);
+  }
+  return rects;
+}
+
+// Returns find result rectangles scattered over the page: short words, some of
+// them overlapping each other.
+std::vector<gfx::Rect> GetWordSelection() {
+  constexpr int kWordWidth = 120;
+  constexpr int kWordHeight = 40;
+  std::vector<gfx::Rect> rects;
+  for (int y = 0; y + kWordHeight <= kImageSize; y += kWordHeight * 2) {
+    for (int x = 0; x + kWordWidth <= kImageSize; x += kWordWidth) {
+      rects.emplace_back(x, y, kWordWidth + kWordWidth / 4, kWordHeight);
+    }
+  }
+  return rects;
+}
+
+template <typename HighlightFunction>
+void RunHighlightTest(const std::string& story,
+                      const std::vector<gfx::Rect>& rects,
+                      HighlightFunction highlight) {
+  SkBitmap image;
+  image.allocN32Pixels(kImageSize, kImageSize);
+
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    image.eraseColor(SK_ColorWHITE);
+    highlight(rects, kHighlightColor, image);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  perf_test::PerfResultReporter reporter("Highlight", story);
+  reporter.RegisterImportantMetric(".time_per_paint", "us");
+  reporter.AddResult(".time_per_paint", timer.TimePerLap());
+}
+
+}  // namespace
+
+TEST(HighlightPerfTest, FullPageSelection) {
+  RunHighlightTest("full_page_legacy", GetFullPageSelection(),
+                   &LegacyHighlightRects);
+  RunHighlightTest("full_page", GetFullPageSelection(), &HighlightRects);
+}
+
+TEST(HighlightPerfTest, WordSelection) {
+  RunHighlightTest("words_legacy", GetWordSelection(), &LegacyHighlightRects);
+  RunHighlightTest("words", GetWordSelection(), &HighlightRects);
+}
+
+}  // namespace draw_utils
+}  // namespace chrome_pdf
@@ -0,0 +1,121 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/draw_utils/highlight.h"
+
+#include <vector>
+
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+namespace draw_utils {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr SkColor kBackgroundColor = SkColorSetARGB(0xFF, 200, 100, 50);
+constexpr SkColor kTintColor = SkColorSetRGB(153, 193, 218);
+constexpr SkColor kTintedColor = SkColorSetARGB(0xFF, 200 * 153 / 255,
+                                                100 * 193 / 255,
+                                                50 * 218 / 255);
+
+std::vector<gfx::Rect> GetDisjointRectsFor(std::vector<gfx::Rect> rects) {
+  return GetDisjointRects(rects);
+}
+
+SkBitmap MakeImage() {
+  SkBitmap image;
+  image.allocN32Pixels(10, 10);
+  image.eraseColor(kBackgroundColor);
+  return image;
+}
+
+}  // namespace
+
+TEST(HighlightTest, GetDisjointRects) {
+  EXPECT_THAT(GetDisjointRectsFor({}), IsEmpty());
+  EXPECT_THAT(GetDisjointRectsFor({gfx::Rect(), gfx::Rect(5, 5, 0, 10)}),
+              IsEmpty());
+  EXPECT_THAT(GetDisjointRectsFor({gfx::Rect(1, 2, 3, 4)}),
+              ElementsAre(gfx::Rect(1, 2, 3, 4)));
+
+  // Identical rectangles.
+  EXPECT_THAT(
+      GetDisjointRectsFor({gfx::Rect(1, 2, 3, 4), gfx::Rect(1, 2, 3, 4)}),
+      ElementsAre(gfx::Rect(1, 2, 3, 4)));
+
+  // Side by side on the same lines, like selected words.
+  EXPECT_THAT(
+      GetDisjointRectsFor({gfx::Rect(5, 0, 5, 10), gfx::Rect(0, 0, 5, 10)}),
+      ElementsAre(gfx::Rect(0, 0, 10, 10)));
+
+  // Partially overlapping.
+  EXPECT_THAT(
+      GetDisjointRectsFor({gfx::Rect(0, 0, 10, 10), gfx::Rect(5, 5, 10, 10)}),
+      ElementsAre(gfx::Rect(0, 0, 10, 5), gfx::Rect(0, 5, 15, 5),
+                  gfx::Rect(5, 10, 10, 5)));
+
+  // Separate spans within the same band.
+  EXPECT_THAT(
+      GetDisjointRectsFor({gfx::Rect(0, 0, 2, 2), gfx::Rect(4, 0, 2, 2)}),
+      ElementsAre(gfx::Rect(0, 0, 2, 2), gfx::Rect(4, 0, 2, 2)));
+
+  // One rectangle containing another.
+  EXPECT_THAT(
+      GetDisjointRectsFor({gfx::Rect(2, 2, 2, 2), gfx::Rect(0, 0, 6, 6)}),
+      ElementsAre(gfx::Rect(0, 0, 6, 2), gfx::Rect(0, 2, 6, 2),
+                  gfx::Rect(0, 4, 6, 2)));
+}
+
+TEST(HighlightTest, HighlightRects) {
+  const std::vector<gfx::Rect> rects = {gfx::Rect(0, 0, 4, 4)};
+  SkBitmap image = MakeImage();
+  HighlightRects(rects, kTintColor, image);
+
+  EXPECT_EQ(kTintedColor, image.getColor(0, 0));
+  EXPECT_EQ(kTintedColor, image.getColor(3, 3));
+  EXPECT_EQ(kBackgroundColor, image.getColor(4, 3));
+  EXPECT_EQ(kBackgroundColor, image.getColor(3, 4));
+}
+
+TEST(HighlightTest, HighlightOverlappingRectsOnce) {
+  const std::vector<gfx::Rect> rects = {
+      gfx::Rect(0, 0, 4, 4), gfx::Rect(2, 2, 4, 4), gfx::Rect(0, 0, 4, 4)};
+  SkBitmap image = MakeImage();
+  HighlightRects(rects, kTintColor, image);
+
+  EXPECT_EQ(kTintedColor, image.getColor(0, 0));
+  EXPECT_EQ(kTintedColor, image.getColor(3, 3));
+  EXPECT_EQ(kTintedColor, image.getColor(5, 5));
+  EXPECT_EQ(kBackgroundColor, image.getColor(5, 0));
+}
+
+TEST(HighlightTest, HighlightRectsClipsToImage) {
+  const std::vector<gfx::Rect> rects = {gfx::Rect(-5, 8, 20, 20)};
+  SkBitmap image = MakeImage();
+  HighlightRects(rects, kTintColor, image);
+
+  EXPECT_EQ(kTintedColor, image.getColor(0, 8));
+  EXPECT_EQ(kTintedColor, image.getColor(9, 9));
+  EXPECT_EQ(kBackgroundColor, image.getColor(0, 7));
+}
+
+TEST(HighlightTest, HighlightRectsKeepsAlpha) {
+  const std::vector<gfx::Rect> rects = {gfx::Rect(0, 0, 1, 1)};
+  SkBitmap image;
+  image.allocN32Pixels(1, 1);
+  image.eraseColor(SkColorSetARGB(0x80, 0x80, 0x80, 0x80));
+  HighlightRects(rects, SK_ColorBLACK, image);
+
+  EXPECT_EQ(0x80u, SkColorGetA(image.getColor(0, 0)));
+}
+
+}  // namespace draw_utils
+}  // namespace chrome_pdf
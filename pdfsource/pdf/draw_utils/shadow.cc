@@ -10,6 +10,7 @@
 #include <algorithm>
 
 #include "base/check_op.h"
+#include "base/compiler_specific.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
@@ -54,7 +55,7 @@ inline uint8_t ProcessColor(uint8_t src_color,
 }
 
 ShadowMatrix::ShadowMatrix(uint32_t depth, double factor, uint32_t background)
-    : depth_(depth) {
+    : depth_(depth), background_(background) {
   DCHECK_GT(depth_, 0U);
   matrix_.resize(depth_ * depth_);
 
@@ -105,10 +106,24 @@ ShadowMatrix::ShadowMatrix(uint32_t depth, double factor, uint32_t background)
       matrix_[x * depth_ + y] = pixel;
     }
   }
+
+  mirrored_matrix_.reserve(matrix_.size());
+  for (uint32_t y = 0; y < depth_; y++) {
+    base::span<const uint32_t> row = GetRightEdgeRow(y);
+    mirrored_matrix_.insert(mirrored_matrix_.end(), row.rbegin(), row.rend());
+  }
 }
 
 ShadowMatrix::~ShadowMatrix() = default;
 
+base::span<const uint32_t> ShadowMatrix::GetLeftEdgeRow(uint32_t y) const {
+  return base::span(mirrored_matrix_).subspan(y * depth_, depth_);
+}
+
+base::span<const uint32_t> ShadowMatrix::GetRightEdgeRow(uint32_t y) const {
+  return base::span(matrix_).subspan(y * depth_, depth_);
+}
+
 namespace {
 
 void PaintShadow(SkBitmap& image,
@@ -120,6 +135,56 @@ void PaintShadow(SkBitmap& image,
     return;
 
   int32_t depth = static_cast<int32_t>(matrix.depth());
+
+  // Past the left edge and before the right edge, every column of a row has
+  // the same value. Unless the shadow is too narrow for that, paint each row as
+  // copies of the edges with a fill in between.
+  const int32_t left_edge_end = shadow_rc.x() + depth;
+  const int32_t right_edge_start = shadow_rc.right() - depth;
+  if (left_edge_end <= right_edge_start) {
+    for (int32_t y = draw_rc.y(); y < draw_rc.bottom(); y++) {
+      int32_t matrix_y = std::clamp(std::max(depth + shadow_rc.y() - y - 1,
+                                             depth - shadow_rc.bottom() + y),
+                                    0, depth - 1);
+      base::span<const uint32_t> left_edge = matrix.GetLeftEdgeRow(matrix_y);
+      base::span<const uint32_t> right_edge = matrix.GetRightEdgeRow(matrix_y);
+
+      // SAFETY: `draw_rc` is within the bounds of `image`.
+      base::span<uint32_t> row = UNSAFE_BUFFERS(
+          base::span<uint32_t>(image.getAddr32(draw_rc.x(), y),
+                               static_cast<size_t>(draw_rc.width())));
+
+      const int32_t left_edge_columns =
+          std::min(left_edge_end, draw_rc.right()) - draw_rc.x();
+      if (left_edge_columns > 0) {
+        base::span<const uint32_t> pixels = left_edge.subspan(
+            static_cast<size_t>(draw_rc.x() - shadow_rc.x()),
+            static_cast<size_t>(left_edge_columns));
+        std::copy(pixels.begin(), pixels.end(), row.begin());
+      }
+
+      const int32_t middle_begin = std::max(left_edge_end, draw_rc.x());
+      const int32_t middle_end = std::min(right_edge_start, draw_rc.right());
+      if (middle_begin < middle_end) {
+        base::span<uint32_t> pixels =
+            row.subspan(static_cast<size_t>(middle_begin - draw_rc.x()),
+                        static_cast<size_t>(middle_end - middle_begin));
+        std::fill(pixels.begin(), pixels.end(), right_edge[0]);
+      }
+
+      const int32_t right_begin = std::max(right_edge_start, draw_rc.x());
+      if (right_begin < draw_rc.right()) {
+        base::span<const uint32_t> pixels = right_edge.subspan(
+            static_cast<size_t>(right_begin - right_edge_start),
+            static_cast<size_t>(draw_rc.right() - right_begin));
+        std::copy(pixels.begin(), pixels.end(),
+                  row.subspan(static_cast<size_t>(right_begin - draw_rc.x()))
+                      .begin());
+      }
+    }
+    return;
+  }
+
   for (int32_t y = draw_rc.y(); y < draw_rc.bottom(); y++) {
     for (int32_t x = draw_rc.x(); x < draw_rc.right(); x++) {
       int32_t matrix_x = std::max(depth + shadow_rc.x() - x - 1,
@@ -9,6 +9,8 @@
 
 #include <vector>
 
+#include "base/containers/span.h"
+
 class SkBitmap;
 
 namespace gfx {
@@ -20,6 +22,8 @@ namespace draw_utils {
 
 // Shadow Matrix contains matrix for shadow rendering. To reduce amount of
 // calculations user may choose to cache matrix and reuse it if nothing changed.
+// Also holds the matrix rows in the order they get copied into the left and
+// right shadow edges, so drawing a shadow row is a few copies and one fill.
 class ShadowMatrix {
  public:
   // Matrix parameters.
@@ -36,11 +40,23 @@ class ShadowMatrix {
     return matrix_[y * depth_ + x];
   }
 
+  // Returns the `depth()` pixels that start row `y` of a shadow, from the
+  // shadow's left edge inwards.
+  base::span<const uint32_t> GetLeftEdgeRow(uint32_t y) const;
+
+  // Returns the `depth()` pixels that end row `y` of a shadow, up to the
+  // shadow's right edge.
+  base::span<const uint32_t> GetRightEdgeRow(uint32_t y) const;
+
   uint32_t depth() const { return depth_; }
+  uint32_t background() const { return background_; }
 
  private:
   const uint32_t depth_;
+  const uint32_t background_;
   std::vector<uint32_t> matrix_;
+  // `matrix_` with every row reversed.
+  std::vector<uint32_t> mirrored_matrix_;
 };
 
 // Draw shadow on the image using provided ShadowMatrix.
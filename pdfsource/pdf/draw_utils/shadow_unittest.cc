@@ -0,0 +1,99 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/draw_utils/shadow.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+namespace draw_utils {
+
+namespace {
+
+constexpr uint32_t kBackgroundColor = 0xFF525659;
+constexpr uint32_t kUnpaintedColor = 0xFF00FF00;
+
+// Returns the value DrawShadow() is expected to paint at (`x`, `y`), computed
+// one pixel at a time.
+uint32_t GetExpectedShadowPixel(const ShadowMatrix& matrix,
+                                const gfx::Rect& shadow_rc,
+                                int x,
+                                int y) {
+  const int depth = static_cast<int>(matrix.depth());
+  int matrix_x = std::max(depth + shadow_rc.x() - x - 1,
+                          depth - shadow_rc.right() + x);
+  int matrix_y = std::max(depth + shadow_rc.y() - y - 1,
+                          depth - shadow_rc.bottom() + y);
+  return matrix.GetValue(std::clamp(matrix_x, 0, depth - 1),
+                         std::clamp(matrix_y, 0, depth - 1));
+}
+
+void ExpectShadow(const ShadowMatrix& matrix,
+                  const gfx::Rect& shadow_rc,
+                  const gfx::Rect& object_rc,
+                  const gfx::Rect& clip_rc) {
+  SkBitmap image;
+  image.allocN32Pixels(100, 100);
+  image.eraseColor(kUnpaintedColor);
+  DrawShadow(image, shadow_rc, object_rc, clip_rc, matrix);
+
+  const gfx::Rect painted_rc = gfx::IntersectRects(shadow_rc, clip_rc);
+  for (int y = 0; y < image.height(); ++y) {
+    for (int x = 0; x < image.width(); ++x) {
+      uint32_t expected = kUnpaintedColor;
+      if (painted_rc.Contains(x, y) && !object_rc.Contains(x, y))
+        expected = GetExpectedShadowPixel(matrix, shadow_rc, x, y);
+      ASSERT_EQ(expected, *image.getAddr32(x, y)) << "at " << x << "," << y;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ShadowTest, EdgeRows) {
+  ShadowMatrix matrix(/*depth=*/4, /*factor=*/0.5, kBackgroundColor);
+  ASSERT_EQ(4u, matrix.GetLeftEdgeRow(0).size());
+  ASSERT_EQ(4u, matrix.GetRightEdgeRow(0).size());
+  for (uint32_t y = 0; y < matrix.depth(); ++y) {
+    for (uint32_t x = 0; x < matrix.depth(); ++x) {
+      EXPECT_EQ(matrix.GetValue(x, y), matrix.GetRightEdgeRow(y)[x]);
+      EXPECT_EQ(matrix.GetValue(x, y),
+                matrix.GetLeftEdgeRow(y)[matrix.depth() - 1 - x]);
+    }
+  }
+}
+
+TEST(ShadowTest, DrawShadow) {
+  ShadowMatrix matrix(/*depth=*/7, /*factor=*/0.5, kBackgroundColor);
+  const gfx::Rect shadow_rc(10, 10, 60, 70);
+  const gfx::Rect object_rc(15, 14, 50, 62);
+
+  ExpectShadow(matrix, shadow_rc, object_rc, shadow_rc);
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(0, 0, 100, 100));
+
+  // Clipped to parts of edges, corners and the area between the edges.
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(0, 0, 13, 100));
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(12, 12, 30, 30));
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(30, 60, 38, 20));
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(66, 0, 2, 100));
+}
+
+TEST(ShadowTest, DrawShadowNarrowerThanEdges) {
+  // The left and right edges of the shadow overlap.
+  ShadowMatrix matrix(/*depth=*/7, /*factor=*/0.5, kBackgroundColor);
+  const gfx::Rect shadow_rc(10, 10, 12, 40);
+  const gfx::Rect object_rc(13, 13, 6, 34);
+
+  ExpectShadow(matrix, shadow_rc, object_rc, shadow_rc);
+  ExpectShadow(matrix, shadow_rc, object_rc, gfx::Rect(15, 0, 10, 100));
+}
+
+}  // namespace draw_utils
+}  // namespace chrome_pdf
@@ -0,0 +1,58 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/bandwidth_estimator.h"
+
+#include <stdint.h>
+
+#include "base/check.h"
+#include "base/time/time.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// Transfers shorter than this mostly measure the latency of the first bytes.
+constexpr base::TimeDelta kMinTransferDuration = base::Milliseconds(100);
+
+// The weights of the latest sample in the smoothed estimates. Round trip times
+// are smoothed like TCP does, bandwidth reacts faster.
+constexpr double kBandwidthSampleWeight = 0.25;
+constexpr double kRoundTripSampleWeight = 0.125;
+
+}  // namespace
+
+BandwidthEstimator::BandwidthEstimator() = default;
+
+BandwidthEstimator::~BandwidthEstimator() = default;
+
+void BandwidthEstimator::AddRoundTrip(base::TimeDelta round_trip_time) {
+  if (round_trip_time.is_negative())
+    return;
+
+  round_trip_time_ =
+      round_trip_time_.has_value()
+          ? kRoundTripSampleWeight * round_trip_time +
+                (1 - kRoundTripSampleWeight) * round_trip_time_.value()
+          : round_trip_time;
+}
+
+void BandwidthEstimator::AddTransfer(uint64_t bytes,
+                                     base::TimeDelta duration) {
+  if (duration < kMinTransferDuration)
+    return;
+
+  const double bandwidth = bytes / duration.InSecondsF();
+  bandwidth_ = bandwidth_.has_value()
+                   ? kBandwidthSampleWeight * bandwidth +
+                         (1 - kBandwidthSampleWeight) * bandwidth_.value()
+                   : bandwidth;
+}
+
+uint64_t BandwidthEstimator::GetBytesIn(base::TimeDelta duration) const {
+  CHECK(has_estimate());
+  return static_cast<uint64_t>(bandwidth_.value() * duration.InSecondsF());
+}
+
+}  // namespace chrome_pdf
@@ -0,0 +1,55 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_LOADER_BANDWIDTH_ESTIMATOR_H_
+#define PDF_LOADER_BANDWIDTH_ESTIMATOR_H_
+
+#include <stdint.h>
+
+#include <optional>
+
+#include "base/time/time.h"
+
+namespace chrome_pdf {
+
+// Estimates the bandwidth and round trip time of the connections a document
+// gets loaded over, from smoothed samples of completed transfers.
+class BandwidthEstimator {
+ public:
+  BandwidthEstimator();
+  BandwidthEstimator(const BandwidthEstimator&) = delete;
+  BandwidthEstimator& operator=(const BandwidthEstimator&) = delete;
+  ~BandwidthEstimator();
+
+  // Records the time from sending a request to receiving its response
+  // headers.
+  void AddRoundTrip(base::TimeDelta round_trip_time);
+
+  // Records that one connection received `bytes` over `duration`. Ignores
+  // samples that are too short to be meaningful.
+  void AddTransfer(uint64_t bytes, base::TimeDelta duration);
+
+  // Whether both the bandwidth and the round trip time got measured.
+  bool has_estimate() const {
+    return bandwidth_.has_value() && round_trip_time_.has_value();
+  }
+
+  // Returns the number of bytes a connection receives in `duration`. Must only
+  // be called if has_estimate().
+  uint64_t GetBytesIn(base::TimeDelta duration) const;
+
+  // In bytes per second.
+  std::optional<double> bandwidth() const { return bandwidth_; }
+  std::optional<base::TimeDelta> round_trip_time() const {
+    return round_trip_time_;
+  }
+
+ private:
+  std::optional<double> bandwidth_;
+  std::optional<base::TimeDelta> round_trip_time_;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_LOADER_BANDWIDTH_ESTIMATOR_H_
@@ -0,0 +1,55 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/bandwidth_estimator.h"
+
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_pdf {
+
+TEST(BandwidthEstimatorTest, NoEstimate) {
+  BandwidthEstimator estimator;
+  EXPECT_FALSE(estimator.has_estimate());
+
+  estimator.AddRoundTrip(base::Milliseconds(50));
+  EXPECT_FALSE(estimator.has_estimate());
+
+  // Too short to count.
+  estimator.AddTransfer(1000, base::Milliseconds(10));
+  EXPECT_FALSE(estimator.has_estimate());
+  EXPECT_FALSE(estimator.bandwidth());
+
+  estimator.AddTransfer(100000, base::Seconds(1));
+  EXPECT_TRUE(estimator.has_estimate());
+}
+
+TEST(BandwidthEstimatorTest, FirstSamples) {
+  BandwidthEstimator estimator;
+  estimator.AddRoundTrip(base::Milliseconds(80));
+  estimator.AddTransfer(500000, base::Milliseconds(500));
+
+  EXPECT_EQ(base::Milliseconds(80), estimator.round_trip_time());
+  EXPECT_DOUBLE_EQ(1000000, estimator.bandwidth().value());
+  EXPECT_EQ(80000u, estimator.GetBytesIn(base::Milliseconds(80)));
+}
+
+TEST(BandwidthEstimatorTest, Smoothing) {
+  BandwidthEstimator estimator;
+  estimator.AddRoundTrip(base::Milliseconds(100));
+  estimator.AddRoundTrip(base::Milliseconds(20));
+  EXPECT_EQ(base::Milliseconds(90), estimator.round_trip_time());
+
+  estimator.AddTransfer(1000000, base::Seconds(1));
+  estimator.AddTransfer(5000000, base::Seconds(1));
+  EXPECT_DOUBLE_EQ(2000000, estimator.bandwidth().value());
+}
+
+TEST(BandwidthEstimatorTest, IgnoresNegativeRoundTrip) {
+  BandwidthEstimator estimator;
+  estimator.AddRoundTrip(base::Milliseconds(-1));
+  EXPECT_FALSE(estimator.round_trip_time());
+}
+
+}  // namespace chrome_pdf
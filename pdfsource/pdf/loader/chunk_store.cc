@@ -0,0 +1,216 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/chunk_store.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/aligned_memory.h"
+
+namespace chrome_pdf {
+
+struct ChunkStore::Slab {
+  base::span<uint8_t> memory() {
+    if (!heap)
+      return mapping->mutable_bytes();
+
+    // SAFETY: `heap` was allocated with `size` bytes.
+    return UNSAFE_BUFFERS(base::span<uint8_t>(heap.get(), size));
+  }
+
+  size_t size = 0;
+
+  // Exactly one of these holds the memory.
+  std::unique_ptr<uint8_t, base::AlignedFreeDeleter> heap;
+  std::unique_ptr<base::MemoryMappedFile> mapping;
+};
+
+ChunkStore::ChunkStore(size_t chunk_size, size_t chunks_per_slab)
+    : chunk_size_(chunk_size),
+      chunks_per_slab_(chunks_per_slab),
+      slab_size_(chunk_size * chunks_per_slab) {
+  DCHECK_GT(chunk_size_, 0u);
+  DCHECK_GT(chunks_per_slab_, 0u);
+}
+
+ChunkStore::~ChunkStore() = default;
+
+base::span<uint8_t> ChunkStore::GetOrCreateChunk(size_t chunk_index) {
+  if (base::span<uint8_t> chunk = GetContiguousChunk(chunk_index);
+      !chunk.empty()) {
+    return chunk;
+  }
+  DCHECK(!is_contiguous_);
+
+  const size_t slab_index = chunk_index / chunks_per_slab_;
+  auto it = slabs_.find(slab_index);
+  if (it == slabs_.end()) {
+    it = slabs_.emplace(slab_index, CreateSlab(slab_size_)).first;
+  }
+  return it->second->memory().subspan(
+      (chunk_index % chunks_per_slab_) * chunk_size_, chunk_size_);
+}
+
+base::span<const uint8_t> ChunkStore::GetChunk(size_t chunk_index) const {
+  if (base::span<uint8_t> chunk = GetContiguousChunk(chunk_index);
+      !chunk.empty()) {
+    return chunk;
+  }
+
+  auto it = slabs_.find(chunk_index / chunks_per_slab_);
+  if (it == slabs_.end())
+    return {};
+
+  return it->second->memory().subspan(
+      (chunk_index % chunks_per_slab_) * chunk_size_, chunk_size_);
+}
+
+void ChunkStore::SetSpillFile(base::File file) {
+  DCHECK(file.IsValid());
+  spill_file_ = std::move(file);
+  spill_file_size_ = 0;
+}
+
+void ChunkStore::ReserveContiguous(size_t size) {
+  DCHECK(!contiguous_);
+  DCHECK(slabs_.empty());
+
+  contiguous_ = CreateSlab(GetContiguousSize(size));
+}
+
+base::span<const uint8_t> ChunkStore::MakeContiguous(size_t size) {
+  DCHECK(!is_contiguous_);
+
+  // The chunks in the memory ReserveContiguous() reserved are not in
+  // `slabs_`.
+  const size_t reserved_size = contiguous_ ? contiguous_->size : 0;
+  const size_t contiguous_size = GetContiguousSize(size);
+  if (reserved_size < contiguous_size) {
+    // Nothing reserved enough memory, so gather the chunks up now, which holds
+    // them twice until the old memory gets freed.
+    std::unique_ptr<Slab> contiguous = CreateSlab(contiguous_size);
+    if (contiguous_) {
+      contiguous->memory()
+          .first(contiguous_->size)
+          .copy_from(contiguous_->memory());
+    }
+    contiguous_ = std::move(contiguous);
+  }
+
+  base::span<uint8_t> memory = contiguous_->memory();
+  for (const auto& [slab_index, slab] : slabs_) {
+    const size_t slab_offset = slab_index * slab_size_;
+    if (slab_offset >= memory.size())
+      break;
+
+    const size_t begin = std::max(slab_offset, reserved_size);
+    const size_t end = std::min(slab_offset + slab_size_, memory.size());
+    if (begin >= end)
+      continue;
+
+    memory.subspan(begin, end - begin)
+        .copy_from(slab->memory().subspan(begin - slab_offset, end - begin));
+  }
+
+  slabs_.clear();
+  contiguous_size_ = size;
+  is_contiguous_ = true;
+  return contiguous_data();
+}
+
+base::span<const uint8_t> ChunkStore::contiguous_data() const {
+  if (!is_contiguous_)
+    return {};
+
+  return contiguous_->memory().first(contiguous_size_);
+}
+
+void ChunkStore::Clear() {
+  slabs_.clear();
+  contiguous_.reset();
+  contiguous_size_ = 0;
+  is_contiguous_ = false;
+
+  // Reuse the spill file from the start.
+  spill_file_size_ = 0;
+}
+
+size_t ChunkStore::heap_slab_count() const {
+  size_t count = 0;
+  for (const auto& [slab_index, slab] : slabs_) {
+    if (slab->heap)
+      ++count;
+  }
+  return count;
+}
+
+size_t ChunkStore::GetContiguousSize(size_t size) const {
+  // Round up to whole chunks, so that the last chunk can be handed out whole.
+  const size_t chunk_count = (size + chunk_size_ - 1) / chunk_size_;
+  return std::max<size_t>(1, chunk_count) * chunk_size_;
+}
+
+base::span<uint8_t> ChunkStore::GetContiguousChunk(size_t chunk_index) const {
+  if (!contiguous_)
+    return {};
+
+  const size_t offset = chunk_index * chunk_size_;
+  if (offset >= contiguous_->size)
+    return {};
+
+  return contiguous_->memory().subspan(offset, chunk_size_);
+}
+
+std::unique_ptr<ChunkStore::Slab> ChunkStore::CreateSlab(size_t size) {
+  std::unique_ptr<Slab> slab;
+  if (spill_file_.IsValid())
+    slab = CreateMappedSlab(size);
+  if (!slab)
+    slab = CreateHeapSlab(size);
+  return slab;
+}
+
+std::unique_ptr<ChunkStore::Slab> ChunkStore::CreateHeapSlab(
+    size_t size) const {
+  // Huge pages can only back whole, aligned huge pages of memory.
+  const size_t alignment =
+      size >= kHugePageSize ? kHugePageSize : alignof(std::max_align_t);
+  auto slab = std::make_unique<Slab>();
+  slab->size = size;
+  slab->heap.reset(static_cast<uint8_t*>(base::AlignedAlloc(size, alignment)));
+  return slab;
+}
+
+std::unique_ptr<ChunkStore::Slab> ChunkStore::CreateMappedSlab(size_t size) {
+  base::File file = spill_file_.Duplicate();
+  if (!file.IsValid())
+    return nullptr;
+
+  auto mapping = std::make_unique<base::MemoryMappedFile>();
+  const base::MemoryMappedFile::Region region = {spill_file_size_, size};
+  if (!mapping->Initialize(std::move(file), region,
+                           base::MemoryMappedFile::READ_WRITE_EXTEND)) {
+    return nullptr;
+  }
+  spill_file_size_ += size;
+
+  auto slab = std::make_unique<Slab>();
+  slab->size = size;
+  slab->mapping = std::move(mapping);
+  return slab;
+}
+
+}  // namespace chrome_pdf
@@ -0,0 +1,109 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_LOADER_CHUNK_STORE_H_
+#define PDF_LOADER_CHUNK_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/containers/flat_map.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+
+namespace chrome_pdf {
+
+// Holds the memory of the chunks of a `ChunkStream`. Chunks are carved out of
+// slabs of consecutive chunks, which only get allocated once one of their
+// chunks is needed, so a large document that is only partially loaded costs
+// neither a pointer per chunk of the whole document nor an allocation per
+// chunk.
+class ChunkStore {
+ public:
+  // Slabs of this size get aligned to it, so that they can be backed by huge
+  // pages.
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  ChunkStore(size_t chunk_size, size_t chunks_per_slab);
+  ChunkStore(const ChunkStore&) = delete;
+  ChunkStore& operator=(const ChunkStore&) = delete;
+  ~ChunkStore();
+
+  // Returns the memory of the chunk at `chunk_index`, allocating its slab if
+  // needed. The contents of newly allocated chunks are undefined.
+  base::span<uint8_t> GetOrCreateChunk(size_t chunk_index);
+
+  // Returns the memory of the chunk at `chunk_index`, or an empty span if its
+  // slab was never allocated.
+  base::span<const uint8_t> GetChunk(size_t chunk_index) const;
+
+  // Allocates new slabs in memory mappings of `file` from now on, rather than
+  // on the heap, so that the downloaded data of very large documents can be
+  // paged out to disk. `file` must be open for reading and writing. Slabs
+  // fall back to the heap if mapping fails.
+  void SetSpillFile(base::File file);
+
+  // Allocates the contiguous buffer for the first `size` bytes of chunks up
+  // front, in a memory mapping of the spill file if there is one, and serves
+  // those chunks from it from then on. This way MakeContiguous() does not need
+  // to copy them, which would briefly hold the data twice. Chunks past `size`
+  // still go into slabs.
+  void ReserveContiguous(size_t size);
+
+  // Moves the first `size` bytes of chunks into a single contiguous buffer, in
+  // a memory mapping of the spill file if there is one, and frees the slabs.
+  // Only copies the chunks that are not in that buffer already, so nothing if
+  // ReserveContiguous() reserved enough. Chunks get served from that buffer
+  // from then on. Returns the buffer, which stays valid until Clear() gets
+  // called.
+  base::span<const uint8_t> MakeContiguous(size_t size);
+
+  // Returns the buffer made by MakeContiguous(), or an empty span.
+  base::span<const uint8_t> contiguous_data() const;
+
+  // Frees all the slabs, and the contiguous buffer.
+  void Clear();
+
+  // Does not count the contiguous buffer.
+  size_t slab_count() const { return slabs_.size(); }
+  size_t heap_slab_count() const;
+
+ private:
+  struct Slab;
+
+  // Returns the size of a contiguous buffer for `size` bytes of chunks.
+  size_t GetContiguousSize(size_t size) const;
+
+  // Returns the memory of the chunk at `chunk_index` in `contiguous_`, or an
+  // empty span if it is past the end of `contiguous_`.
+  base::span<uint8_t> GetContiguousChunk(size_t chunk_index) const;
+
+  std::unique_ptr<Slab> CreateSlab(size_t size);
+  std::unique_ptr<Slab> CreateHeapSlab(size_t size) const;
+  std::unique_ptr<Slab> CreateMappedSlab(size_t size);
+
+  const size_t chunk_size_;
+  const size_t chunks_per_slab_;
+  const size_t slab_size_;
+
+  // Indexed by the index of their first chunk divided by `chunks_per_slab_`.
+  base::flat_map<size_t, std::unique_ptr<Slab>> slabs_;
+
+  // Holds the chunks it covers instead of `slabs_` after ReserveContiguous(),
+  // and replaces `slabs_` after MakeContiguous(). Holds a whole number of
+  // chunks, of which the first `contiguous_size_` bytes are the data once
+  // `is_contiguous_` is true.
+  std::unique_ptr<Slab> contiguous_;
+  size_t contiguous_size_ = 0;
+  bool is_contiguous_ = false;
+
+  base::File spill_file_;
+  int64_t spill_file_size_ = 0;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_LOADER_CHUNK_STORE_H_
@@ -0,0 +1,170 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/chunk_store.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+constexpr size_t kChunkSize = 4096;
+constexpr size_t kChunksPerSlab = 16;
+
+void FillChunk(ChunkStore& store, size_t chunk_index) {
+  std::ranges::fill(store.GetOrCreateChunk(chunk_index),
+                    static_cast<uint8_t>(chunk_index));
+}
+
+bool IsChunkFilled(const ChunkStore& store, size_t chunk_index) {
+  base::span<const uint8_t> chunk = store.GetChunk(chunk_index);
+  return chunk.size() == kChunkSize &&
+         std::ranges::all_of(chunk, [chunk_index](uint8_t value) {
+           return value == static_cast<uint8_t>(chunk_index);
+         });
+}
+
+}  // namespace
+
+TEST(ChunkStoreTest, AllocatesSlabsOnDemand) {
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  EXPECT_EQ(0u, store.slab_count());
+  EXPECT_TRUE(store.GetChunk(0).empty());
+
+  FillChunk(store, 0);
+  FillChunk(store, kChunksPerSlab - 1);
+  EXPECT_EQ(1u, store.slab_count());
+
+  // A chunk far away only needs a slab of its own, none in between.
+  FillChunk(store, 100000);
+  EXPECT_EQ(2u, store.slab_count());
+  EXPECT_TRUE(store.GetChunk(kChunksPerSlab).empty());
+  EXPECT_TRUE(store.GetChunk(50000).empty());
+
+  EXPECT_TRUE(IsChunkFilled(store, 0));
+  EXPECT_TRUE(IsChunkFilled(store, kChunksPerSlab - 1));
+  EXPECT_TRUE(IsChunkFilled(store, 100000));
+}
+
+TEST(ChunkStoreTest, ChunksDoNotOverlap) {
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  for (size_t i = 0; i < kChunksPerSlab; ++i)
+    FillChunk(store, i);
+  for (size_t i = 0; i < kChunksPerSlab; ++i)
+    EXPECT_TRUE(IsChunkFilled(store, i)) << i;
+}
+
+TEST(ChunkStoreTest, Clear) {
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  FillChunk(store, 3);
+  store.Clear();
+  EXPECT_EQ(0u, store.slab_count());
+  EXPECT_TRUE(store.GetChunk(3).empty());
+}
+
+TEST(ChunkStoreTest, MakeContiguous) {
+  constexpr size_t kChunkCount = 2 * kChunksPerSlab + 3;
+  constexpr size_t kSize = kChunkCount * kChunkSize - 100;
+
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  EXPECT_TRUE(store.contiguous_data().empty());
+  for (size_t i = 0; i < kChunkCount; ++i)
+    FillChunk(store, i);
+
+  base::span<const uint8_t> data = store.MakeContiguous(kSize);
+  EXPECT_EQ(0u, store.slab_count());
+  ASSERT_EQ(kSize, data.size());
+  EXPECT_EQ(data.data(), store.contiguous_data().data());
+  for (size_t i = 0; i < kChunkCount; ++i) {
+    EXPECT_TRUE(IsChunkFilled(store, i)) << i;
+    EXPECT_EQ(static_cast<uint8_t>(i), data[i * kChunkSize]) << i;
+  }
+  EXPECT_TRUE(store.GetChunk(kChunkCount).empty());
+
+  store.Clear();
+  EXPECT_TRUE(store.contiguous_data().empty());
+  EXPECT_TRUE(store.GetChunk(0).empty());
+}
+
+TEST(ChunkStoreTest, MakeContiguousAfterReserveContiguous) {
+  constexpr size_t kChunkCount = 2 * kChunksPerSlab + 3;
+  constexpr size_t kSize = kChunkCount * kChunkSize - 100;
+
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  store.ReserveContiguous(kSize);
+  for (size_t i = 0; i < kChunkCount; ++i)
+    FillChunk(store, i);
+
+  // The chunks went straight into the reserved buffer, so making it contiguous
+  // copies nothing.
+  EXPECT_EQ(0u, store.slab_count());
+  const uint8_t* reserved = store.GetChunk(0).data();
+  EXPECT_TRUE(store.contiguous_data().empty());
+
+  base::span<const uint8_t> data = store.MakeContiguous(kSize);
+  ASSERT_EQ(kSize, data.size());
+  EXPECT_EQ(reserved, data.data());
+  for (size_t i = 0; i < kChunkCount; ++i)
+    EXPECT_TRUE(IsChunkFilled(store, i)) << i;
+}
+
+TEST(ChunkStoreTest, MakeContiguousPastReserveContiguous) {
+  constexpr size_t kReservedChunkCount = kChunksPerSlab + 3;
+  constexpr size_t kChunkCount = 2 * kChunksPerSlab + 3;
+
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  store.ReserveContiguous(kReservedChunkCount * kChunkSize);
+  for (size_t i = 0; i < kChunkCount; ++i)
+    FillChunk(store, i);
+
+  // Only the chunks past the reserved buffer need slabs, including the part
+  // of the slab the reserved buffer ends in.
+  EXPECT_EQ(2u, store.slab_count());
+
+  base::span<const uint8_t> data =
+      store.MakeContiguous(kChunkCount * kChunkSize);
+  EXPECT_EQ(0u, store.slab_count());
+  ASSERT_EQ(kChunkCount * kChunkSize, data.size());
+  for (size_t i = 0; i < kChunkCount; ++i) {
+    EXPECT_TRUE(IsChunkFilled(store, i)) << i;
+    EXPECT_EQ(static_cast<uint8_t>(i), data[i * kChunkSize]) << i;
+  }
+}
+
+TEST(ChunkStoreTest, SpillFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::File file(temp_dir.GetPath().AppendASCII("spill"),
+                  base::File::FLAG_CREATE | base::File::FLAG_READ |
+                      base::File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  ChunkStore store(kChunkSize, kChunksPerSlab);
+  FillChunk(store, 0);
+  store.SetSpillFile(std::move(file));
+
+  // New slabs go to the file. Existing ones stay where they are.
+  FillChunk(store, kChunksPerSlab);
+  FillChunk(store, 5 * kChunksPerSlab + 1);
+  FillChunk(store, 1);
+  EXPECT_EQ(3u, store.slab_count());
+  EXPECT_EQ(1u, store.heap_slab_count());
+
+  EXPECT_TRUE(IsChunkFilled(store, 0));
+  EXPECT_TRUE(IsChunkFilled(store, 1));
+  EXPECT_TRUE(IsChunkFilled(store, kChunksPerSlab));
+  EXPECT_TRUE(IsChunkFilled(store, 5 * kChunksPerSlab + 1));
+}
+
+}  // namespace chrome_pdf
@@ -17,8 +17,11 @@
 #include <array>
 #include <memory>
 #include <utility>
-#include <vector>
 
+#include "base/check.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "pdf/loader/chunk_store.h"
 #include "pdf/loader/range_set.h"
 
 namespace chrome_pdf {
@@ -31,27 +34,65 @@ class ChunkStream {
   static constexpr size_t kChunkSize = N;
   using ChunkData = typename std::array<unsigned char, N>;
 
-  ChunkStream() {}
+  ChunkStream()
+      : store_(N, std::max<size_t>(1, ChunkStore::kHugePageSize / N)) {}
   ~ChunkStream() {}
 
   void SetChunkData(size_t chunk_index, std::unique_ptr<ChunkData> data) {
     if (!data)
       return;
 
-    if (chunk_index >= data_.size())
-      data_.resize(chunk_index + 1);
+    std::ranges::copy(*data, GetChunkBuffer(chunk_index).begin());
+    SetChunkFilled(chunk_index);
+  }
+
+  // Returns the memory of the chunk at `chunk_index`, for filling it in place.
+  // The chunk only becomes available once SetChunkFilled() gets called.
+  base::span<unsigned char> GetChunkBuffer(size_t chunk_index) {
+    return store_.GetOrCreateChunk(chunk_index);
+  }
 
-    if (!data_[chunk_index])
+  void SetChunkFilled(size_t chunk_index) {
+    if (!filled_chunks_.Contains(chunk_index))
       ++filled_chunks_count_;
 
-    data_[chunk_index] = std::move(data);
     filled_chunks_.Union(gfx::Range(chunk_index, chunk_index + 1));
   }
 
+  // See ChunkStore::SetSpillFile().
+  void SetSpillFile(base::File file) { store_.SetSpillFile(std::move(file)); }
+
+  // Has the chunks up to eof_pos() written straight into the buffer that
+  // MakeContiguous() makes, so it does not need to copy them. Does nothing if
+  // eof_pos() is unknown.
+  void ReserveContiguous() {
+    if (eof_pos_)
+      store_.ReserveContiguous(eof_pos_);
+  }
+
+  // Moves the chunks of a complete stream into one contiguous buffer, which
+  // data() then returns.
+  void MakeContiguous() {
+    DCHECK(IsComplete());
+    if (data().empty())
+      store_.MakeContiguous(eof_pos_);
+  }
+
+  // Returns the whole stream once MakeContiguous() got called, or an empty
+  // span. Stays valid until Clear() gets called.
+  base::span<const unsigned char> data() const {
+    return store_.contiguous_data();
+  }
+
   bool ReadData(const gfx::Range& range, void* buffer) const {
     if (!IsRangeAvailable(range))
       return false;
 
+    if (!data().empty()) {
+      memcpy(buffer, data().data() + range.start(), range.length());
+      return true;
+    }
+
     unsigned char* data_buffer = static_cast<unsigned char*>(buffer);
     size_t start = range.start();
     while (start != range.end()) {
@@ -59,7 +100,8 @@ class ChunkStream {
       const size_t chunk_start = start % kChunkSize;
       const size_t len =
           std::min(kChunkSize - chunk_start, range.end() - start);
-      memcpy(data_buffer, data_[chunk_index]->data() + chunk_start, len);
+      memcpy(data_buffer, store_.GetChunk(chunk_index).data() + chunk_start,
+             len);
       data_buffer += len;
       start += len;
     }
@@ -104,7 +146,7 @@ class ChunkStream {
   }
 
   void Clear() {
-    data_.clear();
+    store_.Clear();
     eof_pos_ = 0;
     filled_chunks_.Clear();
     filled_chunks_count_ = 0;
@@ -118,7 +160,7 @@ class ChunkStream {
     return (offset + kChunkSize - 1) / kChunkSize;
   }
 
-  std::vector<std::unique_ptr<ChunkData>> data_;
+  ChunkStore store_;
   size_t eof_pos_ = 0;
   RangeSet filled_chunks_;
   size_t filled_chunks_count_ = 0;
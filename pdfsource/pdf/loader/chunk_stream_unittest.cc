@@ -4,10 +4,12 @@
 
 #include "pdf/loader/chunk_stream.h"
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <utility>
 
+#include "base/containers/span.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace chrome_pdf {
@@ -96,4 +98,54 @@ TEST(ChunkStreamTest, Read) {
     EXPECT_EQ(++value, it);
   }
 }
+
+TEST(ChunkStreamTest, FillInPlace) {
+  TestChunkStream stream;
+  stream.set_eof_pos(25);
+
+  base::span<unsigned char> chunk = stream.GetChunkBuffer(1);
+  ASSERT_EQ(TestChunkStream::kChunkSize, chunk.size());
+  std::ranges::fill(chunk, 7);
+  EXPECT_FALSE(stream.IsChunkAvailable(1));
+  EXPECT_EQ(0u, stream.filled_chunks_count());
+
+  stream.SetChunkFilled(1);
+  EXPECT_TRUE(stream.IsChunkAvailable(1));
+  EXPECT_EQ(1u, stream.filled_chunks_count());
+
+  // Filling a chunk twice counts once.
+  stream.SetChunkFilled(1);
+  EXPECT_EQ(1u, stream.filled_chunks_count());
+
+  std::array<unsigned char, 10> result_data;
+  EXPECT_TRUE(stream.ReadData(gfx::Range(10, 20), result_data.data()));
+  for (unsigned char value : result_data)
+    EXPECT_EQ(7, value);
+}
+
+TEST(ChunkStreamTest, MakeContiguous) {
+  TestChunkStream stream;
+  stream.set_eof_pos(25);
+  for (size_t i = 0; i < 3; ++i) {
+    std::ranges::fill(stream.GetChunkBuffer(i), static_cast<unsigned char>(i));
+    stream.SetChunkFilled(i);
+  }
+  EXPECT_TRUE(stream.data().empty());
+
+  stream.MakeContiguous();
+  base::span<const unsigned char> data = stream.data();
+  ASSERT_EQ(25u, data.size());
+  for (size_t i = 0; i < data.size(); ++i)
+    EXPECT_EQ(i / TestChunkStream::kChunkSize, data[i]) << i;
+
+  std::array<unsigned char, 10> result_data;
+  EXPECT_TRUE(stream.ReadData(gfx::Range(5, 15), result_data.data()));
+  EXPECT_EQ(0, result_data[4]);
+  EXPECT_EQ(1, result_data[5]);
+  EXPECT_FALSE(stream.ReadData(gfx::Range(20, 30), result_data.data()));
+
+  stream.Clear();
+  EXPECT_TRUE(stream.data().empty());
+}
+
 }  // namespace chrome_pdf
@@ -0,0 +1,337 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/document_cache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/functional/bind.h"
+#include "base/hash/sha1.h"
+#include "base/memory/ptr_util.h"
+#include "base/pickle.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/time/time.h"
+#include "pdf/loader/range_set.h"
+#include "ui/gfx/range/range.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// Bump this whenever the format of the index changes.
+constexpr uint32_t kIndexVersion = 2;
+
+constexpr base::FilePath::CharType kIndexExtension[] =
+    FILE_PATH_LITERAL(".index");
+constexpr base::FilePath::CharType kDataExtension[] =
+    FILE_PATH_LITERAL(".data");
+
+// Returns the chunks recorded in the index at `index_path`, or an empty set if
+// the index is missing, damaged, or for another document than `key`.
+RangeSet ReadIndex(const base::FilePath& index_path,
+                   std::string_view key,
+                   size_t chunk_count) {
+  std::string contents;
+  if (!base::ReadFileToString(index_path, &contents))
+    return RangeSet();
+
+  base::Pickle pickle =
+      base::Pickle::WithUnownedBuffer(base::as_byte_span(contents));
+  base::PickleIterator iter(pickle);
+  uint32_t version = 0;
+  std::string index_key;
+  uint64_t data_size = 0;
+  uint32_t range_count = 0;
+  if (!iter.ReadUInt32(&version) || version != kIndexVersion ||
+      !iter.ReadString(&index_key) || index_key != key ||
+      !iter.ReadUInt64(&data_size) || !iter.ReadUInt32(&range_count)) {
+    return RangeSet();
+  }
+
+  RangeSet chunks;
+  for (uint32_t i = 0; i < range_count; ++i) {
+    uint32_t start = 0;
+    uint32_t end = 0;
+    if (!iter.ReadUInt32(&start) || !iter.ReadUInt32(&end) || start >= end ||
+        end > chunk_count) {
+      return RangeSet();
+    }
+    chunks.Union(gfx::Range(start, end));
+  }
+  return chunks;
+}
+
+// Returns the bytes of data that the index at `index_path` records, or nullopt
+// if the index is missing or damaged.
+std::optional<int64_t> ReadIndexedDataSize(const base::FilePath& index_path) {
+  std::string contents;
+  if (!base::ReadFileToString(index_path, &contents))
+    return std::nullopt;
+
+  base::Pickle pickle =
+      base::Pickle::WithUnownedBuffer(base::as_byte_span(contents));
+  base::PickleIterator iter(pickle);
+  uint32_t version = 0;
+  std::string key;
+  uint64_t data_size = 0;
+  if (!iter.ReadUInt32(&version) || version != kIndexVersion ||
+      !iter.ReadString(&key) || !iter.ReadUInt64(&data_size)) {
+    return std::nullopt;
+  }
+  return static_cast<int64_t>(data_size);
+}
+
+// Replies to AsyncDocumentCache::OpenEntry() on the sequence that called it.
+// Not bound to the `AsyncDocumentCache`, so that `entry` always gets handed
+// back to `task_runner` to be destroyed.
+void DidOpenEntry(scoped_refptr<base::SequencedTaskRunner> task_runner,
+                  AsyncDocumentCache::OpenEntryCallback callback,
+                  std::unique_ptr<DocumentCache::Entry> entry) {
+  if (!entry) {
+    std::move(callback).Run(AsyncDocumentCache::CacheEntry(), RangeSet());
+    return;
+  }
+
+  // Nothing else uses `entry` until it is back on `task_runner`.
+  RangeSet chunks = entry->chunks();
+  std::move(callback).Run(
+      AsyncDocumentCache::CacheEntry(std::move(task_runner), std::move(entry)),
+      std::move(chunks));
+}
+
+}  // namespace
+
+DocumentCache::Entry::Entry(base::WeakPtr<DocumentCache> cache,
+                            base::FilePath data_path,
+                            base::File data_file,
+                            std::string key,
+                            size_t chunk_size,
+                            uint32_t document_size,
+                            RangeSet chunks)
+    : cache_(std::move(cache)),
+      data_path_(std::move(data_path)),
+      data_file_(std::move(data_file)),
+      key_(std::move(key)),
+      chunk_size_(chunk_size),
+      document_size_(document_size),
+      chunks_(std::move(chunks)) {}
+
+DocumentCache::Entry::~Entry() {
+  Flush();
+  if (cache_)
+    cache_->CloseEntry(data_path_);
+}
+
+std::vector<uint8_t> DocumentCache::Entry::ReadChunks(
+    const gfx::Range& chunk_range) {
+  if (chunk_range.is_empty() || !chunks_.Contains(chunk_range))
+    return {};
+
+  std::vector<uint8_t> data(GetDataSize(chunk_range));
+  if (!data_file_.ReadAndCheck(chunk_range.start() * chunk_size_, data))
+    return {};
+
+  return data;
+}
+
+bool DocumentCache::Entry::WriteChunk(size_t chunk_index,
+                                      std::vector<uint8_t> data) {
+  if (chunks_.Contains(chunk_index))
+    return true;
+
+  const size_t length = GetDataSize(gfx::Range(chunk_index, chunk_index + 1));
+  DCHECK_GE(data.size(), length);
+  if (!data_file_.WriteAndCheck(chunk_index * chunk_size_,
+                                base::span(data).first(length))) {
+    return false;
+  }
+
+  chunks_.Union(gfx::Range(chunk_index, chunk_index + 1));
+  dirty_ = true;
+  return true;
+}
+
+bool DocumentCache::Entry::Flush() {
+  if (!dirty_)
+    return true;
+
+  // The index must never list chunks that are not on disk yet.
+  data_file_.Flush();
+
+  base::Pickle pickle;
+  pickle.WriteUInt32(kIndexVersion);
+  pickle.WriteString(key_);
+  uint64_t data_size = 0;
+  for (const gfx::Range& range : chunks_.ranges())
+    data_size += GetDataSize(range);
+  pickle.WriteUInt64(data_size);
+  pickle.WriteUInt32(chunks_.Size());
+  for (const gfx::Range& range : chunks_.ranges()) {
+    pickle.WriteUInt32(range.start());
+    pickle.WriteUInt32(range.end());
+  }
+  if (!base::ImportantFileWriter::WriteFileAtomically(
+          data_path_.ReplaceExtension(kIndexExtension),
+          std::string_view(pickle.data_as_char(), pickle.size()))) {
+    return false;
+  }
+
+  dirty_ = false;
+  return true;
+}
+
+size_t DocumentCache::Entry::GetDataSize(const gfx::Range& chunk_range) const {
+  const size_t start = chunk_range.start() * chunk_size_;
+  DCHECK_LT(start, document_size_);
+  return std::min<size_t>(chunk_range.end() * chunk_size_, document_size_) -
+         start;
+}
+
+DocumentCache::DocumentCache(base::FilePath directory, int64_t max_size)
+    : directory_(std::move(directory)), max_size_(max_size) {}
+
+DocumentCache::~DocumentCache() = default;
+
+std::unique_ptr<DocumentCache::Entry> DocumentCache::OpenEntry(
+    const std::string& url,
+    const std::string& etag,
+    const std::string& last_modified,
+    uint32_t document_size,
+    size_t chunk_size) {
+  DCHECK_GT(chunk_size, 0u);
+  if ((etag.empty() && last_modified.empty()) || document_size == 0)
+    return nullptr;
+
+  if (!base::CreateDirectory(directory_))
+    return nullptr;
+
+  Trim();
+
+  std::string key =
+      base::StrCat({url, "\n", etag, "\n", last_modified, "\n",
+                    base::NumberToString(document_size), "\n",
+                    base::NumberToString(chunk_size)});
+  const std::string hash =
+      base::HexEncode(base::as_byte_span(base::SHA1HashString(key)));
+  base::FilePath data_path =
+      directory_.AppendASCII(hash).AddExtension(kDataExtension);
+
+  base::File data_file(data_path, base::File::FLAG_OPEN_ALWAYS |
+                                      base::File::FLAG_READ |
+                                      base::File::FLAG_WRITE);
+  if (!data_file.IsValid())
+    return nullptr;
+
+  const size_t chunk_count = (document_size + chunk_size - 1) / chunk_size;
+  RangeSet chunks = ReadIndex(data_path.ReplaceExtension(kIndexExtension), key,
+                              chunk_count);
+  if (chunks.IsEmpty()) {
+    // Whatever the data file holds belongs to no index, unless another entry
+    // for the document is still writing to it.
+    if (!open_entries_.contains(data_path))
+      data_file.SetLength(0);
+  } else {
+    // Let Trim() know the entry got used.
+    const base::Time now = base::Time::Now();
+    base::TouchFile(data_path, now, now);
+  }
+
+  ++open_entries_[data_path];
+  return base::WrapUnique(new Entry(
+      weak_factory_.GetWeakPtr(), std::move(data_path), std::move(data_file),
+      std::move(key), chunk_size, document_size, std::move(chunks)));
+}
+
+void DocumentCache::Trim() {
+  struct CachedDocument {
+    base::FilePath data_path;
+    base::Time last_used;
+    int64_t size;
+  };
+
+  // Data files get written to whenever their entry is in use, and touched
+  // when it gets opened.
+  std::vector<CachedDocument> documents;
+  int64_t total_size = 0;
+  base::FileEnumerator enumerator(
+      directory_, /*recursive=*/false, base::FileEnumerator::FILES,
+      base::StrCat({FILE_PATH_LITERAL("*"), kDataExtension}));
+  for (base::FilePath data_path = enumerator.Next(); !data_path.empty();
+       data_path = enumerator.Next()) {
+    const bool open = open_entries_.contains(data_path);
+    const std::optional<int64_t> size =
+        ReadIndexedDataSize(data_path.ReplaceExtension(kIndexExtension));
+    if (!size.has_value()) {
+      // Nothing can use the data without an index.
+      if (!open)
+        base::DeleteFile(data_path);
+      continue;
+    }
+
+    total_size += size.value();
+    if (!open) {
+      documents.push_back({data_path,
+                           enumerator.GetInfo().GetLastModifiedTime(),
+                           size.value()});
+    }
+  }
+
+  std::ranges::sort(documents, {}, &CachedDocument::last_used);
+  for (const CachedDocument& document : documents) {
+    if (total_size <= max_size_)
+      break;
+
+    base::DeleteFile(document.data_path.ReplaceExtension(kIndexExtension));
+    base::DeleteFile(document.data_path);
+    total_size -= document.size;
+  }
+}
+
+void DocumentCache::CloseEntry(const base::FilePath& data_path) {
+  auto it = open_entries_.find(data_path);
+  CHECK(it != open_entries_.end());
+  if (--it->second == 0)
+    open_entries_.erase(it);
+}
+
+AsyncDocumentCache::AsyncDocumentCache(base::FilePath directory,
+                                       int64_t max_size)
+    : task_runner_(base::ThreadPool::CreateSequencedTaskRunner(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})),
+      cache_(task_runner_, std::move(directory), max_size) {}
+
+AsyncDocumentCache::~AsyncDocumentCache() = default;
+
+void AsyncDocumentCache::OpenEntry(const std::string& url,
+                                   const std::string& etag,
+                                   const std::string& last_modified,
+                                   uint32_t document_size,
+                                   size_t chunk_size,
+                                   OpenEntryCallback callback) {
+  cache_.AsyncCall(&DocumentCache::OpenEntry)
+      .WithArgs(url, etag, last_modified, document_size, chunk_size)
+      .Then(base::BindOnce(&DidOpenEntry, task_runner_, std::move(callback)));
+}
+
+}  // namespace chrome_pdf
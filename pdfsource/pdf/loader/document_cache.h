@@ -0,0 +1,162 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_LOADER_DOCUMENT_CACHE_H_
+#define PDF_LOADER_DOCUMENT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/functional/callback.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/sequence_bound.h"
+#include "pdf/loader/range_set.h"
+#include "ui/gfx/range/range.h"
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+namespace chrome_pdf {
+
+// Keeps the chunks of downloaded documents on disk, so that opening a document
+// again only has to fetch the chunks that never came in. Entries are keyed by
+// the URL and the validators of the response, so that a document that changed
+// on the server never gets mixed up with an older copy of it.
+//
+// All of the methods block on file I/O, so the cache and its entries must live
+// on a sequence that may block. `AsyncDocumentCache` runs them on one.
+class DocumentCache {
+ public:
+  // The chunks of one document in the cache.
+  class Entry {
+   public:
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+    ~Entry();
+
+    // The indices of the chunks that the entry holds.
+    const RangeSet& chunks() const { return chunks_; }
+
+    // Returns the data of the chunks in `chunk_range`, back to back. Of the
+    // last chunk of the document, only the part inside the document is there.
+    // Returns an empty vector if the entry does not hold all of the chunks, or
+    // if reading fails.
+    std::vector<uint8_t> ReadChunks(const gfx::Range& chunk_range);
+
+    // Stores the chunk at `chunk_index`, unless the entry holds it already.
+    // `data` must hold a whole chunk, or the rest of the document.
+    bool WriteChunk(size_t chunk_index, std::vector<uint8_t> data);
+
+    // Records which chunks got written, so that the next entry for the same
+    // document finds them. Also happens on destruction.
+    bool Flush();
+
+   private:
+    friend class DocumentCache;
+
+    Entry(base::WeakPtr<DocumentCache> cache,
+          base::FilePath data_path,
+          base::File data_file,
+          std::string key,
+          size_t chunk_size,
+          uint32_t document_size,
+          RangeSet chunks);
+
+    // Returns the bytes of the document that the chunks in `chunk_range` hold.
+    size_t GetDataSize(const gfx::Range& chunk_range) const;
+
+    // Told when the entry closes, so that Trim() may evict it from then on.
+    const base::WeakPtr<DocumentCache> cache_;
+
+    const base::FilePath data_path_;
+    base::File data_file_;
+
+    // Identifies the document and the chunk size. Stored in the index, to
+    // tell apart documents whose keys hash to the same file names.
+    const std::string key_;
+
+    const size_t chunk_size_;
+    const uint32_t document_size_;
+    RangeSet chunks_;
+
+    // Whether `chunks_` changed since the index got written.
+    bool dirty_ = false;
+  };
+
+  // Keeps the data of documents in `directory`, evicting the entries that were
+  // opened least recently once the data exceeds `max_size` bytes.
+  DocumentCache(base::FilePath directory, int64_t max_size);
+  DocumentCache(const DocumentCache&) = delete;
+  DocumentCache& operator=(const DocumentCache&) = delete;
+  ~DocumentCache();
+
+  // Opens the entry for the document at `url` that the response validators
+  // `etag` and `last_modified` identify, creating it if needed. Returns
+  // nullptr if there are no validators to tell whether a cached copy is still
+  // current, or if the files of the entry cannot be opened.
+  std::unique_ptr<Entry> OpenEntry(const std::string& url,
+                                   const std::string& etag,
+                                   const std::string& last_modified,
+                                   uint32_t document_size,
+                                   size_t chunk_size);
+
+ private:
+  // Evicts entries that are not open until at most `max_size_` bytes of data
+  // remain, as far as the indices of the entries tell. The data files are
+  // sparse, so their length says little about the space they take up.
+  void Trim();
+
+  void CloseEntry(const base::FilePath& data_path);
+
+  const base::FilePath directory_;
+  const int64_t max_size_;
+
+  // The number of open entries for each data file.
+  base::flat_map<base::FilePath, int> open_entries_;
+
+  base::WeakPtrFactory<DocumentCache> weak_factory_{this};
+};
+
+// Runs a `DocumentCache` on a sequence that may block, on behalf of a sequence
+// that must not, such as the main thread of the plugin.
+class AsyncDocumentCache {
+ public:
+  using CacheEntry = base::SequenceBound<std::unique_ptr<DocumentCache::Entry>>;
+
+  // Replies to OpenEntry() with the entry, which is null if it cannot be
+  // opened, and with the chunks the entry held when it got opened.
+  using OpenEntryCallback =
+      base::OnceCallback<void(CacheEntry entry, RangeSet chunks)>;
+
+  AsyncDocumentCache(base::FilePath directory, int64_t max_size);
+  AsyncDocumentCache(const AsyncDocumentCache&) = delete;
+  AsyncDocumentCache& operator=(const AsyncDocumentCache&) = delete;
+  ~AsyncDocumentCache();
+
+  // Like DocumentCache::OpenEntry(). The entry lives on the sequence of the
+  // cache, and may outlive `this`.
+  void OpenEntry(const std::string& url,
+                 const std::string& etag,
+                 const std::string& last_modified,
+                 uint32_t document_size,
+                 size_t chunk_size,
+                 OpenEntryCallback callback);
+
+ private:
+  const scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  base::SequenceBound<DocumentCache> cache_;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_LOADER_DOCUMENT_CACHE_H_
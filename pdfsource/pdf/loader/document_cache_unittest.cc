@@ -0,0 +1,199 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/document_cache.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/time/time.h"
+#include "pdf/loader/range_set.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/range/range.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+constexpr size_t kChunkSize = 1024;
+constexpr uint32_t kDocumentSize = 3 * kChunkSize + 100;
+constexpr char kUrl[] = "https://example.com/spec.pdf";
+constexpr char kETag[] = "\"v1\"";
+
+std::vector<uint8_t> MakeChunk(size_t chunk_index) {
+  return std::vector<uint8_t>(kChunkSize, static_cast<uint8_t>(chunk_index));
+}
+
+class DocumentCacheTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<DocumentCache> CreateCache(int64_t max_size) {
+    return std::make_unique<DocumentCache>(temp_dir_.GetPath(), max_size);
+  }
+
+  // Sets the last use of every entry in the cache to `time`.
+  void SetLastUsed(base::Time time) {
+    base::FileEnumerator enumerator(temp_dir_.GetPath(), /*recursive=*/false,
+                                    base::FileEnumerator::FILES);
+    for (base::FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      ASSERT_TRUE(base::TouchFile(path, time, time));
+    }
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(DocumentCacheTest, NeedsValidators) {
+  std::unique_ptr<DocumentCache> cache = CreateCache(1 << 20);
+  EXPECT_FALSE(cache->OpenEntry(kUrl, "", "", kDocumentSize, kChunkSize));
+  EXPECT_TRUE(cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize));
+  EXPECT_TRUE(cache->OpenEntry(kUrl, "", "Tue, 01 Oct 2024 10:00:00 GMT",
+                               kDocumentSize, kChunkSize));
+}
+
+TEST_F(DocumentCacheTest, KeepsChunks) {
+  std::unique_ptr<DocumentCache> cache = CreateCache(1 << 20);
+  {
+    std::unique_ptr<DocumentCache::Entry> entry =
+        cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+    ASSERT_TRUE(entry);
+    EXPECT_TRUE(entry->chunks().IsEmpty());
+    EXPECT_TRUE(entry->WriteChunk(1, MakeChunk(1)));
+    EXPECT_TRUE(entry->WriteChunk(3, MakeChunk(3)));
+  }
+
+  std::unique_ptr<DocumentCache::Entry> entry =
+      cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  RangeSet expected_chunks(gfx::Range(1, 2));
+  expected_chunks.Union(gfx::Range(3, 4));
+  EXPECT_EQ(expected_chunks, entry->chunks());
+
+  EXPECT_TRUE(entry->ReadChunks(gfx::Range(0, 1)).empty());
+  EXPECT_TRUE(entry->ReadChunks(gfx::Range(1, 3)).empty());
+  EXPECT_EQ(MakeChunk(1), entry->ReadChunks(gfx::Range(1, 2)));
+
+  // Only the part of the last chunk inside the document is there.
+  std::vector<uint8_t> data = entry->ReadChunks(gfx::Range(3, 4));
+  ASSERT_EQ(100u, data.size());
+  EXPECT_TRUE(std::ranges::all_of(data,
+                                  [](uint8_t value) { return value == 3; }));
+}
+
+TEST_F(DocumentCacheTest, ChangedDocument) {
+  std::unique_ptr<DocumentCache> cache = CreateCache(1 << 20);
+  {
+    std::unique_ptr<DocumentCache::Entry> entry =
+        cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+    ASSERT_TRUE(entry);
+    EXPECT_TRUE(entry->WriteChunk(0, MakeChunk(0)));
+  }
+
+  std::unique_ptr<DocumentCache::Entry> entry =
+      cache->OpenEntry(kUrl, "\"v2\"", "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_TRUE(entry->chunks().IsEmpty());
+
+  entry = cache->OpenEntry(kUrl, kETag, "", kDocumentSize + 1, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_TRUE(entry->chunks().IsEmpty());
+}
+
+TEST_F(DocumentCacheTest, EvictsLeastRecentlyUsed) {
+  constexpr char kUrlA[] = "https://a.com/a.pdf";
+  constexpr char kUrlB[] = "https://b.com/b.pdf";
+  std::unique_ptr<DocumentCache> cache = CreateCache(3 * kChunkSize);
+  for (const char* url : {kUrlA, kUrlB}) {
+    std::unique_ptr<DocumentCache::Entry> entry =
+        cache->OpenEntry(url, kETag, "", kDocumentSize, kChunkSize);
+    ASSERT_TRUE(entry);
+    EXPECT_TRUE(entry->WriteChunk(0, MakeChunk(0)));
+    EXPECT_TRUE(entry->WriteChunk(1, MakeChunk(1)));
+    entry.reset();
+
+    // Make the first document the older one.
+    if (url == kUrlA)
+      SetLastUsed(base::Time::Now() - base::Days(1));
+  }
+
+  // Opening another entry makes room.
+  EXPECT_TRUE(cache->OpenEntry("https://c.com/c.pdf", kETag, "",
+                               kDocumentSize, kChunkSize));
+  std::unique_ptr<DocumentCache::Entry> entry =
+      cache->OpenEntry(kUrlB, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(RangeSet(gfx::Range(0, 2)), entry->chunks());
+  entry = cache->OpenEntry(kUrlA, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_TRUE(entry->chunks().IsEmpty());
+}
+
+TEST_F(DocumentCacheTest, CountsStoredChunks) {
+  // A large document of which only the last chunk came in, at the end of a
+  // sparse data file.
+  constexpr uint32_t kLargeDocumentSize = 1000 * kChunkSize;
+  std::unique_ptr<DocumentCache> cache = CreateCache(3 * kChunkSize);
+  {
+    std::unique_ptr<DocumentCache::Entry> entry =
+        cache->OpenEntry(kUrl, kETag, "", kLargeDocumentSize, kChunkSize);
+    ASSERT_TRUE(entry);
+    EXPECT_TRUE(entry->WriteChunk(999, MakeChunk(999)));
+  }
+  SetLastUsed(base::Time::Now() - base::Days(1));
+
+  // The entry takes up a single chunk, so opening another one keeps it.
+  EXPECT_TRUE(cache->OpenEntry("https://b.com/b.pdf", kETag, "",
+                               kDocumentSize, kChunkSize));
+  std::unique_ptr<DocumentCache::Entry> entry =
+      cache->OpenEntry(kUrl, kETag, "", kLargeDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(RangeSet(gfx::Range(999, 1000)), entry->chunks());
+}
+
+TEST_F(DocumentCacheTest, KeepsOpenEntries) {
+  std::unique_ptr<DocumentCache> cache = CreateCache(kChunkSize);
+  std::unique_ptr<DocumentCache::Entry> open_entry =
+      cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(open_entry);
+  EXPECT_TRUE(open_entry->WriteChunk(0, MakeChunk(0)));
+  EXPECT_TRUE(open_entry->WriteChunk(1, MakeChunk(1)));
+  EXPECT_TRUE(open_entry->Flush());
+  SetLastUsed(base::Time::Now() - base::Days(1));
+
+  // Another loader opens the same document, and one more document gets opened
+  // while both are in use, which takes the cache over its size.
+  std::unique_ptr<DocumentCache::Entry> entry =
+      cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(RangeSet(gfx::Range(0, 2)), entry->chunks());
+  entry.reset();
+  EXPECT_TRUE(cache->OpenEntry("https://b.com/b.pdf", kETag, "",
+                               kDocumentSize, kChunkSize));
+
+  // The data of the open entry is still there.
+  std::vector<uint8_t> data = open_entry->ReadChunks(gfx::Range(0, 2));
+  ASSERT_EQ(2 * kChunkSize, data.size());
+  EXPECT_EQ(MakeChunk(1), std::vector<uint8_t>(data.begin() + kChunkSize,
+                                               data.end()));
+
+  // Once closed, it is the first to go.
+  open_entry.reset();
+  EXPECT_TRUE(cache->OpenEntry("https://c.com/c.pdf", kETag, "",
+                               kDocumentSize, kChunkSize));
+  entry = cache->OpenEntry(kUrl, kETag, "", kDocumentSize, kChunkSize);
+  ASSERT_TRUE(entry);
+  EXPECT_TRUE(entry->chunks().IsEmpty());
+}
+
+}  // namespace chrome_pdf
@@ -11,6 +11,8 @@
 #include <memory>
 #include <string>
 
+#include "base/containers/span.h"
+
 namespace chrome_pdf {
 
 class URLLoaderWrapper;
@@ -41,6 +43,11 @@ class DocumentLoader {
   // Data access interface. Return true if successful.
   virtual bool GetBlock(uint32_t position, uint32_t size, void* buf) const = 0;
 
+  // Returns the whole document if it is complete and held in one contiguous
+  // buffer, or an empty span otherwise. The buffer stays valid as long as the
+  // loader.
+  virtual base::span<const uint8_t> GetCompleteData() const = 0;
+
   // Data availability interface. Return true if data is available.
   virtual bool IsDataAvailable(uint32_t position, uint32_t size) const = 0;
 
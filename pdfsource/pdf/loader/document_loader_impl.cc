@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "base/check_op.h"
 #include "base/containers/span.h"
@@ -22,6 +23,8 @@
 #include "base/functional/callback.h"
 #include "base/numerics/safe_math.h"
 #include "base/strings/string_util.h"
+#include "base/time/time.h"
+#include "pdf/loader/document_cache.h"
 #include "pdf/loader/result_codes.h"
 #include "pdf/loader/url_loader_wrapper.h"
 #include "pdf/pdf_features.h"
@@ -35,10 +38,40 @@ namespace {
 // current connection (like playing a cassette tape) and do not send new range
 // request (like rewind a cassette tape, and continue playing after).
 // Experimentally chosen value.
-constexpr int kChunkCloseDistance = 10;
+constexpr uint32_t kChunkCloseDistance = 10;
+
+// Limits for the adapted close distance: at least one chunk, at most 16 MiB.
+constexpr uint32_t kMinCloseDistance = 1;
+constexpr uint32_t kMaxCloseDistance = 256;
+
+// What starting a request costs besides the round trip to the server: setting
+// up the loader in the browser process, and the IPC around it.
+constexpr base::TimeDelta kRequestOverhead = base::Milliseconds(20);
+
+// Transfers are measured in samples of at least this duration.
+constexpr base::TimeDelta kTransferSampleTime = base::Milliseconds(100);
 
 constexpr size_t kReadBufferSize = 256 * 1024;
 
+// The most ranges to ask for in one multi-range request. Servers may reject
+// requests with too many ranges.
+constexpr size_t kMaxRangesPerRequest = 8;
+
+// The most chunks a single range loader requests. Larger holes are split
+// between several range loaders, or left to the main loader.
+constexpr uint32_t kMaxRangeLoaderChunks = 16;
+
+// Range loaders that ran for less than this are too short to measure their
+// throughput reliably.
+constexpr base::TimeDelta kMinThroughputSampleTime = base::Milliseconds(100);
+
+// The weight of the latest range loader in the smoothed throughput.
+constexpr double kThroughputSampleWeight = 0.25;
+
+// The most chunks to read from the document cache at a time, so that the
+// document comes in bit by bit, without holding a copy of all of it.
+constexpr uint32_t kMaxCachedChunksPerRead = 16;
+
 // Return true if the HTTP response of `loader` is a successful one and loading
 // should continue. 4xx error indicate subsequent requests will fail too.
 // e.g. resource has been removed from the server while loading it. 301
@@ -71,14 +104,28 @@ DocumentLoaderImpl::Chunk::~Chunk() = default;
 void DocumentLoaderImpl::Chunk::Clear() {
   chunk_index = 0;
   data_size = 0;
-  chunk_data.reset();
 }
 
+DocumentLoaderImpl::RangeLoader::RangeLoader() = default;
+
+DocumentLoaderImpl::RangeLoader::~RangeLoader() = default;
+
 DocumentLoaderImpl::DocumentLoaderImpl(Client* client)
     : client_(client),
       partial_loading_enabled_(
           base::FeatureList::IsEnabled(features::kPdfPartialLoading)),
-      buffer_(kReadBufferSize) {}
+      multi_range_requests_enabled_(
+          base::FeatureList::IsEnabled(features::kPdfMultiRangeRequests)),
+      adaptive_request_size_enabled_(
+          base::FeatureList::IsEnabled(features::kPdfAdaptiveRequestSize)),
+      contiguous_document_data_enabled_(
+          base::FeatureList::IsEnabled(features::kPdfContiguousDocumentData)),
+      buffer_(kReadBufferSize),
+      max_range_loaders_(
+          base::FeatureList::IsEnabled(features::kPdfParallelRangeLoading)
+              ? kDefaultMaxRangeLoaders
+              : 0),
+      range_loader_limit_(max_range_loaders_) {}
 
 DocumentLoaderImpl::~DocumentLoaderImpl() = default;
 
@@ -115,12 +162,22 @@ bool DocumentLoaderImpl::Init(std::unique_ptr<URLLoaderWrapper> loader,
   if (!loader_->IsContentEncoded())
     chunk_stream_.set_eof_pos(std::max(0, loader_->GetContentLength()));
 
+  // Download straight into the buffer that PDFium reads the complete document
+  // from, rather than copying the whole document into it at the end.
+  if (contiguous_document_data_enabled_)
+    chunk_stream_.ReserveContiguous();
+
   SetPartialLoadingEnabled(
       partial_loading_enabled_ &&
       !base::StartsWith(url, "file://", base::CompareCase::INSENSITIVE_ASCII) &&
       loader_->IsAcceptRangesBytes() && !loader_->IsContentEncoded() &&
       GetDocumentSize());
 
+  last_read_time_ = base::TimeTicks::Now();
+  if (OpenCacheEntry()) {
+    // `loader_` waits for the cached chunks, so as not to fetch them again.
+    return true;
+  }
   ReadMore();
   return true;
 }
@@ -152,6 +209,10 @@ bool DocumentLoaderImpl::GetBlock(uint32_t position,
       gfx::Range(position, addition_result.ValueOrDie()), buf);
 }
 
+base::span<const uint8_t> DocumentLoaderImpl::GetCompleteData() const {
+  return chunk_stream_.data();
+}
+
 bool DocumentLoaderImpl::IsDataAvailable(uint32_t position,
                                          uint32_t size) const {
   base::CheckedNumeric<uint32_t> addition_result = position;
@@ -192,6 +253,12 @@ void DocumentLoaderImpl::RequestData(uint32_t position, uint32_t size) {
   requested_chunks.Subtract(chunk_stream_.filled_chunks());
   DCHECK(!requested_chunks.IsEmpty());
   pending_requests_.Union(requested_chunks);
+  StartRangeLoaders();
+}
+
+void DocumentLoaderImpl::SetDocumentCache(AsyncDocumentCache* cache) {
+  DCHECK(url_.empty());
+  document_cache_ = cache;
 }
 
 void DocumentLoaderImpl::SetPartialLoadingEnabled(bool enabled) {
@@ -201,6 +268,24 @@ void DocumentLoaderImpl::SetPartialLoadingEnabled(bool enabled) {
   }
 }
 
+uint32_t DocumentLoaderImpl::GetCloseDistance() const {
+  if (!adaptive_request_size_enabled_ || !bandwidth_estimator_.has_estimate())
+    return kChunkCloseDistance;
+
+  // Reading on through a gap is cheaper than a new request, for as much as the
+  // connection delivers in the time a new request takes to get going.
+  const uint64_t request_cost = bandwidth_estimator_.GetBytesIn(
+      bandwidth_estimator_.round_trip_time().value() + kRequestOverhead);
+  return static_cast<uint32_t>(std::clamp<uint64_t>(
+      request_cost / DataStream::kChunkSize, kMinCloseDistance,
+      kMaxCloseDistance));
+}
+
+void DocumentLoaderImpl::SetMaxRangeLoaders(size_t max_range_loaders) {
+  max_range_loaders_ = max_range_loaders;
+  range_loader_limit_ = max_range_loaders;
+}
+
 bool DocumentLoaderImpl::ShouldCancelLoading() const {
   if (!loader_)
     return true;
@@ -208,15 +293,24 @@ bool DocumentLoaderImpl::ShouldCancelLoading() const {
   if (!partial_loading_enabled_)
     return false;
 
-  if (pending_requests_.IsEmpty()) {
+  // Requests that range loaders fetch are none of `loader_`'s business.
+  const RangeSet unclaimed_requests = GetUnclaimedRequests();
+  if (!multi_range_request_.empty()) {
+    // Keep going while any of the requested ranges is still needed.
+    return std::ranges::none_of(
+        multi_range_request_, [&unclaimed_requests](const gfx::Range& range) {
+          return unclaimed_requests.Intersects(range);
+        });
+  }
+  if (unclaimed_requests.IsEmpty()) {
     // Cancel loading if this is unepected data from server.
     return !chunk_stream_.IsValidChunkIndex(chunk_.chunk_index) ||
            chunk_stream_.IsChunkAvailable(chunk_.chunk_index);
   }
 
   const gfx::Range current_range(chunk_.chunk_index,
-                                 chunk_.chunk_index + kChunkCloseDistance);
-  return !pending_requests_.Intersects(current_range);
+                                 chunk_.chunk_index + GetCloseDistance());
+  return !unclaimed_requests.Intersects(current_range);
 }
 
 void DocumentLoaderImpl::ContinueDownload() {
@@ -227,30 +321,52 @@ void DocumentLoaderImpl::ContinueDownload() {
   DCHECK(!IsDocumentComplete());
   DCHECK_GT(GetDocumentSize(), 0U);
 
+  const RangeSet unclaimed_requests = GetUnclaimedRequests();
+  multi_range_request_.clear();
+  if (multi_range_requests_enabled_) {
+    multi_range_request_ = GetMultiRangeRequest(unclaimed_requests);
+    if (multi_range_request_.size() > 1)
+      return OpenMultiRangeRequest();
+    multi_range_request_.clear();
+  }
+
   const size_t range_start =
-      pending_requests_.IsEmpty() ? 0 : pending_requests_.First().start();
+      unclaimed_requests.IsEmpty() ? 0 : unclaimed_requests.First().start();
   RangeSet candidates_for_request(
       gfx::Range(range_start, chunk_stream_.total_chunks_count()));
   candidates_for_request.Subtract(chunk_stream_.filled_chunks());
-  DCHECK(!candidates_for_request.IsEmpty());
+  for (const auto& range_loader : range_loaders_)
+    candidates_for_request.Subtract(range_loader->chunk_range);
+  if (candidates_for_request.IsEmpty()) {
+    // The range loaders fetch everything that is left. FinishRangeLoader()
+    // resumes from here if any of it goes missing.
+    DCHECK(!range_loaders_.empty());
+    loader_.reset();
+    chunk_.Clear();
+    return;
+  }
   gfx::Range next_request = candidates_for_request.First();
+  const uint32_t close_distance = GetCloseDistance();
   if (candidates_for_request.Size() == 1 &&
-      next_request.length() < kChunkCloseDistance) {
+      next_request.length() < close_distance) {
     // We have only request at the end, try to enlarge it to improve back order
     // reading.
     const int additional_chunks_count =
-        kChunkCloseDistance - next_request.length();
+        close_distance - next_request.length();
     int new_start = std::max(
         0, static_cast<int>(next_request.start()) - additional_chunks_count);
     candidates_for_request =
         RangeSet(gfx::Range(new_start, next_request.end()));
     candidates_for_request.Subtract(chunk_stream_.filled_chunks());
+    for (const auto& range_loader : range_loaders_)
+      candidates_for_request.Subtract(range_loader->chunk_range);
     next_request = candidates_for_request.Last();
   }
 
   loader_.reset();
   chunk_.Clear();
   is_partial_loader_active_ = true;
+  partial_request_start_ = next_request.start();
 
   const size_t start = next_request.start() * DataStream::kChunkSize;
   const size_t length =
@@ -258,10 +374,136 @@ void DocumentLoaderImpl::ContinueDownload() {
                next_request.length() * DataStream::kChunkSize);
 
   loader_ = client_->CreateURLLoader();
+  request_time_ = base::TimeTicks::Now();
 
   loader_->OpenRange(url_, url_, start, length,
                      base::BindOnce(&DocumentLoaderImpl::DidOpenPartial,
                                     weak_factory_.GetWeakPtr()));
+  StartRangeLoaders();
+}
+
+std::vector<gfx::Range> DocumentLoaderImpl::GetMultiRangeRequest(
+    const RangeSet& requests) const {
+  std::vector<gfx::Range> ranges;
+  const uint32_t close_distance = GetCloseDistance();
+  for (const gfx::Range& range : requests.ranges()) {
+    // Fetching a few chunks too many is cheaper than a separate part.
+    if (!ranges.empty() &&
+        range.start() < ranges.back().end() + close_distance) {
+      ranges.back().set_end(range.end());
+      continue;
+    }
+    if (ranges.size() == kMaxRangesPerRequest)
+      break;
+    ranges.push_back(range);
+  }
+  return ranges;
+}
+
+void DocumentLoaderImpl::OpenMultiRangeRequest() {
+  DCHECK_GT(multi_range_request_.size(), 1u);
+
+  loader_.reset();
+  chunk_.Clear();
+  is_partial_loader_active_ = true;
+  partial_request_start_ = multi_range_request_.front().start();
+
+  std::vector<gfx::Range> byte_ranges;
+  for (const gfx::Range& range : multi_range_request_) {
+    const uint32_t start = range.start() * DataStream::kChunkSize;
+    const uint32_t end =
+        std::min(GetDocumentSize(), range.end() * DataStream::kChunkSize);
+    byte_ranges.emplace_back(start, end);
+  }
+
+  loader_ = client_->CreateURLLoader();
+  request_time_ = base::TimeTicks::Now();
+  loader_->OpenRanges(url_, url_, byte_ranges,
+                      base::BindOnce(&DocumentLoaderImpl::DidOpenPartial,
+                                     weak_factory_.GetWeakPtr()));
+  StartRangeLoaders();
+}
+
+bool DocumentLoaderImpl::OpenCacheEntry() {
+  // Only documents of a known size, with validators to tell whether a cached
+  // copy is still current, can be checked against the cache.
+  if (!document_cache_ || GetDocumentSize() == 0 ||
+      (loader_->GetETag().empty() && loader_->GetLastModified().empty())) {
+    return false;
+  }
+
+  document_cache_->OpenEntry(
+      url_, loader_->GetETag(), loader_->GetLastModified(), GetDocumentSize(),
+      DataStream::kChunkSize,
+      base::BindOnce(&DocumentLoaderImpl::DidOpenCacheEntry,
+                     weak_factory_.GetWeakPtr()));
+  return true;
+}
+
+void DocumentLoaderImpl::DidOpenCacheEntry(AsyncDocumentCache::CacheEntry entry,
+                                           RangeSet chunks) {
+  cache_entry_ = std::move(entry);
+  if (cache_entry_.is_null() || chunks.IsEmpty())
+    return ReadMore();
+
+  cached_chunks_ = std::move(chunks);
+  ReadCachedChunks();
+}
+
+void DocumentLoaderImpl::ReadCachedChunks() {
+  if (cached_chunks_.IsEmpty())
+    return DidLoadFromCache();
+
+  gfx::Range chunk_range = cached_chunks_.First();
+  chunk_range.set_end(std::min<uint32_t>(
+      chunk_range.end(), chunk_range.start() + kMaxCachedChunksPerRead));
+  cached_chunks_.Subtract(chunk_range);
+  cache_entry_.AsyncCall(&DocumentCache::Entry::ReadChunks)
+      .WithArgs(chunk_range)
+      .Then(base::BindOnce(&DocumentLoaderImpl::DidReadCachedChunks,
+                           weak_factory_.GetWeakPtr(), chunk_range));
+}
+
+void DocumentLoaderImpl::DidReadCachedChunks(const gfx::Range& chunk_range,
+                                             std::vector<uint8_t> data) {
+  // The chunks that failed to read get fetched instead.
+  if (data.empty())
+    return ReadCachedChunks();
+
+  base::span<const uint8_t> input(data);
+  for (uint32_t i = chunk_range.start(); i < chunk_range.end(); ++i) {
+    base::span<const uint8_t> chunk =
+        input.first(std::min(DataStream::kChunkSize, input.size()));
+    input = input.subspan(chunk.size());
+    if (chunk_stream_.IsChunkAvailable(i))
+      continue;
+
+    chunk_stream_.GetChunkBuffer(i).copy_prefix_from(chunk);
+    chunk_stream_.SetChunkFilled(i);
+    bytes_received_ += chunk.size();
+  }
+
+  const bool loading_pending_request =
+      pending_requests_.Intersects(chunk_range);
+  pending_requests_.Subtract(chunk_range);
+  client_->OnNewDataReceived();
+  if (loading_pending_request && !IsDocumentComplete())
+    client_->OnPendingRequestComplete();
+  ReadCachedChunks();
+}
+
+void DocumentLoaderImpl::DidLoadFromCache() {
+  if (IsDocumentComplete())
+    return ReadComplete();
+
+  // Whatever got requested in the meantime may be in already.
+  if (pending_requests_.IsEmpty())
+    client_->OnPendingRequestComplete();
+
+  // Skip the cached chunks, unless the server only sends the whole document.
+  if (!partial_loading_enabled_)
+    return ReadMore();
+  ContinueDownload();
 }
 
 void DocumentLoaderImpl::DidOpenPartial(int32_t result) {
@@ -271,6 +513,9 @@ void DocumentLoaderImpl::DidOpenPartial(int32_t result) {
   if (!ResponseStatusSuccess(loader_.get()))
     return ReadComplete();
 
+  last_read_time_ = base::TimeTicks::Now();
+  bandwidth_estimator_.AddRoundTrip(last_read_time_ - request_time_);
+
   // Leave position untouched for multiparted responce for now, when we read the
   // data we'll get it.
   if (loader_->IsMultipart()) {
@@ -288,7 +533,7 @@ void DocumentLoaderImpl::DidOpenPartial(int32_t result) {
     if (start_pos % DataStream::kChunkSize != 0)
       return ReadComplete();
 
-    DCHECK(!chunk_.chunk_data);
+    DCHECK_EQ(chunk_.data_size, 0u);
     chunk_.chunk_index = chunk_stream_.GetChunkIndex(start_pos);
   } else {
     SetPartialLoadingEnabled(false);
@@ -315,15 +560,23 @@ void DocumentLoaderImpl::DidRead(int32_t result) {
       return ReadComplete();
     return ContinueDownload();
   }
+  SampleTransfer(static_cast<uint32_t>(result));
   if (loader_->IsMultipart()) {
     int start_pos = 0;
     if (!loader_->GetByteRangeStart(&start_pos))
       return ReadComplete();
 
-    DCHECK(!chunk_.chunk_data);
-    chunk_.chunk_index = chunk_stream_.GetChunkIndex(start_pos);
+    // Each part of a multi-range response continues at another position.
+    if (static_cast<uint32_t>(start_pos) != EndOfChunk(chunk_)) {
+      if (start_pos % DataStream::kChunkSize != 0)
+        return ReadComplete();
+
+      chunk_.Clear();
+      chunk_.chunk_index = chunk_stream_.GetChunkIndex(start_pos);
+    }
   }
-  if (!SaveBuffer(result)) {
+  if (!SaveBuffer(chunk_, base::make_span(buffer_).first(
+                              static_cast<size_t>(result)))) {
     return ReadMore();
   }
   if (IsDocumentComplete())
@@ -331,26 +584,42 @@ void DocumentLoaderImpl::DidRead(int32_t result) {
   return ContinueDownload();
 }
 
-bool DocumentLoaderImpl::SaveBuffer(uint32_t input_size) {
+void DocumentLoaderImpl::SampleTransfer(uint32_t bytes) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+  transfer_sample_duration_ += now - last_read_time_;
+  transfer_sample_bytes_ += bytes;
+  last_read_time_ = now;
+  if (transfer_sample_duration_ < kTransferSampleTime)
+    return;
+
+  bandwidth_estimator_.AddTransfer(transfer_sample_bytes_,
+                                   transfer_sample_duration_);
+  transfer_sample_duration_ = base::TimeDelta();
+  transfer_sample_bytes_ = 0;
+}
+
+bool DocumentLoaderImpl::SaveBuffer(Chunk& chunk,
+                                    base::span<const char> input) {
   const uint32_t document_size = GetDocumentSize();
-  bytes_received_ += input_size;
+  bytes_received_ += input.size();
   bool chunk_saved = false;
-  bool loading_pending_request = pending_requests_.Contains(chunk_.chunk_index);
-  auto input = base::make_span(buffer_).first(input_size);
+  bool loading_pending_request = pending_requests_.Contains(chunk.chunk_index);
   while (!input.empty()) {
-    if (chunk_.data_size == 0)
-      chunk_.chunk_data = std::make_unique<DataStream::ChunkData>();
-
     const size_t new_chunk_data_len =
-        std::min(DataStream::kChunkSize - chunk_.data_size, input.size());
-    memcpy(chunk_.chunk_data->data() + chunk_.data_size, input.data(),
-           new_chunk_data_len);
-    chunk_.data_size += new_chunk_data_len;
-    if (chunk_.data_size == DataStream::kChunkSize ||
-        (document_size > 0 && document_size <= EndOfCurrentChunk())) {
+        std::min(DataStream::kChunkSize - chunk.data_size, input.size());
+    // Chunks are filled in place. Leave the ones that are in already alone,
+    // as other readers may use them.
+    if (!chunk_stream_.IsChunkAvailable(chunk.chunk_index)) {
+      memcpy(chunk_stream_.GetChunkBuffer(chunk.chunk_index).data() +
+                 chunk.data_size,
+             input.data(), new_chunk_data_len);
+    }
+    chunk.data_size += new_chunk_data_len;
+    if (chunk.data_size == DataStream::kChunkSize ||
+        (document_size > 0 && document_size <= EndOfChunk(chunk))) {
       pending_requests_.Subtract(
-          gfx::Range(chunk_.chunk_index, chunk_.chunk_index + 1));
-      SaveChunkData();
+          gfx::Range(chunk.chunk_index, chunk.chunk_index + 1));
+      SaveChunkData(chunk);
       chunk_saved = true;
     }
 
@@ -366,41 +635,215 @@ bool DocumentLoaderImpl::SaveBuffer(uint32_t input_size) {
     return false;
 
   if (loading_pending_request &&
-      !pending_requests_.Contains(chunk_.chunk_index)) {
+      !pending_requests_.Contains(chunk.chunk_index)) {
     client_->OnPendingRequestComplete();
   }
   return true;
 }
 
-void DocumentLoaderImpl::SaveChunkData() {
-  chunk_stream_.SetChunkData(chunk_.chunk_index, std::move(chunk_.chunk_data));
-  chunk_.data_size = 0;
-  ++chunk_.chunk_index;
+void DocumentLoaderImpl::SaveChunkData(Chunk& chunk) {
+  chunk_stream_.SetChunkFilled(chunk.chunk_index);
+  // Leave out chunks that got cut short.
+  if (!cache_entry_.is_null() &&
+      (chunk.data_size == DataStream::kChunkSize ||
+       EndOfChunk(chunk) == GetDocumentSize())) {
+    base::span<const uint8_t> data =
+        chunk_stream_.GetChunkBuffer(chunk.chunk_index).first(chunk.data_size);
+    cache_entry_.AsyncCall(&DocumentCache::Entry::WriteChunk)
+        .WithArgs(chunk.chunk_index,
+                  std::vector<uint8_t>(data.begin(), data.end()));
+  }
+  chunk.data_size = 0;
+  ++chunk.chunk_index;
+}
+
+uint32_t DocumentLoaderImpl::EndOfChunk(const Chunk& chunk) const {
+  return chunk.chunk_index * DataStream::kChunkSize + chunk.data_size;
+}
+
+RangeSet DocumentLoaderImpl::GetUnclaimedRequests() const {
+  RangeSet unclaimed_requests = pending_requests_;
+  for (const auto& range_loader : range_loaders_)
+    unclaimed_requests.Subtract(range_loader->chunk_range);
+  return unclaimed_requests;
+}
+
+void DocumentLoaderImpl::StartRangeLoaders() {
+  if (!loader_ || !partial_loading_enabled_ || !is_partial_loader_active_ ||
+      range_loaders_.size() >= range_loader_limit_) {
+    return;
+  }
+
+  // Leave the requests that `loader_` is about to reach to it.
+  RangeSet holes = GetUnclaimedRequests();
+  const uint32_t loader_position =
+      std::max(chunk_.chunk_index, partial_request_start_);
+  holes.Subtract(
+      gfx::Range(loader_position, loader_position + GetCloseDistance()));
+  for (const gfx::Range& range : multi_range_request_)
+    holes.Subtract(range);
+
+  while (range_loaders_.size() < range_loader_limit_ && !holes.IsEmpty()) {
+    gfx::Range hole = holes.First();
+    hole.set_end(
+        std::min<uint32_t>(hole.end(), hole.start() + kMaxRangeLoaderChunks));
+    holes.Subtract(hole);
+
+    auto range_loader = std::make_unique<RangeLoader>();
+    range_loader->id = next_range_loader_id_++;
+    range_loader->loader = client_->CreateURLLoader();
+    range_loader->buffer.resize(kReadBufferSize);
+    range_loader->chunk.chunk_index = hole.start();
+    range_loader->chunk_range = hole;
+    range_loader->open_time = base::TimeTicks::Now();
+
+    const size_t start = hole.start() * DataStream::kChunkSize;
+    const size_t length = std::min(GetDocumentSize() - start,
+                                   hole.length() * DataStream::kChunkSize);
+    URLLoaderWrapper* url_loader = range_loader->loader.get();
+    const int id = range_loader->id;
+    range_loaders_.push_back(std::move(range_loader));
+    url_loader->OpenRange(
+        url_, url_, start, length,
+        base::BindOnce(&DocumentLoaderImpl::DidOpenRangeLoader,
+                       weak_factory_.GetWeakPtr(), id));
+  }
+}
+
+DocumentLoaderImpl::RangeLoader* DocumentLoaderImpl::FindRangeLoader(int id) {
+  for (const auto& range_loader : range_loaders_) {
+    if (range_loader->id == id)
+      return range_loader.get();
+  }
+  return nullptr;
 }
 
-uint32_t DocumentLoaderImpl::EndOfCurrentChunk() const {
-  return chunk_.chunk_index * DataStream::kChunkSize + chunk_.data_size;
+void DocumentLoaderImpl::DidOpenRangeLoader(int id, int32_t result) {
+  RangeLoader* range_loader = FindRangeLoader(id);
+  if (!range_loader)
+    return;
+
+  URLLoaderWrapper* url_loader = range_loader->loader.get();
+  if (result != Result::kSuccess || !ResponseStatusSuccess(url_loader) ||
+      url_loader->IsMultipart()) {
+    return FinishRangeLoader(id, /*success=*/false);
+  }
+  bandwidth_estimator_.AddRoundTrip(base::TimeTicks::Now() -
+                                    range_loader->open_time);
+
+  // Servers may ignore the range and send the whole document instead, which
+  // `loader_` is better placed to read.
+  int start_pos = 0;
+  if (!url_loader->GetByteRangeStart(&start_pos) ||
+      static_cast<uint32_t>(start_pos) !=
+          range_loader->chunk_range.start() * DataStream::kChunkSize) {
+    return FinishRangeLoader(id, /*success=*/false);
+  }
+
+  ReadMoreRangeLoader(*range_loader);
+}
+
+void DocumentLoaderImpl::ReadMoreRangeLoader(RangeLoader& range_loader) {
+  range_loader.loader->ReadResponseBody(
+      range_loader.buffer,
+      base::BindOnce(&DocumentLoaderImpl::DidReadRangeLoader,
+                     weak_factory_.GetWeakPtr(), range_loader.id));
+}
+
+void DocumentLoaderImpl::DidReadRangeLoader(int id, int32_t result) {
+  RangeLoader* range_loader = FindRangeLoader(id);
+  if (!range_loader)
+    return;
+
+  if (result <= 0)
+    return FinishRangeLoader(id, /*success=*/result == 0);
+
+  range_loader->bytes_received += static_cast<uint32_t>(result);
+  SaveBuffer(range_loader->chunk, base::make_span(range_loader->buffer)
+                                      .first(static_cast<size_t>(result)));
+  if (IsDocumentComplete())
+    return ReadComplete();
+
+  // Stop once the requested range is in, in case the server sends more.
+  if (range_loader->chunk.chunk_index >= range_loader->chunk_range.end())
+    return FinishRangeLoader(id, /*success=*/true);
+
+  ReadMoreRangeLoader(*range_loader);
+}
+
+void DocumentLoaderImpl::FinishRangeLoader(int id, bool success) {
+  auto it = std::find_if(
+      range_loaders_.begin(), range_loaders_.end(),
+      [id](const std::unique_ptr<RangeLoader>& range_loader) {
+        return range_loader->id == id;
+      });
+  CHECK(it != range_loaders_.end());
+
+  if (!success) {
+    // The server may limit concurrent connections or be overloaded. Keep one
+    // range loader, so that a later success can grow the limit again.
+    range_loader_limit_ = std::max<size_t>(range_loader_limit_ / 2, 1);
+  } else {
+    const base::TimeDelta elapsed =
+        base::TimeTicks::Now() - (*it)->open_time;
+    bool slow = false;
+    if (elapsed >= kMinThroughputSampleTime) {
+      const double throughput = (*it)->bytes_received / elapsed.InSecondsF();
+      slow = range_loader_throughput_.has_value() &&
+             throughput < range_loader_throughput_.value() / 2;
+      range_loader_throughput_ =
+          range_loader_throughput_.has_value()
+              ? kThroughputSampleWeight * throughput +
+                    (1 - kThroughputSampleWeight) *
+                        range_loader_throughput_.value()
+              : throughput;
+    }
+    if (slow) {
+      range_loader_limit_ = std::max<size_t>(range_loader_limit_, 2) - 1;
+    } else if (range_loader_limit_ < max_range_loaders_) {
+      ++range_loader_limit_;
+    }
+  }
+  range_loaders_.erase(it);
+
+  if (IsDocumentComplete())
+    return;
+
+  // Any chunks the range loader did not get are pending requests again, and
+  // fall to `loader_` or another range loader.
+  if (!loader_)
+    return ContinueDownload();
+  StartRangeLoaders();
 }
 
 void DocumentLoaderImpl::ReadComplete() {
   if (GetDocumentSize() != 0) {
     // If there is remaining data in `chunk_`, then save whatever can be saved.
-    // e.g. In the underrun case.
-    if (chunk_.data_size != 0)
-      SaveChunkData();
+    // e.g. In the underrun case. Not if a range loader completed the
+    // document, which `chunk_` would then overwrite with partial data.
+    if (chunk_.data_size != 0 && !IsDocumentComplete())
+      SaveChunkData(chunk_);
   } else {
-    size_t eof = EndOfCurrentChunk();
+    size_t eof = EndOfChunk(chunk_);
     if (!chunk_stream_.filled_chunks().IsEmpty()) {
       eof = std::max(
           chunk_stream_.filled_chunks().Last().end() * DataStream::kChunkSize,
           eof);
     }
     chunk_stream_.set_eof_pos(eof);
-    if (eof == EndOfCurrentChunk())
-      SaveChunkData();
+    if (eof == EndOfChunk(chunk_))
+      SaveChunkData(chunk_);
   }
   loader_.reset();
+  range_loaders_.clear();
+  multi_range_request_.clear();
+  if (!cache_entry_.is_null())
+    cache_entry_.AsyncCall(&DocumentCache::Entry::Flush);
   if (IsDocumentComplete()) {
+    // Nothing writes to the chunks anymore, so they can be gathered up for
+    // PDFium to read the document straight from memory.
+    if (contiguous_document_data_enabled_)
+      chunk_stream_.MakeContiguous();
     client_->OnDocumentComplete();
   } else {
     client_->OnDocumentCanceled();
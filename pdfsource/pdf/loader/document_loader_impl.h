@@ -5,16 +5,24 @@
 #ifndef PDF_LOADER_DOCUMENT_LOADER_IMPL_H_
 #define PDF_LOADER_DOCUMENT_LOADER_IMPL_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "pdf/loader/bandwidth_estimator.h"
 #include "pdf/loader/chunk_stream.h"
+#include "pdf/loader/document_cache.h"
 #include "pdf/loader/document_loader.h"
+#include "pdf/loader/range_set.h"
+#include "ui/gfx/range/range.h"
 
 namespace chrome_pdf {
 
@@ -23,6 +31,10 @@ class DocumentLoaderImpl : public DocumentLoader {
   // Number was chosen in https://crbug.com/78264#c8
   static constexpr uint32_t kDefaultRequestSize = 65536;
 
+  // The number of range loaders to run alongside the main loader when the
+  // `kPdfParallelRangeLoading` feature is enabled.
+  static constexpr size_t kDefaultMaxRangeLoaders = 4;
+
   explicit DocumentLoaderImpl(Client* client);
   DocumentLoaderImpl(const DocumentLoaderImpl&) = delete;
   DocumentLoaderImpl& operator=(const DocumentLoaderImpl&) = delete;
@@ -32,6 +44,7 @@ class DocumentLoaderImpl : public DocumentLoader {
   bool Init(std::unique_ptr<URLLoaderWrapper> loader,
             const std::string& url) override;
   bool GetBlock(uint32_t position, uint32_t size, void* buf) const override;
+  base::span<const uint8_t> GetCompleteData() const override;
   bool IsDataAvailable(uint32_t position, uint32_t size) const override;
   void RequestData(uint32_t position, uint32_t size) override;
   bool IsDocumentComplete() const override;
@@ -39,9 +52,22 @@ class DocumentLoaderImpl : public DocumentLoader {
   uint32_t BytesReceived() const override;
   void ClearPendingRequests() override;
 
+  // Keeps the downloaded chunks in `cache`, which must outlive the loader, and
+  // starts from the chunks it has for the document. Must be called before
+  // Init().
+  void SetDocumentCache(AsyncDocumentCache* cache);
+
   // Exposed for unit tests.
   void SetPartialLoadingEnabled(bool enabled);
   bool is_partial_loader_active() const { return is_partial_loader_active_; }
+  void SetMaxRangeLoaders(size_t max_range_loaders);
+  size_t range_loader_count() const { return range_loaders_.size(); }
+  size_t range_loader_limit() const { return range_loader_limit_; }
+
+  // Returns how many chunks ahead of the loader's position a request may be
+  // to get served by reading on, rather than by a new request. Also the
+  // smallest number of chunks to request.
+  uint32_t GetCloseDistance() const;
 
  private:
   using DataStream = ChunkStream<kDefaultRequestSize>;
@@ -52,10 +78,46 @@ class DocumentLoaderImpl : public DocumentLoader {
     void Clear();
 
     uint32_t chunk_index = 0;
+
+    // The bytes of the chunk that are filled in already.
     uint32_t data_size = 0;
-    std::unique_ptr<DataStream::ChunkData> chunk_data;
   };
 
+  // A connection that fetches one hole of `pending_requests_` alongside
+  // `loader_`, so that scattered requests do not wait for each other.
+  struct RangeLoader {
+    RangeLoader();
+    ~RangeLoader();
+
+    int id = 0;
+    std::unique_ptr<URLLoaderWrapper> loader;
+    std::vector<char> buffer;
+    Chunk chunk;
+
+    // The chunks requested from the server.
+    gfx::Range chunk_range;
+
+    // For measuring the throughput of the connection.
+    base::TimeTicks open_time;
+    uint64_t bytes_received = 0;
+  };
+
+  // Opens the document's entry in `document_cache_`, to fill `chunk_stream_`
+  // with the chunks it has before `loader_` carries on. Returns false if the
+  // document cannot be cached.
+  bool OpenCacheEntry();
+  void DidOpenCacheEntry(AsyncDocumentCache::CacheEntry entry,
+                         RangeSet chunks);
+
+  // Reads the next few of `cached_chunks_` into `chunk_stream_`, until all of
+  // them are in.
+  void ReadCachedChunks();
+  void DidReadCachedChunks(const gfx::Range& chunk_range,
+                           std::vector<uint8_t> data);
+
+  // Carries on loading the chunks that did not come from the cache.
+  void DidLoadFromCache();
+
   // Called by the completion callback of the document's URLLoader.
   void DidOpenPartial(int32_t result);
 
@@ -65,16 +127,48 @@ class DocumentLoaderImpl : public DocumentLoader {
   // Called by the completion callback of the document's URLLoader.
   void DidRead(int32_t result);
 
+  // Feeds `bytes` read by `loader_` into `bandwidth_estimator_`.
+  void SampleTransfer(uint32_t bytes);
+
   bool ShouldCancelLoading() const;
   void ContinueDownload();
 
+  // Returns the ranges of `requests` to fetch with a single multi-range
+  // request, merging the ones that are close to each other. Returns fewer than
+  // two ranges if a multi-range request is pointless.
+  std::vector<gfx::Range> GetMultiRangeRequest(const RangeSet& requests) const;
+
+  // Starts `loader_` on the ranges of chunks in `multi_range_request_`.
+  void OpenMultiRangeRequest();
+
   // Called when we complete server request.
   void ReadComplete();
 
-  bool SaveBuffer(uint32_t input_size);
-  void SaveChunkData();
+  // Saves `input` into `chunk`, moving every completed chunk into
+  // `chunk_stream_`. Returns whether `chunk` or the document got completed.
+  bool SaveBuffer(Chunk& chunk, base::span<const char> input);
+  void SaveChunkData(Chunk& chunk);
 
-  uint32_t EndOfCurrentChunk() const;
+  uint32_t EndOfChunk(const Chunk& chunk) const;
+
+  // Returns the chunks of `pending_requests_` that no range loader fetches.
+  RangeSet GetUnclaimedRequests() const;
+
+  // Starts range loaders for the holes in `pending_requests_` that `loader_`
+  // will not reach soon, up to `range_loader_limit_` of them.
+  void StartRangeLoaders();
+
+  // Returns the range loader with `id`, or nullptr if it is gone.
+  RangeLoader* FindRangeLoader(int id);
+
+  // Called by the completion callbacks of the range loader with `id`.
+  void DidOpenRangeLoader(int id, int32_t result);
+  void DidReadRangeLoader(int id, int32_t result);
+  void ReadMoreRangeLoader(RangeLoader& range_loader);
+
+  // Removes the range loader with `id`, adjusting `range_loader_limit_` by
+  // how well it did, and hands its remaining chunks to the other loaders.
+  void FinishRangeLoader(int id, bool success);
 
   const raw_ptr<Client> client_;
   std::string url_;
@@ -82,6 +176,9 @@ class DocumentLoaderImpl : public DocumentLoader {
 
   DataStream chunk_stream_;
   bool partial_loading_enabled_;  // Default determined by `kPdfPartialLoading`.
+  const bool multi_range_requests_enabled_;
+  const bool adaptive_request_size_enabled_;
+  const bool contiguous_document_data_enabled_;
   bool is_partial_loader_active_ = false;
 
   std::vector<char> buffer_;
@@ -92,8 +189,51 @@ class DocumentLoaderImpl : public DocumentLoader {
   // In units of Chunks.
   RangeSet pending_requests_;
 
+  // The first chunk of the range most recently requested by `loader_`.
+  uint32_t partial_request_start_ = 0;
+
+  // The ranges of chunks requested by `loader_`, if it fetches several ranges
+  // with one multi-range request. Empty otherwise.
+  std::vector<gfx::Range> multi_range_request_;
+
+  // Range loaders running alongside `loader_`, at most `range_loader_limit_`.
+  // The limit starts at `max_range_loaders_`, is halved whenever a range
+  // loader fails, and shrinks by one when a connection is much slower than
+  // the ones before it, as more connections then just compete for bandwidth.
+  // It never drops below one, and grows back by one with every range loader
+  // that does well.
+  std::vector<std::unique_ptr<RangeLoader>> range_loaders_;
+  size_t max_range_loaders_;
+  size_t range_loader_limit_;
+  int next_range_loader_id_ = 0;
+
+  // Smoothed throughput of the range loaders that completed so far, in bytes
+  // per second.
+  std::optional<double> range_loader_throughput_;
+
   uint32_t bytes_received_ = 0;
 
+  raw_ptr<AsyncDocumentCache> document_cache_ = nullptr;
+
+  // The document's entry in `document_cache_`, if it can be cached, and the
+  // chunks of it that are still to be read.
+  AsyncDocumentCache::CacheEntry cache_entry_;
+  RangeSet cached_chunks_;
+
+  // Measures the connection, for adapting the size of the requests when
+  // `adaptive_request_size_enabled_` is set.
+  BandwidthEstimator bandwidth_estimator_;
+
+  // When `loader_` sent its request, and when it last received data or
+  // response headers.
+  base::TimeTicks request_time_;
+  base::TimeTicks last_read_time_;
+
+  // The time `loader_` spent receiving data, leaving out waits for responses,
+  // and the bytes it received, since the last sample of the transfer speed.
+  base::TimeDelta transfer_sample_duration_;
+  uint64_t transfer_sample_bytes_ = 0;
+
   base::WeakPtrFactory<DocumentLoaderImpl> weak_factory_{this};
 };
 
@@ -6,14 +6,23 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/check.h"
+#include "base/containers/contains.h"
+#include "base/containers/span.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/functional/callback.h"
 #include "base/memory/raw_ptr.h"
+#include "base/test/run_until.h"
 #include "base/test/scoped_feature_list.h"
+#include "base/test/scoped_mock_clock_override.h"
+#include "base/time/time.h"
+#include "pdf/loader/document_cache.h"
+#include "pdf/loader/range_set.h"
 #include "pdf/loader/url_loader_wrapper.h"
 #include "pdf/pdf_features.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -154,6 +163,10 @@ class TestURLLoader : public URLLoaderWrapper {
     return data_->content_disposition();
   }
 
+  std::string GetETag() const override { return ""; }
+
+  std::string GetLastModified() const override { return ""; }
+
   int GetStatusCode() const override { return data_->status_code(); }
 
   bool IsMultipart() const override { return data_->is_multipart(); }
@@ -174,6 +187,15 @@ class TestURLLoader : public URLLoaderWrapper {
                            gfx::Range(position, position + size));
   }
 
+  void OpenRanges(const std::string& url,
+                  const std::string& referrer_url,
+                  base::span<const gfx::Range> byte_ranges,
+                  base::OnceCallback<void(int)> callback) override {
+    data_->SetOpenCallback(
+        std::move(callback),
+        gfx::Range(byte_ranges.front().start(), byte_ranges.back().end()));
+  }
+
   void ReadResponseBody(base::span<char> /*buffer*/,
                         base::OnceCallback<void(int)> callback) override {
     data_->SetReadCallback(std::move(callback));
@@ -250,6 +272,226 @@ class MockClient : public TestClient {
   MOCK_METHOD(void, OnDocumentCanceled, (), (override));
 };
 
+// Returns the byte at `offset` of the document served by `RangeServer`.
+char GetDocumentByte(uint32_t offset) {
+  return static_cast<char>((offset * 7) ^ (offset >> 16));
+}
+
+// Stands in for an HTTP server that supports byte range requests. Every
+// loader it creates is a separate connection, and RunUntilIdle() serves them
+// all in turn, as if they were transferring data at the same time.
+class RangeServer {
+ public:
+  // A connection to the server. Without a call to OpenRange() or OpenRanges(),
+  // it serves the whole document, like the loader that starts the document
+  // load. Serves multi-range requests the way `URLLoaderWrapperImpl` passes
+  // them on, one range at a time.
+  class Loader : public URLLoaderWrapper {
+   public:
+    explicit Loader(RangeServer* server) : server_(server) {
+      server_->loaders_.push_back(this);
+    }
+    Loader(const Loader&) = delete;
+    Loader& operator=(const Loader&) = delete;
+    ~Loader() override { std::erase(server_->loaders_, this); }
+
+    // URLLoaderWrapper:
+    int GetContentLength() const override {
+      return static_cast<int>(server_->document_size_);
+    }
+    bool IsAcceptRangesBytes() const override { return true; }
+    bool IsContentEncoded() const override { return false; }
+    std::string GetContentType() const override { return "application/pdf"; }
+    std::string GetContentDisposition() const override { return ""; }
+    std::string GetETag() const override { return server_->etag_; }
+    std::string GetLastModified() const override { return ""; }
+    int GetStatusCode() const override { return status_code_; }
+    bool IsMultipart() const override { return ranges_.size() > 1; }
+    bool GetByteRangeStart(int* start) const override {
+      *start = static_cast<int>(byte_range_start_);
+      return !ranges_.empty();
+    }
+    void Close() override {}
+    void OpenRange(const std::string& url,
+                   const std::string& referrer_url,
+                   uint32_t position,
+                   uint32_t size,
+                   base::OnceCallback<void(int)> callback) override {
+      const gfx::Range range(position, position + size);
+      OpenRanges(url, referrer_url, base::span_from_ref(range),
+                 std::move(callback));
+    }
+    void OpenRanges(const std::string& url,
+                    const std::string& referrer_url,
+                    base::span<const gfx::Range> byte_ranges,
+                    base::OnceCallback<void(int)> callback) override {
+      ranges_.assign(byte_ranges.begin(), byte_ranges.end());
+      position_ = ranges_.front().start();
+      byte_range_start_ = position_;
+      open_callback_ = std::move(callback);
+      server_->requests_.push_back(ranges_);
+      server_->max_connections_ =
+          std::max(server_->max_connections_, server_->loaders_.size());
+    }
+    void ReadResponseBody(base::span<char> buffer,
+                          base::OnceCallback<void(int)> callback) override {
+      read_buffer_ = buffer;
+      read_callback_ = std::move(callback);
+    }
+
+    bool IsWaiting() const { return open_callback_ || read_callback_; }
+
+    // Runs the pending callback, if any.
+    void Serve() {
+      if (open_callback_) {
+        bool fail = false;
+        if (server_->range_requests_to_pass_ > 0) {
+          --server_->range_requests_to_pass_;
+        } else if (server_->range_requests_to_fail_ > 0) {
+          --server_->range_requests_to_fail_;
+          fail = true;
+        }
+        status_code_ = fail ? 404 : 206;
+        server_->AdvanceClock(server_->round_trip_time_);
+        std::move(open_callback_).Run(0);
+        return;
+      }
+      if (!read_callback_)
+        return;
+
+      uint32_t end = server_->document_size_;
+      if (!ranges_.empty()) {
+        while (part_ + 1 < ranges_.size() &&
+               position_ >= ranges_[part_].end()) {
+          position_ = ranges_[++part_].start();
+        }
+        end = ranges_[part_].end();
+      }
+      uint32_t length = std::min(
+          {end - position_, kDefaultRequestSize,
+           static_cast<uint32_t>(read_buffer_.size())});
+      if (!ranges_.empty() &&
+          ranges_.front().start() == server_->slow_range_start_) {
+        length = std::max<uint32_t>(length / server_->slow_range_factor_, 1);
+      }
+      for (uint32_t i = 0; i < length; ++i)
+        read_buffer_[i] = GetDocumentByte(position_ + i);
+      if (IsMultipart())
+        byte_range_start_ = position_;
+      position_ += length;
+      if (server_->bandwidth_ > 0)
+        server_->AdvanceClock(base::Seconds(length / server_->bandwidth_));
+      std::move(read_callback_).Run(static_cast<int>(length));
+    }
+
+   private:
+    const raw_ptr<RangeServer> server_;
+    std::vector<gfx::Range> ranges_;
+    size_t part_ = 0;
+    uint32_t position_ = 0;
+    uint32_t byte_range_start_ = 0;
+    int status_code_ = 200;
+    base::OnceCallback<void(int)> open_callback_;
+    base::span<char> read_buffer_;
+    base::OnceCallback<void(int)> read_callback_;
+  };
+
+  explicit RangeServer(uint32_t document_size)
+      : document_size_(document_size) {}
+
+  std::unique_ptr<URLLoaderWrapper> CreateLoader() {
+    return std::make_unique<Loader>(this);
+  }
+
+  // Serves the open connections one step at a time, round robin, until none
+  // of them waits for anything.
+  void RunUntilIdle() {
+    bool served = true;
+    while (served) {
+      served = false;
+      // Serving a loader may create or destroy loaders.
+      std::vector<raw_ptr<Loader>> loaders = loaders_;
+      for (Loader* loader : loaders) {
+        if (base::Contains(loaders_, loader) && loader->IsWaiting()) {
+          loader->Serve();
+          served = true;
+        }
+      }
+    }
+  }
+
+  // Makes `count` range requests fail, after the next `skip` ones succeed.
+  void FailRangeRequests(int skip, int count) {
+    range_requests_to_pass_ = skip;
+    range_requests_to_fail_ = count;
+  }
+
+  // Makes the responses take as long as over a link with the given round trip
+  // time and bandwidth, in bytes per second, as measured by `clock`.
+  void SimulateLink(base::ScopedMockClockOverride* clock,
+                    base::TimeDelta round_trip_time,
+                    double bandwidth) {
+    clock_ = clock;
+    round_trip_time_ = round_trip_time;
+    bandwidth_ = bandwidth;
+  }
+
+  // Makes the connection for the range request starting at `start` read
+  // `factor` times less per response than the others, like a connection the
+  // server throttles.
+  void SlowDownRange(uint32_t start, uint32_t factor) {
+    slow_range_start_ = start;
+    slow_range_factor_ = factor;
+  }
+
+  // Makes the responses carry `etag`, so that the document can be cached.
+  void set_etag(const std::string& etag) { etag_ = etag; }
+
+  // The most connections that were open at once.
+  size_t max_connections() const { return max_connections_; }
+
+  // The byte ranges of every range request so far.
+  const std::vector<std::vector<gfx::Range>>& requests() const {
+    return requests_;
+  }
+
+ private:
+  void AdvanceClock(base::TimeDelta delta) {
+    if (clock_)
+      clock_->Advance(delta);
+  }
+
+  const uint32_t document_size_;
+  std::vector<raw_ptr<Loader>> loaders_;
+  raw_ptr<base::ScopedMockClockOverride> clock_ = nullptr;
+  base::TimeDelta round_trip_time_;
+  double bandwidth_ = 0;
+  size_t max_connections_ = 0;
+  std::vector<std::vector<gfx::Range>> requests_;
+  int range_requests_to_pass_ = 0;
+  int range_requests_to_fail_ = 0;
+  std::optional<uint32_t> slow_range_start_;
+  uint32_t slow_range_factor_ = 1;
+  std::string etag_;
+};
+
+class RangeServerClient : public DocumentLoader::Client {
+ public:
+  explicit RangeServerClient(RangeServer* server) : server_(server) {}
+
+  // DocumentLoader::Client:
+  std::unique_ptr<URLLoaderWrapper> CreateURLLoader() override {
+    return server_->CreateLoader();
+  }
+  void OnPendingRequestComplete() override {}
+  void OnNewDataReceived() override {}
+  void OnDocumentComplete() override {}
+  void OnDocumentCanceled() override {}
+
+ private:
+  const raw_ptr<RangeServer> server_;
+};
+
 }  // namespace
 
 class DocumentLoaderImplTest : public testing::Test {
@@ -1191,4 +1433,256 @@ TEST_F(DocumentLoaderImplTest, IgnoreDataMoreThanExpectedWithPartialAtFileEnd) {
   EXPECT_TRUE(client.partial_loader_data()->closed());
 }
 
+TEST_F(DocumentLoaderImplTest, ParallelRangeLoaders) {
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 160;
+  RangeServer server(kDocSize);
+  RangeServerClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  loader.SetMaxRangeLoaders(3);
+  loader.Init(server.CreateLoader(), "http://url.com");
+
+  // Scattered requests, too far apart for one connection to serve together.
+  const uint32_t kRequestedChunks[] = {40, 80, 120, 150};
+  for (uint32_t chunk : kRequestedChunks)
+    loader.RequestData(chunk * kDefaultRequestSize, 100);
+
+  server.RunUntilIdle();
+  EXPECT_TRUE(loader.IsDocumentComplete());
+  EXPECT_EQ(0u, loader.range_loader_count());
+  EXPECT_EQ(3u, loader.range_loader_limit());
+
+  // The main loader and three range loaders fetched at the same time.
+  EXPECT_EQ(4u, server.max_connections());
+
+  std::vector<char> block(kDefaultRequestSize);
+  for (uint32_t chunk : {0u, 40u, 79u, 80u, 120u, 150u, 159u}) {
+    const uint32_t offset = chunk * kDefaultRequestSize;
+    ASSERT_TRUE(loader.GetBlock(offset, kDefaultRequestSize, block.data()));
+    for (uint32_t i = 0; i < kDefaultRequestSize; ++i)
+      ASSERT_EQ(GetDocumentByte(offset + i), block[i]) << offset + i;
+  }
+}
+
+TEST_F(DocumentLoaderImplTest, RangeLoadersBackOffOnFailure) {
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 160;
+  RangeServer server(kDocSize);
+  RangeServerClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  loader.SetMaxRangeLoaders(4);
+  loader.Init(server.CreateLoader(), "http://url.com");
+  for (uint32_t chunk : {40u, 80u, 120u, 150u})
+    loader.RequestData(chunk * kDefaultRequestSize, 100);
+
+  // The main loader's range request succeeds, and the three range loaders
+  // fail, halving the limit each time. It stops at one, so a range loader
+  // starts again, succeeds and grows the limit back.
+  server.FailRangeRequests(/*skip=*/1, /*count=*/3);
+  server.RunUntilIdle();
+  EXPECT_LE(2u, loader.range_loader_limit());
+  EXPECT_EQ(4u, server.max_connections());
+
+  EXPECT_TRUE(loader.IsDocumentComplete());
+  EXPECT_EQ(0u, loader.range_loader_count());
+}
+
+TEST_F(DocumentLoaderImplTest, RangeLoadersBackOffOnSlowConnection) {
+  base::ScopedMockClockOverride clock;
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 160;
+  RangeServer server(kDocSize);
+  server.SimulateLink(&clock, base::Milliseconds(100),
+                      /*bandwidth=*/10 * kDefaultRequestSize);
+  RangeServerClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  loader.SetMaxRangeLoaders(2);
+  loader.Init(server.CreateLoader(), "http://url.com");
+  for (uint32_t chunk : {40u, 80u, 120u})
+    loader.RequestData(chunk * kDefaultRequestSize, 100);
+
+  // The main loader goes to the first request, and two range loaders to the
+  // others. The range loader for the last one gets throttled, so it finishes
+  // with a fraction of the throughput the other one had, which takes one
+  // range loader off the limit. Nothing starts range loaders after that.
+  server.SlowDownRange(120 * kDefaultRequestSize, /*factor=*/16);
+  server.RunUntilIdle();
+  EXPECT_EQ(3u, server.max_connections());
+  EXPECT_EQ(1u, loader.range_loader_limit());
+
+  EXPECT_TRUE(loader.IsDocumentComplete());
+  EXPECT_EQ(0u, loader.range_loader_count());
+}
+
+TEST_F(DocumentLoaderImplTest, MultiRangeRequest) {
+  base::test::ScopedFeatureList feature_list(features::kPdfMultiRangeRequests);
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 160;
+  RangeServer server(kDocSize);
+  RangeServerClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  loader.Init(server.CreateLoader(), "http://url.com");
+
+  // Scattered requests, where chunks 80 and 85 are close enough to be fetched
+  // together.
+  for (uint32_t chunk : {40u, 80u, 85u, 120u, 159u})
+    loader.RequestData(chunk * kDefaultRequestSize, 100);
+
+  server.RunUntilIdle();
+  EXPECT_TRUE(loader.IsDocumentComplete());
+
+  ASSERT_FALSE(server.requests().empty());
+  const std::vector<gfx::Range> kExpectedRanges = {
+      gfx::Range(40 * kDefaultRequestSize, 41 * kDefaultRequestSize),
+      gfx::Range(80 * kDefaultRequestSize, 86 * kDefaultRequestSize),
+      gfx::Range(120 * kDefaultRequestSize, 121 * kDefaultRequestSize),
+      gfx::Range(159 * kDefaultRequestSize, kDocSize),
+  };
+  EXPECT_EQ(kExpectedRanges, server.requests()[0]);
+
+  // Once the requests are in, the rest of the document comes in one range
+  // after another.
+  for (size_t i = 1; i < server.requests().size(); ++i)
+    EXPECT_EQ(1u, server.requests()[i].size());
+
+  std::vector<char> block(kDefaultRequestSize);
+  for (uint32_t chunk : {40u, 80u, 83u, 85u, 120u, 159u}) {
+    const uint32_t offset = chunk * kDefaultRequestSize;
+    ASSERT_TRUE(loader.GetBlock(offset, kDefaultRequestSize, block.data()));
+    for (uint32_t i = 0; i < kDefaultRequestSize; ++i)
+      ASSERT_EQ(GetDocumentByte(offset + i), block[i]) << offset + i;
+  }
+}
+
+TEST_F(DocumentLoaderImplTest, AdaptiveRequestSize) {
+  base::test::ScopedFeatureList feature_list(features::kPdfAdaptiveRequestSize);
+  base::ScopedMockClockOverride clock;
+
+  struct {
+    base::TimeDelta round_trip_time;
+    double bandwidth;
+    uint32_t expected_close_distance;
+  } const kLinks[] = {
+      // A fast LAN reads on through 100 MB / s * (1 ms + 20 ms) = 32 chunks,
+      // counting the overhead of a new request.
+      {base::Milliseconds(1), 100e6, 32},
+      // A slow mobile link cannot even read one chunk in that time.
+      {base::Milliseconds(150), 250e3, 1},
+  };
+  for (const auto& link : kLinks) {
+    RangeServer server(kDefaultRequestSize * 160);
+    server.SimulateLink(&clock, link.round_trip_time, link.bandwidth);
+    RangeServerClient client(&server);
+    DocumentLoaderImpl loader(&client);
+    loader.Init(server.CreateLoader(), "http://url.com");
+    EXPECT_EQ(10u, loader.GetCloseDistance());
+
+    // A range request, to measure the round trip time.
+    loader.RequestData(100 * kDefaultRequestSize, 100);
+    server.RunUntilIdle();
+    EXPECT_TRUE(loader.IsDocumentComplete());
+    EXPECT_EQ(link.expected_close_distance, loader.GetCloseDistance());
+  }
+}
+
+TEST_F(DocumentLoaderImplTest, ContiguousDocumentData) {
+  base::test::ScopedFeatureList feature_list(
+      features::kPdfContiguousDocumentData);
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 20 + 100;
+  RangeServer server(kDocSize);
+  RangeServerClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  loader.Init(server.CreateLoader(), "http://url.com");
+  loader.RequestData(15 * kDefaultRequestSize, 100);
+  EXPECT_TRUE(loader.GetCompleteData().empty());
+
+  server.RunUntilIdle();
+  ASSERT_TRUE(loader.IsDocumentComplete());
+
+  base::span<const uint8_t> data = loader.GetCompleteData();
+  ASSERT_EQ(kDocSize, data.size());
+  for (uint32_t i = 0; i < kDocSize; ++i)
+    ASSERT_EQ(GetDocumentByte(i), static_cast<char>(data[i])) << i;
+
+  // Reading blocks keeps working off the contiguous data.
+  std::vector<char> block(200);
+  ASSERT_TRUE(loader.GetBlock(kDocSize - 200, 200, block.data()));
+  for (uint32_t i = 0; i < 200; ++i)
+    ASSERT_EQ(GetDocumentByte(kDocSize - 200 + i), block[i]) << i;
+}
+
+TEST_F(DocumentLoaderImplTest, NoContiguousDocumentDataByDefault) {
+  TestClient client;
+  DocumentLoaderImpl loader(&client);
+  loader.Init(client.CreateFullPageLoader(), "http://url.com");
+  while (client.full_page_loader_data()->IsWaitRead())
+    client.full_page_loader_data()->CallReadCallback(1000);
+  EXPECT_TRUE(loader.IsDocumentComplete());
+  EXPECT_TRUE(loader.GetCompleteData().empty());
+}
+
+TEST_F(DocumentLoaderImplTest, DocumentCache) {
+  constexpr uint32_t kDocSize = kDefaultRequestSize * 20 + 100;
+  constexpr char kUrl[] = "http://url.com";
+  constexpr int64_t kMaxCacheSize = 1 << 30;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // An earlier visit left the first half of the document in the cache.
+  {
+    DocumentCache cache(temp_dir.GetPath(), kMaxCacheSize);
+    std::unique_ptr<DocumentCache::Entry> entry = cache.OpenEntry(
+        kUrl, "\"v1\"", "", kDocSize, kDefaultRequestSize);
+    ASSERT_TRUE(entry);
+    std::vector<uint8_t> chunk(kDefaultRequestSize);
+    for (uint32_t i = 0; i < 10; ++i) {
+      const uint32_t offset = i * kDefaultRequestSize;
+      for (uint32_t j = 0; j < kDefaultRequestSize; ++j)
+        chunk[j] = static_cast<uint8_t>(GetDocumentByte(offset + j));
+      ASSERT_TRUE(entry->WriteChunk(i, chunk));
+    }
+  }
+
+  AsyncDocumentCache cache(temp_dir.GetPath(), kMaxCacheSize);
+  RangeServer server(kDocSize);
+  server.set_etag("\"v1\"");
+  RangeServerClient client(&server);
+  {
+    DocumentLoaderImpl loader(&client);
+    loader.SetDocumentCache(&cache);
+    loader.Init(server.CreateLoader(), kUrl);
+
+    // The cached chunks come in without blocking Init().
+    ASSERT_TRUE(base::test::RunUntil([&loader]() {
+      return loader.IsDataAvailable(0, 10 * kDefaultRequestSize);
+    }));
+    EXPECT_FALSE(loader.IsDocumentComplete());
+
+    server.RunUntilIdle();
+    ASSERT_TRUE(loader.IsDocumentComplete());
+
+    // Only the second half got fetched.
+    const std::vector<std::vector<gfx::Range>> kExpectedRequests = {
+        {gfx::Range(10 * kDefaultRequestSize, kDocSize)}};
+    EXPECT_EQ(kExpectedRequests, server.requests());
+
+    std::vector<char> block(kDefaultRequestSize);
+    for (uint32_t offset : {0u, 9 * kDefaultRequestSize}) {
+      ASSERT_TRUE(loader.GetBlock(offset, kDefaultRequestSize, block.data()));
+      for (uint32_t i = 0; i < kDefaultRequestSize; ++i)
+        ASSERT_EQ(GetDocumentByte(offset + i), block[i]) << offset + i;
+    }
+  }
+
+  // Now the cache has all of it, and another visit needs no requests at all.
+  DocumentLoaderImpl loader(&client);
+  loader.SetDocumentCache(&cache);
+  loader.Init(server.CreateLoader(), kUrl);
+  ASSERT_TRUE(base::test::RunUntil(
+      [&loader]() { return loader.IsDocumentComplete(); }));
+  EXPECT_EQ(1u, server.requests().size());
+
+  std::vector<char> block(kDefaultRequestSize);
+  const uint32_t offset = 20 * kDefaultRequestSize;
+  ASSERT_TRUE(loader.GetBlock(offset, 100, block.data()));
+  for (uint32_t i = 0; i < 100; ++i)
+    ASSERT_EQ(GetDocumentByte(offset + i), block[i]) << offset + i;
+}
+
 }  // namespace chrome_pdf
@@ -0,0 +1,373 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays traces of the reads PDFium makes while loading a document against a
+// `DocumentLoaderImpl` that loads the document over a simulated network link,
+// and reports how long the reads waited for data. Pass
+// --pdf-access-trace=<path> to replay a recorded trace instead of the built-in
+// one. A recorded trace has one read per line, as "<offset> <size>".
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/command_line.h"
+#include "base/containers/span.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/scoped_mock_clock_override.h"
+#include "base/time/time.h"
+#include "pdf/loader/document_loader.h"
+#include "pdf/loader/document_loader_impl.h"
+#include "pdf/loader/url_loader_wrapper.h"
+#include "pdf/pdf_features.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "ui/gfx/range/range.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+constexpr char kAccessTraceSwitch[] = "pdf-access-trace";
+
+// The most bytes a simulated connection delivers per read.
+constexpr uint32_t kMaxReadSize = 64 * 1024;
+
+struct Link {
+  const char* name;
+  base::TimeDelta round_trip_time;
+  // In bytes per second, shared by all the connections.
+  double bandwidth;
+};
+
+constexpr Link kLinks[] = {
+    {"lan", base::Milliseconds(1), 100e6},
+    {"broadband", base::Milliseconds(30), 5e6},
+    {"mobile", base::Milliseconds(150), 250e3},
+};
+
+// A read of `size` bytes at `offset` by PDFium.
+struct Access {
+  uint32_t offset;
+  uint32_t size;
+};
+
+// Returns a trace in the shape PDFium reads a 20 MiB linearized document with
+// 100 pages: the header and first page, the cross-reference table at the end,
+// then the objects and content streams of the other pages, along with the
+// fonts and images they share.
+std::vector<Access> GetBuiltInTrace() {
+  constexpr uint32_t kKiB = 1024;
+  constexpr uint32_t kDocumentSize = 20 * 1024 * kKiB;
+  constexpr uint32_t kPageCount = 100;
+  constexpr uint32_t kResourcesStart = 300 * kKiB;
+  constexpr uint32_t kResourcesSize = 700 * kKiB;
+  constexpr uint32_t kPagesStart = kResourcesStart + kResourcesSize;
+  constexpr uint32_t kPagesSize = kDocumentSize - kPagesStart - 64 * kKiB;
+
+  std::vector<Access> trace;
+  trace.push_back({0, kKiB});
+  for (uint32_t offset = kKiB; offset < kResourcesStart; offset += 4 * kKiB)
+    trace.push_back({offset, 4 * kKiB});
+  for (uint32_t offset = kDocumentSize - 64 * kKiB; offset < kDocumentSize;
+       offset += 8 * kKiB) {
+    trace.push_back({offset, 8 * kKiB});
+  }
+  for (uint32_t page = 1; page < kPageCount; ++page) {
+    const uint32_t page_offset =
+        kPagesStart + page * (kPagesSize / kPageCount);
+    trace.push_back({page_offset, kKiB / 2});
+    trace.push_back({page_offset + kKiB, 20 * kKiB});
+    const uint32_t resource_offset =
+        kResourcesStart + (page * 7919 * kKiB) % (kResourcesSize - 16 * kKiB);
+    trace.push_back({resource_offset, 16 * kKiB});
+  }
+  return trace;
+}
+
+std::optional<std::vector<Access>> ReadTrace(const base::FilePath& path) {
+  std::string contents;
+  if (!base::ReadFileToString(path, &contents))
+    return std::nullopt;
+
+  std::vector<Access> trace;
+  for (std::string_view line :
+       base::SplitStringPiece(contents, "\n", base::TRIM_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<std::string_view> fields = base::SplitStringPiece(
+        line, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    Access access;
+    if (fields.size() != 2 || !base::StringToUint(fields[0], &access.offset) ||
+        !base::StringToUint(fields[1], &access.size)) {
+      return std::nullopt;
+    }
+    trace.push_back(access);
+  }
+  return trace;
+}
+
+// Runs events in the order of their simulated time, advancing the mock clock
+// as it goes.
+class EventQueue {
+ public:
+  explicit EventQueue(base::ScopedMockClockOverride* clock) : clock_(clock) {}
+
+  void Post(base::TimeDelta delay, base::OnceClosure event) {
+    events_.emplace(std::make_pair(base::TimeTicks::Now() + delay, next_id_++),
+                    std::move(event));
+  }
+
+  // Runs the next event. Returns false if there is none.
+  bool RunNext() {
+    if (events_.empty())
+      return false;
+
+    auto it = events_.begin();
+    clock_->Advance(it->first.first - base::TimeTicks::Now());
+    base::OnceClosure event = std::move(it->second);
+    events_.erase(it);
+    std::move(event).Run();
+    return true;
+  }
+
+ private:
+  const raw_ptr<base::ScopedMockClockOverride> clock_;
+
+  // Ordered by time, then by posting order.
+  std::map<std::pair<base::TimeTicks, int>, base::OnceClosure> events_;
+  int next_id_ = 0;
+};
+
+// A server with byte range support at the other end of a `Link`.
+class SimulatedServer {
+ public:
+  class Loader : public URLLoaderWrapper {
+   public:
+    explicit Loader(SimulatedServer* server) : server_(server) {}
+    Loader(const Loader&) = delete;
+    Loader& operator=(const Loader&) = delete;
+    ~Loader() override { Close(); }
+
+    // URLLoaderWrapper:
+    int GetContentLength() const override {
+      return static_cast<int>(server_->document_size_);
+    }
+    bool IsAcceptRangesBytes() const override { return true; }
+    bool IsContentEncoded() const override { return false; }
+    std::string GetContentType() const override { return "application/pdf"; }
+    std::string GetContentDisposition() const override { return ""; }
+    std::string GetETag() const override { return ""; }
+    std::string GetLastModified() const override { return ""; }
+    int GetStatusCode() const override { return ranges_.empty() ? 200 : 206; }
+    bool IsMultipart() const override { return ranges_.size() > 1; }
+    bool GetByteRangeStart(int* start) const override {
+      *start = static_cast<int>(byte_range_start_);
+      return !ranges_.empty();
+    }
+    void Close() override {
+      if (active_) {
+        --server_->active_connections_;
+        active_ = false;
+      }
+    }
+    void OpenRange(const std::string& url,
+                   const std::string& referrer_url,
+                   uint32_t position,
+                   uint32_t size,
+                   base::OnceCallback<void(int)> callback) override {
+      const gfx::Range range(position, position + size);
+      OpenRanges(url, referrer_url, base::span_from_ref(range),
+                 std::move(callback));
+    }
+    void OpenRanges(const std::string& url,
+                    const std::string& referrer_url,
+                    base::span<const gfx::Range> byte_ranges,
+                    base::OnceCallback<void(int)> callback) override {
+      ranges_.assign(byte_ranges.begin(), byte_ranges.end());
+      position_ = ranges_.front().start();
+      byte_range_start_ = position_;
+      ++server_->requests_;
+      server_->events_->Post(
+          server_->link_.round_trip_time,
+          base::BindOnce(&Loader::DidOpen, weak_factory_.GetWeakPtr(),
+                         std::move(callback)));
+    }
+    void ReadResponseBody(base::span<char> buffer,
+                          base::OnceCallback<void(int)> callback) override {
+      uint32_t end = server_->document_size_;
+      if (!ranges_.empty()) {
+        while (part_ + 1 < ranges_.size() &&
+               position_ >= ranges_[part_].end()) {
+          position_ = ranges_[++part_].start();
+        }
+        end = ranges_[part_].end();
+      }
+      const uint32_t length =
+          std::min({end - position_, kMaxReadSize,
+                    static_cast<uint32_t>(buffer.size())});
+      if (IsMultipart())
+        byte_range_start_ = position_;
+      position_ += length;
+      server_->bytes_sent_ += length;
+
+      // The connections share the bandwidth.
+      const double bandwidth =
+          server_->link_.bandwidth / std::max(server_->active_connections_, 1);
+      server_->events_->Post(
+          base::Seconds(length / bandwidth),
+          base::BindOnce(&Loader::DidRead, weak_factory_.GetWeakPtr(),
+                         std::move(callback), static_cast<int>(length)));
+    }
+
+    void Start() {
+      active_ = true;
+      ++server_->active_connections_;
+    }
+
+   private:
+    void DidOpen(base::OnceCallback<void(int)> callback) {
+      Start();
+      std::move(callback).Run(0);
+    }
+
+    void DidRead(base::OnceCallback<void(int)> callback, int length) {
+      if (length == 0)
+        Close();
+      std::move(callback).Run(length);
+    }
+
+    const raw_ptr<SimulatedServer> server_;
+    bool active_ = false;
+    std::vector<gfx::Range> ranges_;
+    size_t part_ = 0;
+    uint32_t position_ = 0;
+    uint32_t byte_range_start_ = 0;
+    base::WeakPtrFactory<Loader> weak_factory_{this};
+  };
+
+  SimulatedServer(uint32_t document_size, const Link& link, EventQueue* events)
+      : document_size_(document_size), link_(link), events_(events) {}
+
+  std::unique_ptr<URLLoaderWrapper> CreateFullPageLoader() {
+    auto loader = std::make_unique<Loader>(this);
+    loader->Start();
+    return loader;
+  }
+
+  int requests() const { return requests_; }
+  uint64_t bytes_sent() const { return bytes_sent_; }
+
+ private:
+  const uint32_t document_size_;
+  const Link link_;
+  const raw_ptr<EventQueue> events_;
+  int active_connections_ = 0;
+  int requests_ = 0;
+  uint64_t bytes_sent_ = 0;
+};
+
+class SimulatedClient : public DocumentLoader::Client {
+ public:
+  explicit SimulatedClient(SimulatedServer* server) : server_(server) {}
+
+  // DocumentLoader::Client:
+  std::unique_ptr<URLLoaderWrapper> CreateURLLoader() override {
+    return std::make_unique<SimulatedServer::Loader>(server_);
+  }
+  void OnPendingRequestComplete() override {}
+  void OnNewDataReceived() override {}
+  void OnDocumentComplete() override {}
+  void OnDocumentCanceled() override {}
+
+ private:
+  const raw_ptr<SimulatedServer> server_;
+};
+
+void ReplayTrace(const std::string& story,
+                 const std::vector<Access>& trace,
+                 const Link& link) {
+  uint32_t document_size = 0;
+  for (const Access& access : trace)
+    document_size = std::max(document_size, access.offset + access.size);
+  ASSERT_GT(document_size, 0u);
+
+  base::ScopedMockClockOverride clock;
+  EventQueue events(&clock);
+  SimulatedServer server(document_size, link, &events);
+  SimulatedClient client(&server);
+  DocumentLoaderImpl loader(&client);
+  ASSERT_TRUE(
+      loader.Init(server.CreateFullPageLoader(), "https://example.com/a.pdf"));
+
+  // The time PDFium spent waiting for data.
+  base::TimeDelta wait_time;
+  for (const Access& access : trace) {
+    if (loader.IsDataAvailable(access.offset, access.size))
+      continue;
+
+    const base::TimeTicks wait_start = base::TimeTicks::Now();
+    loader.RequestData(access.offset, access.size);
+    while (!loader.IsDataAvailable(access.offset, access.size))
+      ASSERT_TRUE(events.RunNext());
+    wait_time += base::TimeTicks::Now() - wait_start;
+  }
+
+  perf_test::PerfResultReporter reporter("DocumentLoader", story);
+  reporter.RegisterImportantMetric(".wait_time", "ms");
+  reporter.RegisterImportantMetric(".requests", "count");
+  reporter.RegisterImportantMetric(".bytes_fetched", "bytes");
+  reporter.AddResult(".wait_time", wait_time.InMillisecondsF());
+  reporter.AddResult(".requests", static_cast<size_t>(server.requests()));
+  reporter.AddResult(".bytes_fetched",
+                     static_cast<size_t>(server.bytes_sent()));
+}
+
+std::vector<Access> GetTrace() {
+  const base::FilePath path =
+      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+          kAccessTraceSwitch);
+  if (path.empty())
+    return GetBuiltInTrace();
+
+  std::optional<std::vector<Access>> trace = ReadTrace(path);
+  CHECK(trace) << "Cannot read access trace " << path;
+  return std::move(trace).value();
+}
+
+}  // namespace
+
+TEST(DocumentLoaderPerfTest, FixedRequestSize) {
+  base::test::ScopedFeatureList feature_list(features::kPdfPartialLoading);
+  const std::vector<Access> trace = GetTrace();
+  for (const Link& link : kLinks)
+    ReplayTrace(std::string(link.name) + "_fixed", trace, link);
+}
+
+TEST(DocumentLoaderPerfTest, AdaptiveRequestSize) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitWithFeatures(
+      {features::kPdfAdaptiveRequestSize, features::kPdfPartialLoading}, {});
+  const std::vector<Access> trace = GetTrace();
+  for (const Link& link : kLinks)
+    ReplayTrace(std::string(link.name) + "_adaptive", trace, link);
+}
+
+}  // namespace chrome_pdf
@@ -0,0 +1,172 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/multipart_byte_ranges_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "base/check_op.h"
+#include "base/containers/span.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "net/http/http_util.h"
+#include "pdf/loader/result_codes.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// Parses a "Content-Range" header value like "bytes 200-299/1000".
+bool ParseContentRange(std::string_view value,
+                       uint32_t& first_byte,
+                       uint32_t& last_byte) {
+  value = base::TrimWhitespaceASCII(value, base::TRIM_ALL);
+  constexpr std::string_view kUnit = "bytes";
+  if (!base::StartsWith(value, kUnit, base::CompareCase::INSENSITIVE_ASCII))
+    return false;
+  value = base::TrimWhitespaceASCII(value.substr(kUnit.size()),
+                                    base::TRIM_LEADING);
+
+  const size_t dash = value.find('-');
+  const size_t slash = value.find('/');
+  if (dash == std::string_view::npos || slash == std::string_view::npos ||
+      slash < dash) {
+    return false;
+  }
+  unsigned first = 0;
+  unsigned last = 0;
+  if (!base::StringToUint(value.substr(0, dash), &first) ||
+      !base::StringToUint(value.substr(dash + 1, slash - dash - 1), &last) ||
+      last < first || last == std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  first_byte = first;
+  last_byte = last;
+  return true;
+}
+
+}  // namespace
+
+MultipartByteRangesParser::MultipartByteRangesParser(
+    const std::string& boundary)
+    : delimiter_("--" + boundary) {
+  DCHECK(!boundary.empty());
+}
+
+MultipartByteRangesParser::~MultipartByteRangesParser() = default;
+
+void MultipartByteRangesParser::Append(base::span<const char> data) {
+  // Nothing after the closing boundary matters.
+  if (state_ == State::kDone || state_ == State::kError)
+    return;
+
+  data_.append(data.data(), data.size());
+}
+
+int MultipartByteRangesParser::Read(base::span<char> buffer,
+                                    uint32_t& position) {
+  DCHECK(!buffer.empty());
+  if (state_ == State::kHeaders)
+    ParseHeaders();
+  if (state_ == State::kError)
+    return Result::kErrorFailed;
+  if (state_ != State::kBody)
+    return 0;
+
+  const size_t length = std::min(
+      {buffer.size(), static_cast<size_t>(part_remaining_),
+       data_.size() - data_offset_});
+  if (length == 0)
+    return 0;
+
+  std::copy_n(data_.begin() + data_offset_, length, buffer.begin());
+  data_offset_ += length;
+  position = part_position_;
+  part_position_ += length;
+  part_remaining_ -= length;
+  if (part_remaining_ == 0)
+    state_ = State::kHeaders;
+  Compact();
+  return static_cast<int>(length);
+}
+
+void MultipartByteRangesParser::ParseHeaders() {
+  DCHECK_EQ(state_, State::kHeaders);
+
+  // Parts are separated by a line break before the boundary.
+  std::string_view data(data_);
+  data.remove_prefix(data_offset_);
+  const size_t delimiter_start = data.find_first_not_of("\r\n");
+  if (delimiter_start == std::string_view::npos)
+    return;
+  data.remove_prefix(delimiter_start);
+
+  // Two more characters tell apart the closing boundary.
+  if (data.size() < delimiter_.size() + 2) {
+    if (!delimiter_.starts_with(data.substr(0, delimiter_.size())))
+      state_ = State::kError;
+    return;
+  }
+  if (!data.starts_with(delimiter_)) {
+    state_ = State::kError;
+    return;
+  }
+  data.remove_prefix(delimiter_.size());
+  if (data.starts_with("--")) {
+    state_ = State::kDone;
+    data_.clear();
+    data_offset_ = 0;
+    return;
+  }
+
+  // Wait for the empty line that ends the headers.
+  size_t headers_end = data.find("\r\n\r\n");
+  size_t separator_size = 4;
+  const size_t lf_headers_end = data.find("\n\n");
+  if (lf_headers_end < headers_end) {
+    headers_end = lf_headers_end;
+    separator_size = 2;
+  }
+  if (headers_end == std::string_view::npos)
+    return;
+
+  const std::string headers(data.substr(0, headers_end));
+  uint32_t first_byte = 0;
+  uint32_t last_byte = 0;
+  bool has_range = false;
+  net::HttpUtil::HeadersIterator it(headers.begin(), headers.end(), "\n");
+  while (it.GetNext()) {
+    if (base::EqualsCaseInsensitiveASCII(it.name_piece(), "content-range")) {
+      has_range = ParseContentRange(it.values_piece(), first_byte, last_byte);
+      break;
+    }
+  }
+  if (!has_range) {
+    state_ = State::kError;
+    return;
+  }
+
+  data_offset_ = data_.size() - data.size() + headers_end + separator_size;
+  part_position_ = first_byte;
+  part_remaining_ = last_byte - first_byte + 1;
+  state_ = State::kBody;
+  Compact();
+}
+
+void MultipartByteRangesParser::Compact() {
+  // Avoid moving the data around on every read.
+  if (data_offset_ < data_.size() / 2)
+    return;
+
+  data_.erase(0, data_offset_);
+  data_offset_ = 0;
+}
+
+}  // namespace chrome_pdf
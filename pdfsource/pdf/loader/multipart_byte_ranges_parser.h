@@ -0,0 +1,72 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_LOADER_MULTIPART_BYTE_RANGES_PARSER_H_
+#define PDF_LOADER_MULTIPART_BYTE_RANGES_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/span.h"
+
+namespace chrome_pdf {
+
+// Splits the body of a "multipart/byteranges" HTTP response, as sent for a
+// request with several byte ranges, back into the byte ranges.
+class MultipartByteRangesParser {
+ public:
+  explicit MultipartByteRangesParser(const std::string& boundary);
+  MultipartByteRangesParser(const MultipartByteRangesParser&) = delete;
+  MultipartByteRangesParser& operator=(const MultipartByteRangesParser&) =
+      delete;
+  ~MultipartByteRangesParser();
+
+  // Appends the next piece of the response body.
+  void Append(base::span<const char> data);
+
+  // Copies as much of the body of the current part into `buffer` as is
+  // available, without crossing into the next part, and sets `position` to the
+  // offset of its first byte in the document. Returns the number of bytes
+  // copied, 0 if more data needs to be appended first, or
+  // `Result::kErrorFailed` if the response is malformed.
+  int Read(base::span<char> buffer, uint32_t& position);
+
+  // Whether the closing boundary has been read.
+  bool is_done() const { return state_ == State::kDone; }
+
+ private:
+  enum class State {
+    // Expecting the boundary and headers of a part.
+    kHeaders,
+    // Reading the body of a part.
+    kBody,
+    // Past the closing boundary.
+    kDone,
+    // The response is malformed.
+    kError,
+  };
+
+  // Parses the boundary and headers of the next part, if they are complete.
+  void ParseHeaders();
+
+  // Drops the consumed data from the front of `data_`.
+  void Compact();
+
+  const std::string delimiter_;
+  State state_ = State::kHeaders;
+
+  // Data that has been appended but not read yet, starting at `data_offset_`.
+  std::string data_;
+  size_t data_offset_ = 0;
+
+  // The document offset and remaining size of the current part's body.
+  uint32_t part_position_ = 0;
+  uint32_t part_remaining_ = 0;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_LOADER_MULTIPART_BYTE_RANGES_PARSER_H_
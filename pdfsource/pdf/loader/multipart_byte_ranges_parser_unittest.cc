@@ -0,0 +1,140 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/multipart_byte_ranges_parser.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "base/containers/span.h"
+#include "pdf/loader/result_codes.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+constexpr char kBoundary[] = "3d6b6a416f9b5";
+
+constexpr std::string_view kResponse =
+    "\r\n--3d6b6a416f9b5\r\n"
+    "Content-Type: application/pdf\r\n"
+    "Content-Range: bytes 100-104/1000\r\n"
+    "\r\n"
+    "abcde"
+    "\r\n--3d6b6a416f9b5\r\n"
+    "Content-Type: application/pdf\r\n"
+    "Content-Range: bytes 500-502/1000\r\n"
+    "\r\n"
+    "xyz"
+    "\r\n--3d6b6a416f9b5--\r\n";
+
+void Append(MultipartByteRangesParser& parser, std::string_view data) {
+  parser.Append(base::span(data));
+}
+
+// Reads the next piece of body, or returns an empty string if there is none.
+std::string Read(MultipartByteRangesParser& parser,
+                 uint32_t& position,
+                 size_t buffer_size = 64) {
+  std::string buffer(buffer_size, '\0');
+  const int result = parser.Read(base::span(buffer), position);
+  EXPECT_GE(result, 0);
+  buffer.resize(std::max(result, 0));
+  return buffer;
+}
+
+}  // namespace
+
+TEST(MultipartByteRangesParserTest, SplitsParts) {
+  MultipartByteRangesParser parser(kBoundary);
+  Append(parser, kResponse);
+
+  uint32_t position = 0;
+  EXPECT_EQ("abcde", Read(parser, position));
+  EXPECT_EQ(100u, position);
+
+  // Never mixes the bodies of two parts.
+  EXPECT_EQ("xyz", Read(parser, position));
+  EXPECT_EQ(500u, position);
+
+  EXPECT_EQ("", Read(parser, position));
+  EXPECT_TRUE(parser.is_done());
+}
+
+TEST(MultipartByteRangesParserTest, SmallBuffer) {
+  MultipartByteRangesParser parser(kBoundary);
+  Append(parser, kResponse);
+
+  uint32_t position = 0;
+  EXPECT_EQ("abc", Read(parser, position, /*buffer_size=*/3));
+  EXPECT_EQ(100u, position);
+  EXPECT_EQ("de", Read(parser, position, /*buffer_size=*/3));
+  EXPECT_EQ(103u, position);
+  EXPECT_EQ("xyz", Read(parser, position, /*buffer_size=*/3));
+  EXPECT_EQ(500u, position);
+}
+
+TEST(MultipartByteRangesParserTest, ByteByByte) {
+  MultipartByteRangesParser parser(kBoundary);
+
+  std::string body;
+  std::string positions;
+  for (char c : kResponse) {
+    Append(parser, std::string_view(&c, 1));
+    uint32_t position = 0;
+    std::string data = Read(parser, position);
+    while (!data.empty()) {
+      body += data;
+      positions += std::to_string(position) + ",";
+      data = Read(parser, position);
+    }
+  }
+  EXPECT_EQ("abcdexyz", body);
+  EXPECT_EQ("100,101,102,103,104,500,501,502,", positions);
+  EXPECT_TRUE(parser.is_done());
+}
+
+TEST(MultipartByteRangesParserTest, BareLineFeeds) {
+  MultipartByteRangesParser parser(kBoundary);
+  Append(parser,
+         "--3d6b6a416f9b5\n"
+         "Content-Range: bytes 0-1/10\n"
+         "\n"
+         "ab\n"
+         "--3d6b6a416f9b5--\n");
+
+  uint32_t position = 1;
+  EXPECT_EQ("ab", Read(parser, position));
+  EXPECT_EQ(0u, position);
+  EXPECT_EQ("", Read(parser, position));
+  EXPECT_TRUE(parser.is_done());
+}
+
+TEST(MultipartByteRangesParserTest, MissingContentRange) {
+  MultipartByteRangesParser parser(kBoundary);
+  Append(parser,
+         "\r\n--3d6b6a416f9b5\r\n"
+         "Content-Type: application/pdf\r\n"
+         "\r\n"
+         "abcde");
+
+  char buffer[8];
+  uint32_t position = 0;
+  EXPECT_EQ(Result::kErrorFailed, parser.Read(buffer, position));
+}
+
+TEST(MultipartByteRangesParserTest, WrongBoundary) {
+  MultipartByteRangesParser parser(kBoundary);
+  Append(parser, "\r\n--other\r\nContent-Range: bytes 0-1/10\r\n\r\nab");
+
+  char buffer[8];
+  uint32_t position = 0;
+  EXPECT_EQ(Result::kErrorFailed, parser.Read(buffer, position));
+}
+
+}  // namespace chrome_pdf
@@ -4,8 +4,13 @@
 
 #include "pdf/loader/range_set.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <algorithm>
+#include <iterator>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 namespace chrome_pdf {
@@ -18,6 +23,38 @@ gfx::Range FixDirection(const gfx::Range& range) {
   return gfx::Range(range.end() + 1, range.start() + 1);
 }
 
+// Returns the index of the first range in `ranges` for which `key` returns
+// more than `value`, or the number of ranges if there is none. Unlike
+// std::upper_bound(), takes no branches that depend on the data: lookups for
+// neighbouring points in a fragmented set land on either side of a boundary
+// about equally often, which keeps mispredicting the branches.
+template <typename Key>
+size_t FindFirstAbove(const RangeSet::RangesContainer& ranges,
+                      uint32_t value,
+                      Key key) {
+  if (ranges.empty())
+    return 0;
+
+  size_t first = 0;
+  size_t count = ranges.size();
+  while (count > 1) {
+    const size_t half = count / 2;
+    first = key(ranges[first + half - 1]) <= value ? first + half : first;
+    count -= half;
+  }
+  return key(ranges[first]) <= value ? first + 1 : first;
+}
+
+// Appends `range` to `ranges`, merging it into the last range if they overlap
+// or touch. `range` must not start before the last range.
+void AppendRange(const gfx::Range& range, RangeSet::RangesContainer& ranges) {
+  if (!ranges.empty() && ranges.back().end() >= range.start()) {
+    ranges.back().set_end(std::max(ranges.back().end(), range.end()));
+    return;
+  }
+  ranges.push_back(range);
+}
+
 }  // namespace
 
 RangeSet::RangeSet() = default;
@@ -46,39 +83,39 @@ bool RangeSet::operator!=(const RangeSet& other) const {
 void RangeSet::Union(const gfx::Range& range) {
   if (range.is_empty())
     return;
-  gfx::Range fixed_range = FixDirection(range);
-  if (IsEmpty()) {
-    ranges_.insert(fixed_range);
-    return;
-  }
-
-  auto start = ranges_.upper_bound(fixed_range);
-  if (start != ranges_.begin())
-    --start;  // start now points to the key equal or lower than offset.
-  if (start->end() < fixed_range.start())
-    ++start;  // start element is entirely before current range, skip it.
+  const gfx::Range fixed_range = FixDirection(range);
 
-  auto end = ranges_.upper_bound(gfx::Range(fixed_range.end()));
-  if (start == end) {  // No ranges to merge.
-    ranges_.insert(fixed_range);
+  // Merge with all of the ranges that overlap or touch `fixed_range`.
+  auto first = std::ranges::lower_bound(ranges_, fixed_range.start(), {},
+                                        &gfx::Range::end);
+  auto last = std::ranges::upper_bound(first, ranges_.end(),
+                                       fixed_range.end(), {},
+                                       &gfx::Range::start);
+  if (first == last) {  // No ranges to merge.
+    ranges_.insert(first, fixed_range);
     return;
   }
 
-  --end;
-
-  int new_start = std::min<size_t>(start->start(), fixed_range.start());
-  int new_end = std::max(end->end(), fixed_range.end());
-
-  ranges_.erase(start, ++end);
-  ranges_.insert(gfx::Range(new_start, new_end));
+  *first = gfx::Range(std::min(first->start(), fixed_range.start()),
+                      std::max(std::prev(last)->end(), fixed_range.end()));
+  ranges_.erase(std::next(first), last);
 }
 
 void RangeSet::Union(const RangeSet& range_set) {
-  if (&range_set == this)
+  if (&range_set == this || range_set.IsEmpty())
     return;
-  for (const auto& it : range_set.ranges()) {
-    Union(it);
+
+  RangesContainer new_ranges;
+  new_ranges.reserve(ranges_.size() + range_set.ranges_.size());
+  auto it = ranges_.begin();
+  auto other_it = range_set.ranges_.begin();
+  while (it != ranges_.end() || other_it != range_set.ranges_.end()) {
+    const bool take_other =
+        it == ranges_.end() || (other_it != range_set.ranges_.end() &&
+                                other_it->start() < it->start());
+    AppendRange(take_other ? *other_it++ : *it++, new_ranges);
   }
+  ranges_.swap(new_ranges);
 }
 
 bool RangeSet::Contains(uint32_t point) const {
@@ -89,17 +126,24 @@ bool RangeSet::Contains(const gfx::Range& range) const {
   if (range.is_empty())
     return false;
   const gfx::Range fixed_range = FixDirection(range);
-  auto it = ranges().upper_bound(fixed_range);
-  if (it == ranges().begin())
+  const size_t index =
+      FindFirstAbove(ranges_, fixed_range.start(),
+                     [](const gfx::Range& range) { return range.start(); });
+  if (index == 0)
     return false;  // No ranges includes range.start().
 
-  --it;  // Now it starts equal or before range.start().
-  return it->end() >= fixed_range.end();
+  // The range before starts equal or before range.start().
+  return ranges_[index - 1].end() >= fixed_range.end();
 }
 
 bool RangeSet::Contains(const RangeSet& range_set) const {
-  for (const auto& it : range_set.ranges()) {
-    if (!Contains(it))
+  auto it = ranges_.begin();
+  for (const auto& range : range_set.ranges()) {
+    // Skip the ranges that end before `range` does; the next one is the only
+    // one that can contain it.
+    while (it != ranges_.end() && it->end() < range.end())
+      ++it;
+    if (it == ranges_.end() || it->start() > range.start())
       return false;
   }
   return true;
@@ -109,26 +153,21 @@ bool RangeSet::Intersects(const gfx::Range& range) const {
   if (IsEmpty() || range.is_empty())
     return false;
   const gfx::Range fixed_range = FixDirection(range);
-  auto start = ranges_.upper_bound(fixed_range);
-  if (start != ranges_.begin()) {
-    --start;
-  }
-  // start now points to the key equal or lower than range.start().
-  if (start->end() < range.start()) {
-    // start element is entirely before current range, skip it.
-    ++start;
-  }
-  auto end = ranges_.upper_bound(gfx::Range(fixed_range.end()));
-  for (auto it = start; it != end; ++it) {
-    if (fixed_range.end() > it->start() && fixed_range.start() < it->end())
-      return true;
-  }
-  return false;
+  const size_t index =
+      FindFirstAbove(ranges_, fixed_range.start(),
+                     [](const gfx::Range& range) { return range.end(); });
+  return index < ranges_.size() && ranges_[index].start() < fixed_range.end();
 }
 
 bool RangeSet::Intersects(const RangeSet& range_set) const {
-  for (const auto& it : range_set.ranges()) {
-    if (Intersects(it))
+  auto it = ranges_.begin();
+  auto other_it = range_set.ranges_.begin();
+  while (it != ranges_.end() && other_it != range_set.ranges_.end()) {
+    if (it->end() <= other_it->start())
+      ++it;
+    else if (other_it->end() <= it->start())
+      ++other_it;
+    else
       return true;
   }
   return false;
@@ -139,60 +178,51 @@ void RangeSet::Intersect(const gfx::Range& range) {
 }
 
 void RangeSet::Intersect(const RangeSet& range_set) {
-  if (IsEmpty())
+  if (IsEmpty() || &range_set == this)
     return;
+
   RangesContainer new_ranges;
-  for (const auto& range : range_set.ranges()) {
-    auto start = ranges_.upper_bound(range);
-    if (start != ranges_.begin())
-      --start;  // start now points to the key equal or lower than
-                // range.start().
-    if (start->end() < range.start())
-      ++start;  // start element is entirely before current range, skip it.
-    auto end = ranges_.upper_bound(gfx::Range(range.end()));
-    if (start == end) {  // No data in the current range available.
-      continue;
-    }
-    for (auto it = start; it != end; ++it) {
-      const gfx::Range new_range = range.Intersect(*it);
-      if (!new_range.is_empty()) {
-        new_ranges.insert(new_range);
-      }
-    }
+  auto it = ranges_.begin();
+  auto other_it = range_set.ranges_.begin();
+  while (it != ranges_.end() && other_it != range_set.ranges_.end()) {
+    const gfx::Range new_range = it->Intersect(*other_it);
+    if (!new_range.is_empty())
+      new_ranges.push_back(new_range);
+
+    // Move past whichever range ends first; the other one may still overlap
+    // the next range of the other set.
+    if (it->end() < other_it->end())
+      ++it;
+    else
+      ++other_it;
   }
-  new_ranges.swap(ranges_);
+  ranges_.swap(new_ranges);
 }
 
 void RangeSet::Subtract(const gfx::Range& range) {
   if (range.is_empty() || IsEmpty())
     return;
   const gfx::Range fixed_range = FixDirection(range);
-  auto start = ranges_.upper_bound(fixed_range);
-  if (start != ranges_.begin())
-    --start;  // start now points to the key equal or lower than
-              // range.start().
-  if (start->end() < fixed_range.start())
-    ++start;  // start element is entirely before current range, skip it.
-  auto end = ranges_.upper_bound(gfx::Range(fixed_range.end()));
-  if (start == end) {  // No data in the current range available.
+  auto first = std::ranges::upper_bound(ranges_, fixed_range.start(), {},
+                                        &gfx::Range::end);
+  auto last = std::ranges::lower_bound(first, ranges_.end(),
+                                       fixed_range.end(), {},
+                                       &gfx::Range::start);
+  if (first == last) {  // No data in the current range available.
     return;
   }
-  std::vector<gfx::Range> new_ranges;
-  for (auto it = start; it != end; ++it) {
-    const gfx::Range left(it->start(),
-                          std::min(it->end(), fixed_range.start()));
-    const gfx::Range right(std::max(it->start(), fixed_range.end()), it->end());
-    if (!left.is_empty() && !left.is_reversed()) {
-      new_ranges.push_back(left);
-    }
-    if (!right.is_empty() && !right.is_reversed() && right != left) {
-      new_ranges.push_back(right);
-    }
-  }
-  ranges_.erase(start, end);
-  for (const auto& it : new_ranges) {
-    ranges_.insert(it);
-  }
+
+  // Only the first and the last of the overlapping ranges can stick out of
+  // `fixed_range`.
+  const gfx::Range left(first->start(),
+                        std::max(first->start(), fixed_range.start()));
+  const gfx::Range right(std::min(std::prev(last)->end(), fixed_range.end()),
+                         std::prev(last)->end());
+  auto it = ranges_.erase(first, last);
+  if (!right.is_empty())
+    it = ranges_.insert(it, right);
+  if (!left.is_empty())
+    ranges_.insert(it, left);
 }
 
 void RangeSet::Subtract(const RangeSet& range_set) {
@@ -200,9 +230,30 @@ void RangeSet::Subtract(const RangeSet& range_set) {
     ranges_.clear();
     return;
   }
-  for (const auto& range : range_set.ranges()) {
-    Subtract(range);
+  if (IsEmpty() || range_set.IsEmpty())
+    return;
+
+  RangesContainer new_ranges;
+  auto other_it = range_set.ranges_.begin();
+  for (const auto& range : ranges_) {
+    uint32_t start = range.start();
+    while (other_it != range_set.ranges_.end() && other_it->end() <= start)
+      ++other_it;
+    for (; other_it != range_set.ranges_.end() &&
+           other_it->start() < range.end();
+         ++other_it) {
+      if (other_it->start() > start)
+        new_ranges.emplace_back(start, other_it->start());
+      start = other_it->end();
+      if (start >= range.end()) {
+        // `other_it` may overlap the next range too.
+        break;
+      }
+    }
+    if (start < range.end())
+      new_ranges.emplace_back(start, range.end());
   }
+  ranges_.swap(new_ranges);
 }
 
 void RangeSet::Xor(const gfx::Range& range) {
@@ -225,11 +276,11 @@ void RangeSet::Clear() {
 }
 
 gfx::Range RangeSet::First() const {
-  return *ranges().begin();
+  return ranges_.front();
 }
 
 gfx::Range RangeSet::Last() const {
-  return *ranges().rbegin();
+  return ranges_.back();
 }
 
 std::string RangeSet::ToString() const {
@@ -3,13 +3,20 @@
 // found in the LICENSE file.
 
 // Defines a set of geometric ranges, and standard operations on it.
+//
+// The ranges are kept in a sorted vector, merged so that no two of them
+// overlap or touch. Lookups are binary searches, and the operations taking
+// another RangeSet walk both sets once, so heavily fragmented sets stay cheap.
 
 #ifndef PDF_LOADER_RANGE_SET_H_
 #define PDF_LOADER_RANGE_SET_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <ostream>
-#include <set>
 #include <string>
+#include <vector>
 
 #include "ui/gfx/range/range.h"
 
@@ -54,13 +61,7 @@ class RangeSet {
   gfx::Range Last() const;
   std::string ToString() const;
 
-  struct range_compare {
-    bool operator()(const gfx::Range& lval, const gfx::Range& rval) const {
-      return lval.start() < rval.start();
-    }
-  };
-
-  using RangesContainer = std::set<gfx::Range, range_compare>;
+  using RangesContainer = std::vector<gfx::Range>;
 
   const RangesContainer& ranges() const { return ranges_; }
   size_t Size() const { return ranges_.size(); }
@@ -0,0 +1,206 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "pdf/loader/range_set.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "ui/gfx/range/range.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// The chunks of a 512 MB document.
+constexpr uint32_t kChunkCount = 16 * 1024;
+
+// A prime, so that stepping by it visits every chunk in a scattered order.
+constexpr uint32_t kScatterStep = 7919;
+
+constexpr int kWarmupRuns = 5;
+constexpr base::TimeDelta kTimeLimit = base::Seconds(2);
+constexpr int kTimeCheckInterval = 5;
+
+// The node based set of ranges that RangeSet replaced, for comparison. Only
+// has the operations the loader uses most.
+class LegacyRangeSet {
+ public:
+  void Union(const gfx::Range& range) {
+    if (ranges_.empty()) {
+      ranges_.insert(range);
+      return;
+    }
+
+    auto start = ranges_.upper_bound(range);
+    if (start != ranges_.begin())
+      --start;
+    if (start->end() < range.start())
+      ++start;
+
+    auto end = ranges_.upper_bound(gfx::Range(range.end()));
+    if (start == end) {
+      ranges_.insert(range);
+      return;
+    }
+
+    --end;
+    const gfx::Range new_range(std::min(start->start(), range.start()),
+                               std::max(end->end(), range.end()));
+    ranges_.erase(start, ++end);
+    ranges_.insert(new_range);
+  }
+
+  bool Intersects(const gfx::Range& range) const {
+    if (ranges_.empty())
+      return false;
+
+    auto start = ranges_.upper_bound(range);
+    if (start != ranges_.begin())
+      --start;
+    if (start->end() < range.start())
+      ++start;
+    auto end = ranges_.upper_bound(gfx::Range(range.end()));
+    for (auto it = start; it != end; ++it) {
+      if (range.end() > it->start() && range.start() < it->end())
+        return true;
+    }
+    return false;
+  }
+
+  void Subtract(const gfx::Range& range) {
+    if (ranges_.empty())
+      return;
+
+    auto start = ranges_.upper_bound(range);
+    if (start != ranges_.begin())
+      --start;
+    if (start->end() < range.start())
+      ++start;
+    auto end = ranges_.upper_bound(gfx::Range(range.end()));
+    if (start == end)
+      return;
+
+    std::vector<gfx::Range> new_ranges;
+    for (auto it = start; it != end; ++it) {
+      const gfx::Range left(it->start(), std::min(it->end(), range.start()));
+      const gfx::Range right(std::max(it->start(), range.end()), it->end());
+      if (!left.is_empty() && !left.is_reversed())
+        new_ranges.push_back(left);
+      if (!right.is_empty() && !right.is_reversed() && right != left)
+        new_ranges.push_back(right);
+    }
+    ranges_.erase(start, end);
+    ranges_.insert(new_ranges.begin(), new_ranges.end());
+  }
+
+  void Subtract(const LegacyRangeSet& range_set) {
+    for (const gfx::Range& range : range_set.ranges_)
+      Subtract(range);
+  }
+
+  size_t Size() const { return ranges_.size(); }
+
+ private:
+  struct RangeCompare {
+    bool operator()(const gfx::Range& lval, const gfx::Range& rval) const {
+      return lval.start() < rval.start();
+    }
+  };
+
+  std::set<gfx::Range, RangeCompare> ranges_;
+};
+
+// Returns the set of every other chunk, like a document that got loaded by
+// scattered reads.
+template <typename Set>
+Set GetAlternateChunks() {
+  Set chunks;
+  for (uint32_t i = 0; i < kChunkCount; i += 2)
+    chunks.Union(gfx::Range(i, i + 1));
+  return chunks;
+}
+
+template <typename Operation>
+void RunRangeSetTest(const std::string& story,
+                     const std::string& metric,
+                     Operation operation) {
+  base::LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    operation();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  perf_test::PerfResultReporter reporter("RangeSet", story);
+  reporter.RegisterImportantMetric(metric, "us");
+  reporter.AddResult(metric, timer.TimePerLap());
+}
+
+// Fills the chunks of a document in a scattered order, like the filled chunks
+// of a `ChunkStream` while PDFium jumps around the document.
+template <typename Set>
+void RunScatteredUnionTest(const std::string& story) {
+  RunRangeSetTest(story, ".time_per_fill", [] {
+    Set chunks;
+    for (uint32_t i = 0; i < kChunkCount; ++i) {
+      const uint32_t chunk = (i * kScatterStep) % kChunkCount;
+      chunks.Union(gfx::Range(chunk, chunk + 1));
+    }
+    EXPECT_EQ(1u, chunks.Size());
+  });
+}
+
+// Finds the chunks of the document that are still missing, like
+// `DocumentLoaderImpl` does before each request.
+template <typename Set>
+void RunSubtractTest(const std::string& story) {
+  const Set filled_chunks = GetAlternateChunks<Set>();
+  RunRangeSetTest(story, ".time_per_subtract", [&filled_chunks] {
+    Set missing_chunks;
+    missing_chunks.Union(gfx::Range(0, kChunkCount));
+    missing_chunks.Subtract(filled_chunks);
+    EXPECT_EQ(kChunkCount / 2, missing_chunks.Size());
+  });
+}
+
+// Checks every chunk of the document against a fragmented set.
+template <typename Set>
+void RunIntersectsTest(const std::string& story) {
+  const Set chunks = GetAlternateChunks<Set>();
+  RunRangeSetTest(story, ".time_per_lookup_pass", [&chunks] {
+    size_t intersections = 0;
+    for (uint32_t i = 0; i < kChunkCount; ++i) {
+      if (chunks.Intersects(gfx::Range(i, i + 1)))
+        ++intersections;
+    }
+    EXPECT_EQ(kChunkCount / 2, intersections);
+  });
+}
+
+}  // namespace
+
+TEST(RangeSetPerfTest, ScatteredUnion) {
+  RunScatteredUnionTest<LegacyRangeSet>("scattered_union_legacy");
+  RunScatteredUnionTest<RangeSet>("scattered_union");
+}
+
+TEST(RangeSetPerfTest, SubtractFragmented) {
+  RunSubtractTest<LegacyRangeSet>("subtract_fragmented_legacy");
+  RunSubtractTest<RangeSet>("subtract_fragmented");
+}
+
+TEST(RangeSetPerfTest, IntersectsFragmented) {
+  RunIntersectsTest<LegacyRangeSet>("intersects_fragmented_legacy");
+  RunIntersectsTest<RangeSet>("intersects_fragmented");
+}
+
+}  // namespace chrome_pdf
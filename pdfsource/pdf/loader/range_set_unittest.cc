@@ -4,10 +4,43 @@
 
 #include "pdf/loader/range_set.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace chrome_pdf {
 
+namespace {
+
+constexpr uint32_t kFragmentedSize = 200;
+
+// Returns a set of ranges of `length` that repeat every `period`, starting at
+// `offset`.
+RangeSet CreateFragmentedSet(uint32_t offset,
+                             uint32_t length,
+                             uint32_t period) {
+  RangeSet range_set;
+  for (uint32_t start = offset; start < kFragmentedSize; start += period)
+    range_set.Union(gfx::Range(start, start + length));
+  return range_set;
+}
+
+// Returns the set of the points `contains` holds for.
+template <typename Predicate>
+RangeSet CreateSetOfPoints(Predicate contains) {
+  RangeSet range_set;
+  for (uint32_t point = 0; point < 2 * kFragmentedSize; ++point) {
+    if (contains(point))
+      range_set.Union(gfx::Range(point, point + 1));
+  }
+  return range_set;
+}
+
+}  // namespace
+
 TEST(RangeSetTest, Union) {
   {
     RangeSet range_set;
@@ -300,4 +333,53 @@ TEST(RangeSetTest, OperationsOnEmptySet) {
   range_set.Union(gfx::Range(10, 20));
 }
 
+TEST(RangeSetTest, FragmentedSets) {
+  // Overlapping, touching and disjoint ranges, with periods that drift apart.
+  const std::vector<RangeSet> range_sets = {
+      CreateFragmentedSet(0, 3, 7),
+      CreateFragmentedSet(2, 4, 6),
+      CreateFragmentedSet(5, 1, 2),
+      CreateFragmentedSet(1, 5, 5),
+      CreateFragmentedSet(50, 20, 60),
+      RangeSet(),
+  };
+
+  for (const RangeSet& a : range_sets) {
+    for (const RangeSet& b : range_sets) {
+      SCOPED_TRACE(a.ToString() + " " + b.ToString());
+
+      RangeSet result = a;
+      result.Union(b);
+      EXPECT_EQ(CreateSetOfPoints([&](uint32_t point) {
+                  return a.Contains(point) || b.Contains(point);
+                }),
+                result);
+
+      result = a;
+      result.Intersect(b);
+      EXPECT_EQ(CreateSetOfPoints([&](uint32_t point) {
+                  return a.Contains(point) && b.Contains(point);
+                }),
+                result);
+      EXPECT_EQ(!result.IsEmpty(), a.Intersects(b));
+
+      result = a;
+      result.Subtract(b);
+      EXPECT_EQ(CreateSetOfPoints([&](uint32_t point) {
+                  return a.Contains(point) && !b.Contains(point);
+                }),
+                result);
+      EXPECT_EQ(result.IsEmpty(), b.Contains(a));
+
+      // The single range operations agree with the set operations.
+      result = a;
+      for (const gfx::Range& range : b.ranges())
+        result.Subtract(range);
+      RangeSet expected = a;
+      expected.Subtract(b);
+      EXPECT_EQ(expected, result);
+    }
+  }
+}
+
 }  // namespace chrome_pdf
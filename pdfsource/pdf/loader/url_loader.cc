@@ -10,8 +10,11 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "base/containers/span.h"
 #include "base/functional/bind.h"
 #include "base/functional/callback.h"
 #include "base/memory/raw_ref.h"
@@ -217,15 +220,41 @@ void UrlLoader::DidReceiveData(const char* data, int data_length) {
     return;
 
   // TODO(crbug.com/40284755): spanify to fix the errors.
-  buffer_.insert(buffer_.end(), data, UNSAFE_BUFFERS(data + data_length));
+  auto received =
+      UNSAFE_BUFFERS(base::span(data, static_cast<size_t>(data_length)));
+
+  // A pending read gets the data straight from the network block, so that
+  // only the part that does not fit needs to be buffered.
+  size_t read_bytes = 0;
+  if (read_callback_ && buffer_.empty()) {
+    DCHECK(!client_buffer_.empty());
+    base::span<char> client_buffer = client_buffer_;
+    read_bytes = std::min(received.size(), client_buffer.size());
+    client_buffer.first(read_bytes).copy_from(received.first(read_bytes));
+    received = received.subspan(read_bytes);
+  }
+
+  if (!received.empty()) {
+    buffer_.emplace_back(received.begin(), received.end());
+    buffer_size_ += received.size();
+  }
 
-  // Defer loading if the buffer is too full.
-  if (!deferring_loading_ && buffer_.size() >= buffer_upper_threshold_) {
+  // Defer loading if the buffer is too full. Data that went straight to a read
+  // counts as if it passed through the buffer.
+  if (!deferring_loading_ &&
+      buffer_size_ + read_bytes >= buffer_upper_threshold_) {
     deferring_loading_ = true;
     blink_loader_->SetDefersLoading(true);
   }
 
-  RunReadCallback();
+  if (read_bytes == 0) {
+    RunReadCallback();
+    return;
+  }
+
+  MaybeResumeLoading();
+  client_buffer_ = {};
+  std::move(read_callback_).Run(static_cast<int>(read_bytes));
 }
 
 // Modeled on `content::PepperURLLoaderHost::DidFinishLoading()`.
@@ -263,6 +292,8 @@ void UrlLoader::AbortLoad(int32_t result) {
 
   SetLoadComplete(result);
   buffer_.clear();
+  buffer_offset_ = 0;
+  buffer_size_ = 0;
 
   if (open_callback_) {
     DCHECK(!read_callback_);
@@ -278,19 +309,12 @@ void UrlLoader::RunReadCallback() {
     return;
 
   DCHECK(!client_buffer_.empty());
+  base::span<char> client_buffer = client_buffer_;
   int32_t num_bytes = std::min(
-      {buffer_.size(), client_buffer_.size(), static_cast<size_t>(INT32_MAX)});
+      {buffer_size_, client_buffer.size(), static_cast<size_t>(INT32_MAX)});
   if (num_bytes > 0) {
-    auto read_begin = buffer_.begin();
-    auto read_end = read_begin + num_bytes;
-    std::copy(read_begin, read_end, client_buffer_.data());
-    buffer_.erase(read_begin, read_end);
-
-    // Resume loading if the buffer is too empty.
-    if (deferring_loading_ && buffer_.size() <= buffer_lower_threshold_) {
-      deferring_loading_ = false;
-      blink_loader_->SetDefersLoading(false);
-    }
+    ReadFromBuffer(client_buffer.first(static_cast<size_t>(num_bytes)));
+    MaybeResumeLoading();
   } else {
     DCHECK_EQ(state_, LoadingState::kLoadComplete);
     num_bytes = complete_result_;
@@ -303,6 +327,31 @@ void UrlLoader::RunReadCallback() {
   std::move(read_callback_).Run(num_bytes);
 }
 
+void UrlLoader::ReadFromBuffer(base::span<char> destination) {
+  DCHECK_LE(destination.size(), buffer_size_);
+  buffer_size_ -= destination.size();
+  while (!destination.empty()) {
+    base::span<const char> block =
+        base::span(buffer_.front()).subspan(buffer_offset_);
+    const size_t length = std::min(block.size(), destination.size());
+    destination.first(length).copy_from(block.first(length));
+    destination = destination.subspan(length);
+
+    buffer_offset_ += length;
+    if (buffer_offset_ == buffer_.front().size()) {
+      buffer_.pop_front();
+      buffer_offset_ = 0;
+    }
+  }
+}
+
+void UrlLoader::MaybeResumeLoading() {
+  if (deferring_loading_ && buffer_size_ <= buffer_lower_threshold_) {
+    deferring_loading_ = false;
+    blink_loader_->SetDefersLoading(false);
+  }
+}
+
 void UrlLoader::SetLoadComplete(int32_t result) {
   DCHECK_NE(state_, LoadingState::kLoadComplete);
   DCHECK_LE(result, 0);
@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/containers/circular_deque.h"
 #include "base/containers/span.h"
@@ -171,6 +172,13 @@ class UrlLoader final : public blink::WebAssociatedURLLoaderClient {
   // Runs callback for `ReadResponseBody()` if pending.
   void RunReadCallback();
 
+  // Moves the oldest buffered data into `destination`, which must not be
+  // larger than `buffer_size_`.
+  void ReadFromBuffer(base::span<char> destination);
+
+  // Resumes loading if the buffer drained below the lower threshold.
+  void MaybeResumeLoading();
+
   void SetLoadComplete(int32_t result);
 
   base::WeakPtr<Client> client_;
@@ -189,7 +197,14 @@ class UrlLoader final : public blink::WebAssociatedURLLoaderClient {
   size_t buffer_lower_threshold_ = 0;
   size_t buffer_upper_threshold_ = 0;
   bool deferring_loading_ = false;
-  base::circular_deque<char> buffer_;
+
+  // Received data that was not read yet, in the blocks it arrived in. Only the
+  // front block can be partially read, up to `buffer_offset_`.
+  base::circular_deque<std::vector<char>> buffer_;
+  size_t buffer_offset_ = 0;
+
+  // The number of unread bytes in `buffer_`.
+  size_t buffer_size_ = 0;
 
   base::OnceCallback<void(int)> read_callback_;
   base::raw_span<char> client_buffer_;
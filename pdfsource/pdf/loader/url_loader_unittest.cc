@@ -329,6 +329,27 @@ TEST_F(UrlLoaderTest, DidReceiveData) {
   EXPECT_THAT(buffer, ElementsAreArray(kFakeData));
 }
 
+TEST_F(UrlLoaderTest, DidReceiveDataWithSmallerBuffer) {
+  static constexpr size_t kBufferSize = 2;
+
+  char buffer[kBufferSize] = {};
+  loader_->Open(UrlRequest(), mock_callback_.Get());
+  loader_->DidReceiveResponse(blink::WebURLResponse());
+  loader_->ReadResponseBody(buffer, mock_callback_.Get());
+  EXPECT_CALL(mock_callback_, Run(kBufferSize));
+
+  loader_->DidReceiveData(kFakeData.data(), kFakeData.size());
+
+  EXPECT_THAT(buffer, ElementsAreArray(kFakeData.first(kBufferSize)));
+
+  // Verify the rest of the data got buffered.
+  char tail_buffer[kFakeData.size()] = {};
+  EXPECT_CALL(mock_callback_, Run(kFakeData.size() - kBufferSize));
+  loader_->ReadResponseBody(tail_buffer, mock_callback_.Get());
+  EXPECT_THAT(base::span(tail_buffer).first(kFakeData.size() - kBufferSize),
+              ElementsAreArray(kFakeData.subspan(kBufferSize)));
+}
+
 TEST_F(UrlLoaderTest, DidReceiveDataWithZeroLength) {
   char buffer[kFakeData.size()] = {};
   loader_->Open(UrlRequest(), mock_callback_.Get());
@@ -448,6 +469,24 @@ TEST_F(UrlLoaderTest, ReadResponseBodyWithBiggerBuffer) {
   loader_->ReadResponseBody(buffer, mock_callback_.Get());
 }
 
+TEST_F(UrlLoaderTest, ReadResponseBodyAcrossBlocks) {
+  loader_->Open(UrlRequest(), mock_callback_.Get());
+  loader_->DidReceiveResponse(blink::WebURLResponse());
+  for (char data : kFakeData)
+    loader_->DidReceiveData(&data, 1);
+  EXPECT_CALL(mock_callback_, Run(kFakeData.size() - 1));
+
+  // Stop in the middle of the data, and verify the rest follows in order.
+  char buffer[kFakeData.size() - 1] = {};
+  loader_->ReadResponseBody(buffer, mock_callback_.Get());
+  EXPECT_THAT(buffer, ElementsAreArray(kFakeData.first(kFakeData.size() - 1)));
+
+  char tail_buffer[kFakeData.size()] = {};
+  EXPECT_CALL(mock_callback_, Run(1));
+  loader_->ReadResponseBody(tail_buffer, mock_callback_.Get());
+  EXPECT_EQ(kFakeData.back(), tail_buffer[0]);
+}
+
 TEST_F(UrlLoaderTest, ReadResponseBodyWhileLoadComplete) {
   loader_->Open(UrlRequest(), mock_callback_.Get());
   loader_->DidReceiveResponse(blink::WebURLResponse());
@@ -11,6 +11,7 @@
 
 #include "base/containers/span.h"
 #include "base/functional/callback_forward.h"
+#include "ui/gfx/range/range.h"
 
 namespace chrome_pdf {
 
@@ -33,6 +34,12 @@ class URLLoaderWrapper {
   // Returns response content disposition.
   virtual std::string GetContentDisposition() const = 0;
 
+  // Returns the response's entity tag and last modification date, which tell
+  // whether the document changed since an earlier response. Empty if the
+  // response lacks them.
+  virtual std::string GetETag() const = 0;
+  virtual std::string GetLastModified() const = 0;
+
   // Returns response status code.
   virtual int GetStatusCode() const = 0;
 
@@ -53,6 +60,15 @@ class URLLoaderWrapper {
                          uint32_t size,
                          base::OnceCallback<void(int)> callback) = 0;
 
+  // Open new connection and send http request for several byte ranges at
+  // once. If the server sends more than one of them, the response is
+  // multipart, and every ReadResponseBody() call returns data of one range,
+  // starting at the position given by GetByteRangeStart().
+  virtual void OpenRanges(const std::string& url,
+                          const std::string& referrer_url,
+                          base::span<const gfx::Range> byte_ranges,
+                          base::OnceCallback<void(int)> callback) = 0;
+
   // Read the response body. The size of the buffer must be large enough to
   // hold the specified number of bytes to read.
   // This function might perform a partial read.
@@ -19,6 +19,7 @@
 #include <string_view>
 #include <utility>
 
+#include "base/auto_reset.h"
 #include "base/check_op.h"
 #include "base/containers/span.h"
 #include "base/functional/bind.h"
@@ -26,7 +27,9 @@
 #include "base/location.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "base/task/single_thread_task_runner.h"
 #include "net/http/http_util.h"
+#include "pdf/loader/multipart_byte_ranges_parser.h"
 #include "pdf/loader/url_loader.h"
 #include "ui/gfx/range/range.h"
 
@@ -34,13 +37,10 @@ namespace chrome_pdf {
 
 namespace {
 
-// We should read with delay to prevent block UI thread, and reduce CPU usage.
-constexpr base::TimeDelta kReadDelayMs = base::Milliseconds(2);
-
 UrlRequest MakeRangeRequest(const std::string& url,
                             const std::string& referrer_url,
-                            uint32_t position,
-                            uint32_t size) {
+                            base::span<const gfx::Range> byte_ranges) {
+  DCHECK(!byte_ranges.empty());
   UrlRequest request;
   request.url = url;
   request.method = "GET";
@@ -49,10 +49,14 @@ UrlRequest MakeRangeRequest(const std::string& url,
 
   // According to rfc2616, byte range specifies position of the first and last
   // bytes in the requested range inclusively. Therefore we should subtract 1
-  // from the position + size, to get index of the last byte that needs to be
+  // from the end of each range, to get index of the last byte that needs to be
   // downloaded.
-  request.headers =
-      base::StringPrintf("Range: bytes=%d-%d", position, position + size - 1);
+  request.headers = "Range: bytes=";
+  for (size_t i = 0; i < byte_ranges.size(); ++i) {
+    DCHECK(!byte_ranges[i].is_empty());
+    base::StringAppendF(&request.headers, "%s%u-%u", i == 0 ? "" : ",",
+                        byte_ranges[i].start(), byte_ranges[i].end() - 1);
+  }
 
   return request;
 }
@@ -76,36 +80,6 @@ bool GetByteRangeFromStr(const std::string& content_range_str,
   return true;
 }
 
-// If the headers have a byte-range response, writes the start and end
-// positions and returns true if at least the start position was parsed.
-// The end position will be set to 0 if it was not found or parsed from the
-// response.
-// Returns false if not even a start position could be parsed.
-bool GetByteRangeFromHeaders(const std::string& headers, int* start, int* end) {
-  net::HttpUtil::HeadersIterator it(headers.begin(), headers.end(), "\n");
-  while (it.GetNext()) {
-    if (base::EqualsCaseInsensitiveASCII(it.name_piece(), "content-range")) {
-      if (GetByteRangeFromStr(it.values().c_str(), start, end))
-        return true;
-    }
-  }
-  return false;
-}
-
-bool IsDoubleEndLineAtEnd(const char* buffer, int size) {
-  if (size < 2)
-    return false;
-
-  if (buffer[size - 1] == '\n' && buffer[size - 2] == '\n')
-    return true;
-
-  if (size < 4)
-    return false;
-
-  return buffer[size - 1] == '\n' && buffer[size - 2] == '\r' &&
-         buffer[size - 3] == '\n' && buffer[size - 4] == '\r';
-}
-
 }  // namespace
 
 URLLoaderWrapperImpl::URLLoaderWrapperImpl(
@@ -137,6 +111,14 @@ std::string URLLoaderWrapperImpl::GetContentDisposition() const {
   return content_disposition_;
 }
 
+std::string URLLoaderWrapperImpl::GetETag() const {
+  return etag_;
+}
+
+std::string URLLoaderWrapperImpl::GetLastModified() const {
+  return last_modified_;
+}
+
 int URLLoaderWrapperImpl::GetStatusCode() const {
   return url_loader_->response().status_code;
 }
@@ -153,7 +135,9 @@ bool URLLoaderWrapperImpl::GetByteRangeStart(int* start) const {
 
 void URLLoaderWrapperImpl::Close() {
   url_loader_->Close();
-  read_starter_.Stop();
+
+  // Drop a read result that is still on its way to the caller.
+  read_weak_factory_.InvalidateWeakPtrs();
 }
 
 void URLLoaderWrapperImpl::OpenRange(const std::string& url,
@@ -161,8 +145,17 @@ void URLLoaderWrapperImpl::OpenRange(const std::string& url,
                                      uint32_t position,
                                      uint32_t size,
                                      base::OnceCallback<void(int)> callback) {
+  const gfx::Range byte_range(position, position + size);
+  OpenRanges(url, referrer_url, base::span_from_ref(byte_range),
+             std::move(callback));
+}
+
+void URLLoaderWrapperImpl::OpenRanges(const std::string& url,
+                                      const std::string& referrer_url,
+                                      base::span<const gfx::Range> byte_ranges,
+                                      base::OnceCallback<void(int)> callback) {
   url_loader_->Open(
-      MakeRangeRequest(url, referrer_url, position, size),
+      MakeRangeRequest(url, referrer_url, byte_ranges),
       base::BindOnce(&URLLoaderWrapperImpl::DidOpen, weak_factory_.GetWeakPtr(),
                      std::move(callback)));
 }
@@ -171,28 +164,65 @@ void URLLoaderWrapperImpl::ReadResponseBody(
     base::span<char> buffer,
     base::OnceCallback<void(int)> callback) {
   buffer_ = buffer;
-  read_starter_.Start(
-      FROM_HERE, kReadDelayMs,
-      base::BindOnce(&URLLoaderWrapperImpl::ReadResponseBodyImpl,
-                     base::Unretained(this), std::move(callback)));
+
+  // Reads complete right away while data is buffered, and otherwise as soon as
+  // data comes in.
+  base::AutoReset<bool> auto_reset_reading(&reading_, true);
+  ReadResponseBodyImpl(base::BindOnce(&URLLoaderWrapperImpl::DidReadBody,
+                                      read_weak_factory_.GetWeakPtr(),
+                                      std::move(callback)));
 }
 
 void URLLoaderWrapperImpl::ReadResponseBodyImpl(
     base::OnceCallback<void(int)> callback) {
+  // A multipart response may have more of the body buffered already.
+  if (multipart_parser_) {
+    const int result = ReadMultipartBody();
+    if (result != 0) {
+      std::move(callback).Run(result);
+      return;
+    }
+  }
   url_loader_->ReadResponseBody(
       buffer_, base::BindOnce(&URLLoaderWrapperImpl::DidRead,
                               weak_factory_.GetWeakPtr(), std::move(callback)));
 }
 
+void URLLoaderWrapperImpl::DidReadBody(base::OnceCallback<void(int)> callback,
+                                       int32_t result) {
+  if (!reading_) {
+    std::move(callback).Run(result);
+    return;
+  }
+
+  // The read completed within ReadResponseBody(). The caller usually reads
+  // again from `callback`, so run it from a new task, instead of recursing for
+  // as long as data is buffered.
+  base::SingleThreadTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&URLLoaderWrapperImpl::RunReadCallback,
+                     read_weak_factory_.GetWeakPtr(), std::move(callback),
+                     result));
+}
+
+void URLLoaderWrapperImpl::RunReadCallback(
+    base::OnceCallback<void(int)> callback,
+    int32_t result) {
+  std::move(callback).Run(result);
+}
+
 void URLLoaderWrapperImpl::ParseHeaders(const std::string& response_headers) {
   content_length_ = -1;
   accept_ranges_bytes_ = false;
   content_encoded_ = false;
   content_type_.clear();
   content_disposition_.clear();
+  etag_.clear();
+  last_modified_.clear();
   multipart_boundary_.clear();
   byte_range_ = gfx::Range::InvalidRange();
   is_multipart_ = false;
+  multipart_parser_.reset();
 
   if (response_headers.empty())
     return;
@@ -215,18 +245,26 @@ void URLLoaderWrapperImpl::ParseHeaders(const std::string& response_headers) {
         content_type_ = content_type_.substr(0, semi_colon_pos);
       }
       base::TrimWhitespaceASCII(content_type_, base::TRIM_ALL, &content_type_);
-      // multipart boundary.
+      // multipart boundary. Unlike the type, the boundary is case sensitive.
       std::string type = base::ToLowerASCII(it.values_piece());
       if (base::StartsWith(type, "multipart/", base::CompareCase::SENSITIVE)) {
-        const char* boundary = strstr(type.c_str(), "boundary=");
-        DCHECK(boundary);
-        if (boundary) {
-          multipart_boundary_ = std::string(boundary + 9);
+        constexpr std::string_view kBoundary = "boundary=";
+        const size_t boundary = type.find(kBoundary);
+        DCHECK_NE(boundary, std::string::npos);
+        if (boundary != std::string::npos) {
+          std::string_view value =
+              it.values_piece().substr(boundary + kBoundary.size());
+          value = value.substr(0, value.find(';'));
+          base::TrimString(value, "\"", &multipart_boundary_);
           is_multipart_ = !multipart_boundary_.empty();
         }
       }
     } else if (base::EqualsCaseInsensitiveASCII(name, "content-disposition")) {
       content_disposition_ = it.values();
+    } else if (base::EqualsCaseInsensitiveASCII(name, "etag")) {
+      etag_ = it.values();
+    } else if (base::EqualsCaseInsensitiveASCII(name, "last-modified")) {
+      last_modified_ = it.values();
     } else if (base::EqualsCaseInsensitiveASCII(name, "content-range")) {
       int start = 0;
       int end = 0;
@@ -235,6 +273,11 @@ void URLLoaderWrapperImpl::ParseHeaders(const std::string& response_headers) {
       }
     }
   }
+
+  if (is_multipart_) {
+    multipart_parser_ =
+        std::make_unique<MultipartByteRangesParser>(multipart_boundary_);
+  }
 }
 
 void URLLoaderWrapperImpl::DidOpen(base::OnceCallback<void(int)> callback,
@@ -245,48 +288,23 @@ void URLLoaderWrapperImpl::DidOpen(base::OnceCallback<void(int)> callback,
 
 void URLLoaderWrapperImpl::DidRead(base::OnceCallback<void(int)> callback,
                                    int32_t result) {
-  if (multi_part_processed_) {
-    // Reset this flag so we look inside the buffer in calls of DidRead for this
-    // response only once.  Note that this code DOES NOT handle multi part
-    // responses with more than one part (we don't issue them at the moment, so
-    // they shouldn't arrive).
-    is_multipart_ = false;
-  }
-  if (result <= 0 || !is_multipart_) {
-    std::move(callback).Run(result);
-    return;
-  }
-  if (result <= 2) {
-    // TODO(art-snake): Accumulate data for parse headers.
+  if (result <= 0 || !multipart_parser_) {
     std::move(callback).Run(result);
     return;
   }
 
-  char* start = buffer_.data();
-  size_t length = result;
-  multi_part_processed_ = true;
-  for (int i = 2; i < result; ++i) {
-    if (IsDoubleEndLineAtEnd(buffer_.data(), i)) {
-      int start_pos = 0;
-      int end_pos = 0;
-      if (GetByteRangeFromHeaders(std::string(buffer_.data(), i), &start_pos,
-                                  &end_pos)) {
-        byte_range_ = gfx::Range(start_pos, end_pos);
-        start += i;
-        length -= i;
-      }
-      break;
-    }
-  }
-  result = length;
-  if (result == 0) {
-    // Continue receiving.
-    return ReadResponseBodyImpl(std::move(callback));
-  }
-  DCHECK_GT(result, 0);
-  memmove(buffer_.data(), start, result);
+  multipart_parser_->Append(
+      base::span<const char>(buffer_.data(), static_cast<size_t>(result)));
+  ReadResponseBodyImpl(std::move(callback));
+}
 
-  std::move(callback).Run(result);
+int URLLoaderWrapperImpl::ReadMultipartBody() {
+  uint32_t position = 0;
+  const int result = multipart_parser_->Read(
+      base::span<char>(buffer_.data(), buffer_.size()), position);
+  if (result > 0)
+    byte_range_ = gfx::Range(position, position + result);
+  return result;
 }
 
 void URLLoaderWrapperImpl::SetHeadersFromLoader() {
@@ -14,12 +14,12 @@
 #include "base/functional/callback_forward.h"
 #include "base/memory/raw_span.h"
 #include "base/memory/weak_ptr.h"
-#include "base/timer/timer.h"
 #include "pdf/loader/url_loader_wrapper.h"
 #include "ui/gfx/range/range.h"
 
 namespace chrome_pdf {
 
+class MultipartByteRangesParser;
 class UrlLoader;
 
 class URLLoaderWrapperImpl : public URLLoaderWrapper {
@@ -35,6 +35,8 @@ class URLLoaderWrapperImpl : public URLLoaderWrapper {
   bool IsContentEncoded() const override;
   std::string GetContentType() const override;
   std::string GetContentDisposition() const override;
+  std::string GetETag() const override;
+  std::string GetLastModified() const override;
   int GetStatusCode() const override;
   bool IsMultipart() const override;
   bool GetByteRangeStart(int* start) const override;
@@ -44,6 +46,10 @@ class URLLoaderWrapperImpl : public URLLoaderWrapper {
                  uint32_t position,
                  uint32_t size,
                  base::OnceCallback<void(int)> callback) override;
+  void OpenRanges(const std::string& url,
+                  const std::string& referrer_url,
+                  base::span<const gfx::Range> byte_ranges,
+                  base::OnceCallback<void(int)> callback) override;
   void ReadResponseBody(base::span<char> buffer,
                         base::OnceCallback<void(int)> callback) override;
 
@@ -55,6 +61,14 @@ class URLLoaderWrapperImpl : public URLLoaderWrapper {
 
   void ReadResponseBodyImpl(base::OnceCallback<void(int)> callback);
 
+  // Hands the result of a read to the caller of ReadResponseBody().
+  void DidReadBody(base::OnceCallback<void(int)> callback, int32_t result);
+  void RunReadCallback(base::OnceCallback<void(int)> callback, int32_t result);
+
+  // Reads the next piece of a multipart response's body from
+  // `multipart_parser_` into `buffer_`. Returns 0 if it needs more data.
+  int ReadMultipartBody();
+
   std::unique_ptr<UrlLoader> url_loader_;
 
   int content_length_ = -1;
@@ -62,15 +76,23 @@ class URLLoaderWrapperImpl : public URLLoaderWrapper {
   bool content_encoded_ = false;
   std::string content_type_;
   std::string content_disposition_;
+  std::string etag_;
+  std::string last_modified_;
   std::string multipart_boundary_;
   gfx::Range byte_range_ = gfx::Range::InvalidRange();
   bool is_multipart_ = false;
   base::raw_span<char, DanglingUntriaged> buffer_;
-  bool multi_part_processed_ = false;
 
-  base::OneShotTimer read_starter_;
+  // Splits the body of multipart responses into the byte ranges.
+  std::unique_ptr<MultipartByteRangesParser> multipart_parser_;
+
+  // Whether ReadResponseBody() is on the stack.
+  bool reading_ = false;
 
   base::WeakPtrFactory<URLLoaderWrapperImpl> weak_factory_{this};
+
+  // For the read results on their way to the caller. Invalidated by Close().
+  base::WeakPtrFactory<URLLoaderWrapperImpl> read_weak_factory_{this};
 };
 
 }  // namespace chrome_pdf
@@ -0,0 +1,190 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/loader/url_loader_wrapper_impl.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/functional/bind.h"
+#include "base/functional/callback.h"
+#include "base/functional/callback_helpers.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/test/mock_callback.h"
+#include "net/cookies/site_for_cookies.h"
+#include "pdf/loader/url_loader.h"
+#include "pdf/test/mock_web_associated_url_loader.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/blink/public/platform/web_string.h"
+#include "third_party/blink/public/platform/web_url.h"
+#include "third_party/blink/public/platform/web_url_request.h"
+#include "third_party/blink/public/platform/web_url_response.h"
+#include "third_party/blink/public/web/web_associated_url_loader.h"
+#include "third_party/blink/public/web/web_associated_url_loader_options.h"
+#include "url/gurl.h"
+
+namespace chrome_pdf {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::NiceMock;
+
+constexpr char kDocumentUrl[] = "http://example.com/document.pdf";
+constexpr base::span<const char> kFakeData =
+    base::span_from_cstring("fake data");
+
+class FakeUrlLoaderClient : public UrlLoader::Client {
+ public:
+  base::WeakPtr<FakeUrlLoaderClient> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  // UrlLoader::Client:
+  bool IsValid() const override { return true; }
+
+  blink::WebURL CompleteURL(
+      const blink::WebString& partial_url) const override {
+    return GURL(partial_url.Utf8());
+  }
+
+  net::SiteForCookies SiteForCookies() const override {
+    return net::SiteForCookies();
+  }
+
+  void SetReferrerForRequest(blink::WebURLRequest& request,
+                             const blink::WebURL& referrer_url) override {}
+
+  std::unique_ptr<blink::WebAssociatedURLLoader> CreateAssociatedURLLoader(
+      const blink::WebAssociatedURLLoaderOptions& options) override {
+    return std::make_unique<NiceMock<MockWebAssociatedURLLoader>>();
+  }
+
+ private:
+  base::WeakPtrFactory<FakeUrlLoaderClient> weak_factory_{this};
+};
+
+// Reads again from the callback of every read, until the body ends.
+class StreamReader {
+ public:
+  explicit StreamReader(URLLoaderWrapper* loader) : loader_(loader) {}
+
+  void Read() {
+    loader_->ReadResponseBody(
+        buffer_,
+        base::BindOnce(&StreamReader::DidRead, base::Unretained(this)));
+  }
+
+  size_t bytes_read() const { return bytes_read_; }
+  bool finished() const { return finished_; }
+
+ private:
+  void DidRead(int result) {
+    if (result <= 0) {
+      finished_ = true;
+      return;
+    }
+    bytes_read_ += result;
+    Read();
+  }
+
+  const raw_ptr<URLLoaderWrapper> loader_;
+  char buffer_[kFakeData.size()] = {};
+  size_t bytes_read_ = 0;
+  bool finished_ = false;
+};
+
+class URLLoaderWrapperImplTest : public testing::Test {
+ protected:
+  URLLoaderWrapperImplTest() {
+    auto url_loader = std::make_unique<UrlLoader>(client_.GetWeakPtr());
+    url_loader_ = url_loader.get();
+    wrapper_ = std::make_unique<URLLoaderWrapperImpl>(std::move(url_loader));
+
+    wrapper_->OpenRange(kDocumentUrl, /*referrer_url=*/"", /*position=*/0,
+                        /*size=*/1000, base::DoNothing());
+    url_loader_->DidReceiveResponse(blink::WebURLResponse());
+  }
+
+  FakeUrlLoaderClient client_;
+  std::unique_ptr<URLLoaderWrapperImpl> wrapper_;
+  raw_ptr<UrlLoader> url_loader_;
+  base::MockCallback<base::OnceCallback<void(int)>> mock_callback_;
+};
+
+}  // namespace
+
+TEST_F(URLLoaderWrapperImplTest, ReadResponseBodyWaitsForData) {
+  char buffer[kFakeData.size()] = {};
+  wrapper_->ReadResponseBody(buffer, mock_callback_.Get());
+  EXPECT_CALL(mock_callback_, Run).Times(0);
+  base::RunLoop().RunUntilIdle();
+
+  // The read completes as soon as the data comes in.
+  EXPECT_CALL(mock_callback_, Run(kFakeData.size()));
+  url_loader_->DidReceiveData(kFakeData.data(), kFakeData.size());
+  EXPECT_THAT(buffer, ElementsAreArray(kFakeData));
+}
+
+TEST_F(URLLoaderWrapperImplTest, ReadResponseBodyWithBufferedData) {
+  url_loader_->DidReceiveData(kFakeData.data(), kFakeData.size());
+
+  // The read completes without waiting for a timer, but not from within
+  // ReadResponseBody().
+  char buffer[kFakeData.size()] = {};
+  EXPECT_CALL(mock_callback_, Run).Times(0);
+  wrapper_->ReadResponseBody(buffer, mock_callback_.Get());
+
+  EXPECT_CALL(mock_callback_, Run(kFakeData.size()));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_THAT(buffer, ElementsAreArray(kFakeData));
+}
+
+TEST_F(URLLoaderWrapperImplTest, ReadResponseBodyBatchesBufferedData) {
+  // Data that arrived in several blocks comes out in one read.
+  for (char data : kFakeData)
+    url_loader_->DidReceiveData(&data, 1);
+
+  std::vector<char> buffer(2 * kFakeData.size());
+  EXPECT_CALL(mock_callback_, Run(kFakeData.size()));
+  wrapper_->ReadResponseBody(buffer, mock_callback_.Get());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_THAT(base::span(buffer).first(kFakeData.size()),
+              ElementsAreArray(kFakeData));
+}
+
+TEST_F(URLLoaderWrapperImplTest, ReadResponseBodyKeepsReading) {
+  constexpr size_t kBlockCount = 1000;
+  for (size_t i = 0; i < kBlockCount; ++i)
+    url_loader_->DidReceiveData(kFakeData.data(), kFakeData.size());
+  url_loader_->DidFinishLoading();
+
+  // A consumer that reads again from its callback drains the whole body
+  // without any delays between the reads.
+  StreamReader reader(wrapper_.get());
+  reader.Read();
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_TRUE(reader.finished());
+  EXPECT_EQ(kBlockCount * kFakeData.size(), reader.bytes_read());
+}
+
+TEST_F(URLLoaderWrapperImplTest, CloseDropsBufferedReadResult) {
+  url_loader_->DidReceiveData(kFakeData.data(), kFakeData.size());
+
+  char buffer[kFakeData.size()] = {};
+  EXPECT_CALL(mock_callback_, Run).Times(0);
+  wrapper_->ReadResponseBody(buffer, mock_callback_.Get());
+  wrapper_->Close();
+  base::RunLoop().RunUntilIdle();
+}
+
+}  // namespace chrome_pdf
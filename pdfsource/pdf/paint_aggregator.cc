@@ -7,6 +7,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <limits>
+#include <utility>
+
 #include "base/check.h"
 #include "ui/gfx/geometry/point.h"
 #include "ui/gfx/geometry/rect.h"
@@ -16,10 +19,52 @@ namespace chrome_pdf {
 
 namespace {
 
+// Rects get combined if at most this percentage of their union was not dirty.
+constexpr int64_t kMaxUnionWastePercent = 25;
+
+// Same as `kMaxUnionWastePercent`, but for rects within the same affinity
+// rect, which would otherwise cost an extra paint job.
+constexpr int64_t kMaxAffinityUnionWastePercent = 50;
+
 bool IsNegative(int32_t num) {
   return num < 0;
 }
 
+// Returns the area that painting the union of `a` and `b` paints in addition
+// to painting `a` and `b`.
+int64_t GetUnionWaste(const gfx::Rect& a, const gfx::Rect& b) {
+  return gfx::UnionRects(a, b).size().Area64() - a.size().Area64() -
+         b.size().Area64() + gfx::IntersectRects(a, b).size().Area64();
+}
+
+// Returns the parts of `rect` outside of `hole`: the full-width bands above
+// and below `hole`, and the parts to its left and right in between.
+std::vector<gfx::Rect> SubtractRect(const gfx::Rect& rect,
+                                    const gfx::Rect& hole) {
+  gfx::Rect overlap = gfx::IntersectRects(rect, hole);
+  if (overlap.IsEmpty())
+    return {rect};
+
+  std::vector<gfx::Rect> parts;
+  if (overlap.y() > rect.y()) {
+    parts.emplace_back(rect.x(), rect.y(), rect.width(),
+                       overlap.y() - rect.y());
+  }
+  if (overlap.bottom() < rect.bottom()) {
+    parts.emplace_back(rect.x(), overlap.bottom(), rect.width(),
+                       rect.bottom() - overlap.bottom());
+  }
+  if (overlap.x() > rect.x()) {
+    parts.emplace_back(rect.x(), overlap.y(), overlap.x() - rect.x(),
+                       overlap.height());
+  }
+  if (overlap.right() < rect.right()) {
+    parts.emplace_back(overlap.right(), overlap.y(),
+                       rect.right() - overlap.right(), overlap.height());
+  }
+  return parts;
+}
+
 }  // namespace
 
 // ----------------------------------------------------------------------------
@@ -35,6 +80,13 @@ bool IsNegative(int32_t num) {
 //
 // We only support scrolling along one axis at a time.  A diagonal scroll will
 // therefore be treated as an invalidation.
+//
+// Overlapping or adjacent invalidations are combined into their union only if
+// the union does not paint much more than the invalidations themselves, with
+// more leeway for invalidations within the same affinity rect (e.g. a page).
+// Otherwise, the new invalidation is split and only its parts that are not
+// dirty already get added. To bound the number of paint jobs, the cheapest
+// pairs get combined regardless once there are too many paint rects.
 // ----------------------------------------------------------------------------
 
 PaintAggregator::PaintUpdate::PaintUpdate() = default;
@@ -109,6 +161,7 @@ PaintAggregator::PaintUpdate PaintAggregator::GetPendingUpdate() {
     update_.synthesized_scroll_damage_rect_ = true;
     gfx::Rect scroll_damage = update_.GetScrollDamage();
     InvalidateRectInternal(scroll_damage, false);
+    LimitPaintRects();
   }
 
   ret.paint_rects.reserve(update_.paint_rects.size() + 1);
@@ -124,6 +177,7 @@ void PaintAggregator::SetIntermediateResults(
   update_.ready_rects.insert(update_.ready_rects.end(), ready.begin(),
                              ready.end());
   update_.paint_rects = pending;
+  update_.frame_stats.requeued_rects += pending.size();
 }
 
 std::vector<PaintReadyRect> PaintAggregator::GetReadyRects() const {
@@ -132,6 +186,7 @@ std::vector<PaintReadyRect> PaintAggregator::GetReadyRects() const {
 
 void PaintAggregator::InvalidateRect(const gfx::Rect& rect) {
   InvalidateRectInternal(rect, true);
+  LimitPaintRects();
 }
 
 void PaintAggregator::ScrollRect(const gfx::Rect& clip_rect,
@@ -228,6 +283,12 @@ void PaintAggregator::ScrollRect(const gfx::Rect& clip_rect,
   if (update_.synthesized_scroll_damage_rect_) {
     InvalidateRect(update_.GetScrollDamage());
   }
+
+  LimitPaintRects();
+}
+
+void PaintAggregator::SetAffinityRects(std::vector<gfx::Rect> affinity_rects) {
+  affinity_rects_ = std::move(affinity_rects);
 }
 
 gfx::Rect PaintAggregator::ScrollPaintRect(const gfx::Rect& paint_rect,
@@ -260,17 +321,36 @@ void PaintAggregator::InvalidateRectInternal(const gfx::Rect& rect_old,
 
   bool add_paint = true;
 
-  // Combine overlapping paints using smallest bounding box.
+  // Combine overlapping paints using smallest bounding box, if that is cheap
+  // enough. Otherwise, only add the parts that are not dirty already.
   for (size_t i = 0; i < update_.paint_rects.size(); ++i) {
-    const gfx::Rect& existing_rect = update_.paint_rects[i];
-    if (existing_rect.Contains(rect))  // Optimize out redundancy.
+    const gfx::Rect existing_rect = update_.paint_rects[i];
+    if (existing_rect.Contains(rect)) {  // Optimize out redundancy.
       add_paint = false;
-    if (rect.Intersects(existing_rect) || rect.SharesEdgeWith(existing_rect)) {
+      break;
+    }
+
+    const bool intersects = rect.Intersects(existing_rect);
+    if (!intersects && !rect.SharesEdgeWith(existing_rect))
+      continue;
+
+    if (ShouldUnion(rect, existing_rect)) {
       // Re-invalidate in case the union intersects other paint rects.
-      gfx::Rect combined_rect = gfx::UnionRects(rect, existing_rect);
       update_.paint_rects.erase(update_.paint_rects.begin() + i);
-      InvalidateRectInternal(combined_rect, check_scroll);
+      ++update_.frame_stats.merged_rects;
+      InvalidateRectInternal(gfx::UnionRects(rect, existing_rect),
+                             check_scroll);
       add_paint = false;
+      break;
+    }
+
+    if (intersects) {
+      // Re-invalidate the parts in case they intersect other paint rects.
+      ++update_.frame_stats.split_rects;
+      for (const gfx::Rect& part : SubtractRect(rect, existing_rect))
+        InvalidateRectInternal(part, false);
+      add_paint = false;
+      break;
     }
   }
 
@@ -287,4 +367,66 @@ void PaintAggregator::InvalidateRectInternal(const gfx::Rect& rect_old,
   }
 }
 
+bool PaintAggregator::ShouldUnion(const gfx::Rect& a,
+                                  const gfx::Rect& b) const {
+  const int64_t waste = GetUnionWaste(a, b);
+  if (waste == 0)
+    return true;
+
+  const int affinity_index = GetAffinityIndex(a);
+  const int64_t max_waste_percent =
+      affinity_index != -1 && affinity_index == GetAffinityIndex(b)
+          ? kMaxAffinityUnionWastePercent
+          : kMaxUnionWastePercent;
+  return waste * 100 <=
+         gfx::UnionRects(a, b).size().Area64() * max_waste_percent;
+}
+
+int PaintAggregator::GetAffinityIndex(const gfx::Rect& rect) const {
+  for (size_t i = 0; i < affinity_rects_.size(); ++i) {
+    if (affinity_rects_[i].Contains(rect))
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+void PaintAggregator::LimitPaintRects() {
+  std::vector<gfx::Rect>& rects = update_.paint_rects;
+  while (rects.size() > kMaxPaintRects) {
+    // Find the pair that wastes the least area when combined.
+    size_t best_i = 0;
+    size_t best_j = 1;
+    int64_t best_waste = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < rects.size(); ++i) {
+      for (size_t j = i + 1; j < rects.size(); ++j) {
+        int64_t waste = GetUnionWaste(rects[i], rects[j]);
+        if (waste < best_waste) {
+          best_i = i;
+          best_j = j;
+          best_waste = waste;
+        }
+      }
+    }
+
+    gfx::Rect combined_rect = gfx::UnionRects(rects[best_i], rects[best_j]);
+    rects.erase(rects.begin() + best_j);
+    rects.erase(rects.begin() + best_i);
+    ++update_.frame_stats.merged_rects;
+
+    // Absorb the rects that the union now overlaps, so none of the paint
+    // rects overlap.
+    for (size_t i = 0; i < rects.size();) {
+      if (!combined_rect.Intersects(rects[i])) {
+        ++i;
+        continue;
+      }
+      combined_rect.Union(rects[i]);
+      rects.erase(rects.begin() + i);
+      ++update_.frame_stats.merged_rects;
+      i = 0;
+    }
+    rects.push_back(combined_rect);
+  }
+}
+
 }  // namespace chrome_pdf
@@ -5,6 +5,8 @@
 #ifndef PDF_PAINT_AGGREGATOR_H_
 #define PDF_PAINT_AGGREGATOR_H_
 
+#include <stddef.h>
+
 #include <vector>
 
 #include "pdf/paint_ready_rect.h"
@@ -51,6 +53,25 @@ class PaintAggregator {
     std::vector<gfx::Rect> paint_rects;
   };
 
+  // Counts how the dirty rectangles of an update got reshaped, from the first
+  // invalidation until ClearPendingUpdate().
+  struct FrameStats {
+    // Rectangles that got combined with another one into their union.
+    size_t merged_rects = 0;
+
+    // Rectangles that got split, so only the parts that were not dirty
+    // already got added.
+    size_t split_rects = 0;
+
+    // Rectangles that the plugin could not finish painting and that got
+    // queued again.
+    size_t requeued_rects = 0;
+  };
+
+  // The most dirty rectangles to track at once. Beyond this, the rectangles
+  // that are the cheapest to combine get combined.
+  static constexpr size_t kMaxPaintRects = 16;
+
   PaintAggregator();
 
   // There is a PendingUpdate if InvalidateRect or ScrollRect were called and
@@ -75,6 +96,13 @@ class PaintAggregator {
   // The given rect should be scrolled by the given amounts.
   void ScrollRect(const gfx::Rect& clip_rect, const gfx::Vector2d& amount);
 
+  // Sets the areas that the plugin paints as separate jobs, such as pages.
+  // Dirty rectangles within the same area get combined more eagerly, since
+  // painting them separately costs an extra job.
+  void SetAffinityRects(std::vector<gfx::Rect> affinity_rects);
+
+  const FrameStats& frame_stats() const { return update_.frame_stats; }
+
  private:
   // This structure is an internal version of PaintUpdate. It's different in
   // two respects:
@@ -107,6 +135,8 @@ class PaintAggregator {
 
     // Whether we have added the scroll damage rect to paint_rects yet or not.
     bool synthesized_scroll_damage_rect_;
+
+    FrameStats frame_stats;
   };
 
   gfx::Rect ScrollPaintRect(const gfx::Rect& paint_rect,
@@ -118,7 +148,19 @@ class PaintAggregator {
   // in the new scroll position.
   void InvalidateRectInternal(const gfx::Rect& rect, bool check_scroll);
 
+  // Whether it is cheaper to paint the union of `a` and `b` than to paint
+  // them separately.
+  bool ShouldUnion(const gfx::Rect& a, const gfx::Rect& b) const;
+
+  // Returns the index of the affinity rect that contains `rect`, or -1.
+  int GetAffinityIndex(const gfx::Rect& rect) const;
+
+  // Combines paint rects until there are at most `kMaxPaintRects` left.
+  void LimitPaintRects();
+
   InternalPaintUpdate update_;
+
+  std::vector<gfx::Rect> affinity_rects_;
 };
 
 }  // namespace chrome_pdf
@@ -0,0 +1,132 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/paint_aggregator.h"
+
+#include <vector>
+
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+TEST(PaintAggregatorTest, CombinesAdjacentRects) {
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect({0, 0, 10, 10});
+  aggregator.InvalidateRect({10, 0, 10, 10});
+
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(gfx::Rect(0, 0, 20, 10)));
+  EXPECT_EQ(1u, aggregator.frame_stats().merged_rects);
+  EXPECT_EQ(0u, aggregator.frame_stats().split_rects);
+}
+
+TEST(PaintAggregatorTest, CombinesCheaplyOverlappingRects) {
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect({0, 0, 10, 10});
+  aggregator.InvalidateRect({5, 2, 10, 10});
+
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(gfx::Rect(0, 0, 15, 12)));
+  EXPECT_EQ(1u, aggregator.frame_stats().merged_rects);
+}
+
+TEST(PaintAggregatorTest, KeepsDistantRectsSeparate) {
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect({0, 0, 100, 10});
+  aggregator.InvalidateRect({0, 90, 100, 10});
+
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(gfx::Rect(0, 0, 100, 10), gfx::Rect(0, 90, 100, 10)));
+  EXPECT_EQ(0u, aggregator.frame_stats().merged_rects);
+}
+
+TEST(PaintAggregatorTest, SplitsCostlyOverlappingRects) {
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect({0, 0, 100, 10});
+
+  // The union would be mostly clean, so only add the part that is not dirty.
+  aggregator.InvalidateRect({0, 0, 10, 100});
+
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              UnorderedElementsAre(gfx::Rect(0, 0, 100, 10),
+                                   gfx::Rect(0, 10, 10, 90)));
+  EXPECT_EQ(0u, aggregator.frame_stats().merged_rects);
+  EXPECT_EQ(1u, aggregator.frame_stats().split_rects);
+}
+
+TEST(PaintAggregatorTest, CombinesRectsWithinAffinityRectMoreEagerly) {
+  // A third of the union would be clean.
+  const gfx::Rect kRect1(0, 0, 60, 10);
+  const gfx::Rect kRect2(0, 5, 20, 15);
+
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect(kRect1);
+  aggregator.InvalidateRect(kRect2);
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(kRect1, gfx::Rect(0, 10, 20, 10)));
+
+  aggregator.ClearPendingUpdate();
+  aggregator.SetAffinityRects({gfx::Rect(0, 0, 100, 100)});
+  aggregator.InvalidateRect(kRect1);
+  aggregator.InvalidateRect(kRect2);
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(gfx::Rect(0, 0, 60, 20)));
+
+  // Rects that are not within the same affinity rect are held to the stricter
+  // limit.
+  aggregator.ClearPendingUpdate();
+  aggregator.SetAffinityRects(
+      {gfx::Rect(0, 0, 100, 10), gfx::Rect(0, 10, 100, 90)});
+  aggregator.InvalidateRect(kRect1);
+  aggregator.InvalidateRect(kRect2);
+  EXPECT_THAT(aggregator.GetPendingUpdate().paint_rects,
+              ElementsAre(kRect1, gfx::Rect(0, 10, 20, 10)));
+}
+
+TEST(PaintAggregatorTest, LimitsPaintRects) {
+  PaintAggregator aggregator;
+  for (int i = 0; i < 20; ++i)
+    aggregator.InvalidateRect({i * 10, 0, 5, 5});
+
+  std::vector<gfx::Rect> paint_rects =
+      aggregator.GetPendingUpdate().paint_rects;
+  EXPECT_EQ(PaintAggregator::kMaxPaintRects, paint_rects.size());
+  EXPECT_EQ(20u - PaintAggregator::kMaxPaintRects,
+            aggregator.frame_stats().merged_rects);
+
+  // No dirty area got lost, and none is painted twice.
+  for (int i = 0; i < 20; ++i) {
+    const gfx::Rect rect(i * 10, 0, 5, 5);
+    int containing_rects = 0;
+    for (const gfx::Rect& paint_rect : paint_rects) {
+      if (paint_rect.Contains(rect))
+        ++containing_rects;
+    }
+    EXPECT_EQ(1, containing_rects) << rect.ToString();
+  }
+}
+
+TEST(PaintAggregatorTest, CountsRequeuedRects) {
+  PaintAggregator aggregator;
+  aggregator.InvalidateRect({0, 0, 100, 100});
+  aggregator.SetIntermediateResults(
+      /*ready=*/{}, /*pending=*/{{0, 0, 50, 100}, {50, 0, 50, 100}});
+  aggregator.SetIntermediateResults(/*ready=*/{},
+                                    /*pending=*/{{50, 0, 50, 100}});
+  EXPECT_EQ(3u, aggregator.frame_stats().requeued_rects);
+
+  aggregator.ClearPendingUpdate();
+  EXPECT_EQ(0u, aggregator.frame_stats().requeued_rects);
+}
+
+}  // namespace
+
+}  // namespace chrome_pdf
@@ -13,6 +13,7 @@
 
 #include "base/auto_reset.h"
 #include "base/check.h"
+#include "base/feature_list.h"
 #include "base/functional/bind.h"
 #include "base/functional/callback.h"
 #include "base/location.h"
@@ -20,6 +21,7 @@
 #include "base/task/sequenced_task_runner.h"
 #include "base/task/single_thread_task_runner.h"
 #include "pdf/paint_ready_rect.h"
+#include "pdf/pdf_features.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkRect.h"
@@ -36,7 +38,10 @@
 
 namespace chrome_pdf {
 
-PaintManager::PaintManager(Client* client) : client_(client) {
+PaintManager::PaintManager(Client* client)
+    : client_(client),
+      paint_in_place_(
+          base::FeatureList::IsEnabled(features::kPdfPaintInPlace)) {
   DCHECK(client_);
 }
 
@@ -114,7 +119,7 @@ void PaintManager::SetTransform(float scale,
   if (!schedule_flush)
     return;
 
-  if (flush_pending_) {
+  if (flush_pending_ || update_in_progress_) {
     flush_requested_ = true;
     return;
   }
@@ -161,6 +166,11 @@ void PaintManager::ScrollRect(const gfx::Rect& clip_rect,
   aggregator_.ScrollRect(clip_rect, amount);
 }
 
+void PaintManager::SetPaintAffinityRects(
+    std::vector<gfx::Rect> affinity_rects) {
+  aggregator_.SetAffinityRects(std::move(affinity_rects));
+}
+
 gfx::Size PaintManager::GetEffectiveSize() const {
   return has_pending_resize_ ? pending_size_ : plugin_size_;
 }
@@ -213,10 +223,23 @@ void PaintManager::DoPaint() {
                              : gfx::Size();
     gfx::Size new_size = GetNewContextSize(old_size, pending_size_);
     if (old_size != new_size || !surface_) {
-      surface_ = SkSurfaces::Raster(
-          SkImageInfo::MakeN32Premul(new_size.width(), new_size.height()));
+      const SkImageInfo info =
+          SkImageInfo::MakeN32Premul(new_size.width(), new_size.height());
+      if (paint_in_place_) {
+        // Replace `surface_` before the pixels it wraps.
+        SkBitmap bitmap;
+        bitmap.allocPixels(info);
+        surface_ = SkSurfaces::WrapPixels(bitmap.pixmap());
+        surface_bitmap_ = std::move(bitmap);
+      } else {
+        surface_ = SkSurfaces::Raster(info);
+      }
       DCHECK(surface_);
 
+      // The new surface has not been scrolled.
+      applied_scroll_rect_ = gfx::Rect();
+      applied_scroll_delta_ = gfx::Vector2d();
+
       // TODO(crbug.com/40222665): Can we guarantee repainting some other way?
       client_->InvalidatePluginContainer();
 
@@ -239,8 +262,16 @@ void PaintManager::DoPaint() {
   }
 
   PaintAggregator::PaintUpdate update = aggregator_.GetPendingUpdate();
+  if (paint_in_place_) {
+    ScrollSurface(update);
+
+    // The client writes to the pixels directly, so tell `surface_` to drop
+    // any cached snapshot of them.
+    surface_->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+  }
   client_->OnPaint(update.paint_rects, ready_rects, pending_rects);
 
+  update_in_progress_ = paint_in_place_ && !pending_rects.empty();
   if (ready_rects.empty() && pending_rects.empty())
     return;  // Nothing was painted, don't schedule a flush.
 
@@ -248,16 +279,16 @@ void PaintManager::DoPaint() {
   if (pending_rects.empty()) {
     aggregator_.SetIntermediateResults(ready_rects, pending_rects);
     ready_now = aggregator_.GetReadyRects();
+    last_frame_stats_ = aggregator_.frame_stats();
     aggregator_.ClearPendingUpdate();
 
-    // First, apply any scroll amount less than the surface's size.
-    if (update.has_scroll &&
-        std::abs(update.scroll_delta.x()) < surface_->width() &&
-        std::abs(update.scroll_delta.y()) < surface_->height()) {
-      // TODO(crbug.com/40203030): Use `SkSurface::notifyContentWillChange()`.
-      gfx::ScrollCanvas(surface_->getCanvas(), update.scroll_rect,
-                        update.scroll_delta);
-    }
+    // First, apply the part of the scroll that `surface_` has not been
+    // scrolled by yet. When painting in place, that happened before painting.
+    // TODO(crbug.com/40203030): Use `SkSurface::notifyContentWillChange()`.
+    if (!paint_in_place_)
+      ScrollSurface(update);
+    applied_scroll_rect_ = gfx::Rect();
+    applied_scroll_delta_ = gfx::Vector2d();
 
     view_size_changed_waiting_for_paint_ = false;
   } else {
@@ -268,8 +299,11 @@ void PaintManager::DoPaint() {
       // previous image, but if we flush, it'll revert to using the blank image.
       // We make an exception for the first paint since we want to show the
       // default background color instead of the pepper default of black.
+      // When painting in place, the surface holds the partially painted
+      // update, so only flush it early for the first paint.
       if (ready_rect.flush_now() &&
-          (!view_size_changed_waiting_for_paint_ || first_paint_)) {
+          (!view_size_changed_waiting_for_paint_ || first_paint_) &&
+          (!paint_in_place_ || first_paint_)) {
         ready_now.push_back(ready_rect);
       } else {
         ready_later.push_back(ready_rect);
@@ -283,9 +317,17 @@ void PaintManager::DoPaint() {
       EnsureCallbackPending();
       return;
     }
+
+    // The rectangles to flush are painted where the update's scroll puts
+    // them, so the rest of `surface_` has to follow the scroll now.
+    if (!paint_in_place_)
+      ScrollSurface(update);
   }
 
   for (const auto& ready_rect : ready_now) {
+    if (ready_rect.painted_in_place())
+      continue;
+
     SkRect skia_rect = gfx::RectToSkRect(ready_rect.rect());
     surface_->getCanvas()->drawImageRect(
         &ready_rect.image(), skia_rect, skia_rect, SkSamplingOptions(), nullptr,
@@ -297,12 +339,48 @@ void PaintManager::DoPaint() {
   first_paint_ = false;
 }
 
+void PaintManager::ScrollSurface(PaintAggregator::PaintUpdate& update) {
+  const bool continues_applied_scroll =
+      applied_scroll_delta_.IsZero() ||
+      (update.has_scroll && update.scroll_rect == applied_scroll_rect_ &&
+       (update.scroll_delta.x() == 0) == (applied_scroll_delta_.x() == 0));
+  if (!continues_applied_scroll) {
+    // The scroll changed in a way that `surface_` cannot follow, e.g. it got
+    // converted into an invalidation. Repaint everything instead.
+    aggregator_.InvalidateRect(
+        gfx::Rect(surface_->width(), surface_->height()));
+    update = aggregator_.GetPendingUpdate();
+    applied_scroll_rect_ = update.scroll_rect;
+    applied_scroll_delta_ = update.scroll_delta;
+    return;
+  }
+
+  if (!update.has_scroll)
+    return;
+
+  const gfx::Vector2d delta = update.scroll_delta - applied_scroll_delta_;
+  applied_scroll_rect_ = update.scroll_rect;
+  applied_scroll_delta_ = update.scroll_delta;
+
+  // Scrolling by the surface's size or more exposes all of it, and the
+  // exposed area gets repainted anyway.
+  if (delta.IsZero() || std::abs(delta.x()) >= surface_->width() ||
+      std::abs(delta.y()) >= surface_->height()) {
+    return;
+  }
+
+  gfx::ScrollCanvas(surface_->getCanvas(), update.scroll_rect, delta);
+}
+
 void PaintManager::Flush() {
   flush_requested_ = false;
 
   sk_sp<SkImage> snapshot = surface_->makeImageSnapshot();
-  surface_->getCanvas()->drawImage(snapshot.get(), /*x=*/0, /*y=*/0,
-                                   SkSamplingOptions(), /*paint=*/nullptr);
+  if (!paint_in_place_) {
+    // Force the copy-on-write now, rather than on the next paint.
+    surface_->getCanvas()->drawImage(snapshot.get(), /*x=*/0, /*y=*/0,
+                                     SkSamplingOptions(), /*paint=*/nullptr);
+  }
   client_->UpdateSnapshot(std::move(snapshot));
 
   // TODO(crbug.com/40251507): Complete flush synchronously.
@@ -10,16 +10,17 @@
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "pdf/paint_aggregator.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
+#include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
+#include "ui/gfx/geometry/vector2d.h"
 
 class SkImage;
 class SkSurface;
 
 namespace gfx {
 class Point;
-class Rect;
-class Vector2d;
 class Vector2dF;
 }  // namespace gfx
 
@@ -56,6 +57,10 @@ class PaintManager {
     // automatically if you return true from this function since the
     // PaintManager needs to handle the callback.
     //
+    // If `PaintManager::paints_in_place()`, paint into
+    // `PaintManager::surface_bitmap()` instead, and report ready rects without
+    // images. Its contents are already scrolled as needed.
+    //
     // Calling Invalidate/Scroll is not allowed while inside an OnPaint
     virtual void OnPaint(const std::vector<gfx::Rect>& paint_rects,
                          std::vector<PaintReadyRect>& ready,
@@ -114,6 +119,15 @@ class PaintManager {
   // The given rect should be scrolled by the given amounts.
   void ScrollRect(const gfx::Rect& clip_rect, const gfx::Vector2d& amount);
 
+  // Sets the areas that the client paints as separate jobs, such as pages.
+  // See `PaintAggregator::SetAffinityRects()`.
+  void SetPaintAffinityRects(std::vector<gfx::Rect> affinity_rects);
+
+  // How the dirty rects of the last completed update got reshaped.
+  const PaintAggregator::FrameStats& last_frame_stats() const {
+    return last_frame_stats_;
+  }
+
   // Returns the size of the graphics context for the next paint operation.
   // This is the pending size if a resize is pending (the plugin has called
   // SetSize but we haven't actually painted it yet), or the current size of
@@ -133,6 +147,14 @@ class PaintManager {
   // This does not schedule a flush.
   void ClearTransform();
 
+  // Whether the client paints directly into `surface_bitmap()`, rather than
+  // into its own buffer that then gets copied into the surface.
+  bool paints_in_place() const { return paint_in_place_; }
+
+  // The pixels backing the surface, if `paints_in_place()`. Empty until the
+  // first paint, and replaced whenever the surface gets resized.
+  const SkBitmap& surface_bitmap() const { return surface_bitmap_; }
+
  private:
   // Makes sure there is a callback that will trigger a paint at a later time.
   // This will be either a Flush callback telling us we're allowed to generate
@@ -143,6 +165,14 @@ class PaintManager {
   // Does the client paint and executes a Flush if necessary.
   void DoPaint();
 
+  // Scrolls the surface by the part of `update`'s scroll that it has not been
+  // scrolled by yet. When painting in place, must happen before the client
+  // paints, which expects the surface to be scrolled already. Otherwise, must
+  // happen before flushing any part of `update`. Falls back to invalidating
+  // the whole surface if `update` no longer continues the scroll applied so
+  // far.
+  void ScrollSurface(PaintAggregator::PaintUpdate& update);
+
   // Executes a Flush.
   void Flush();
 
@@ -156,10 +186,28 @@ class PaintManager {
   // Non-owning pointer. See the constructor.
   const raw_ptr<Client> client_;
 
+  // Whether the client paints directly into `surface_bitmap_`. Set from the
+  // PdfPaintInPlace feature.
+  const bool paint_in_place_;
+
+  // Pixels backing `surface_` when painting in place. Must outlive `surface_`.
+  SkBitmap surface_bitmap_;
+
   // Backing Skia surface.
   sk_sp<SkSurface> surface_;
 
+  // The scroll already applied to `surface_` for the pending update, when
+  // painting in place or after flushing part of the update early.
+  gfx::Rect applied_scroll_rect_;
+  gfx::Vector2d applied_scroll_delta_;
+
+  // When painting in place, true while the client has painted part of the
+  // pending update into `surface_`. Flushing then would show an incomplete
+  // frame, so flushes are deferred until the update completes.
+  bool update_in_progress_ = false;
+
   PaintAggregator aggregator_;
+  PaintAggregator::FrameStats last_frame_stats_;
 
   // See comment for EnsureCallbackPending for more on how these work.
   bool manual_callback_pending_ = false;
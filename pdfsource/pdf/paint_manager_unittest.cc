@@ -9,9 +9,11 @@
 
 #include "base/files/file_path.h"
 #include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
 #include "cc/test/pixel_comparator.h"
 #include "cc/test/pixel_test_utils.h"
 #include "pdf/paint_ready_rect.h"
+#include "pdf/pdf_features.h"
 #include "pdf/test/test_helpers.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -320,6 +322,158 @@ TEST_F(PaintManagerTest, ScrollIgnored) {
              "scroll_ignored.png");
 }
 
+TEST_F(PaintManagerTest, FlushNowWhilePending) {
+  constexpr gfx::Size kPluginSize(20, 20);
+  paint_manager_.SetSize(kPluginSize, 1.0f);
+  ASSERT_TRUE(WaitForFlush(
+      /*expected_paint_rects=*/{gfx::Rect(kPluginSize)},
+      /*fake_ready=*/
+      {{gfx::Rect(kPluginSize),
+        CreateSkiaImageForTesting(kPluginSize, SK_ColorMAGENTA)}},
+      /*fake_pending=*/{}));
+
+  // A rectangle that is ready to be flushed right away, such as a page
+  // placeholder, shows while another one is still pending.
+  paint_manager_.Invalidate();
+  sk_sp<SkImage> snapshot = WaitForFlush(
+      /*expected_paint_rects=*/{gfx::Rect(kPluginSize)},
+      /*fake_ready=*/
+      {{{0, 0, 10, 20},
+        CreateSkiaImageForTesting(kPluginSize, SK_ColorRED),
+        /*flush_now=*/true}},
+      /*fake_pending=*/{{10, 0, 10, 20}});
+  ASSERT_TRUE(snapshot);
+
+  SkBitmap snapshot_bitmap;
+  ASSERT_TRUE(snapshot->asLegacyBitmap(&snapshot_bitmap));
+  EXPECT_EQ(SK_ColorRED, snapshot_bitmap.getColor(5, 10));
+  EXPECT_EQ(SK_ColorMAGENTA, snapshot_bitmap.getColor(15, 10));
+}
+
+TEST_F(PaintManagerTest, FlushNowWhilePendingAfterScroll) {
+  constexpr gfx::Size kPluginSize(20, 20);
+  paint_manager_.SetSize(kPluginSize, 1.0f);
+  sk_sp<SkSurface> initial_surface =
+      CreateSkiaSurfaceForTesting(kPluginSize, SK_ColorGREEN);
+  initial_surface->getCanvas()->clipIRect(SkIRect::MakeLTRB(0, 10, 20, 20));
+  initial_surface->getCanvas()->clear(SK_ColorBLUE);
+  ASSERT_TRUE(WaitForFlush(
+      /*expected_paint_rects=*/{gfx::Rect(kPluginSize)},
+      /*fake_ready=*/
+      {{gfx::Rect(kPluginSize), initial_surface->makeImageSnapshot()}},
+      /*fake_pending=*/{}));
+
+  // Flushing part of the scroll damage early scrolls the rest of the surface
+  // along with it.
+  paint_manager_.ScrollRect(gfx::Rect(kPluginSize), {0, -10});
+  sk_sp<SkImage> snapshot = WaitForFlush(
+      /*expected_paint_rects=*/{{0, 10, 20, 10}},
+      /*fake_ready=*/
+      {{{0, 10, 10, 10},
+        CreateSkiaImageForTesting(kPluginSize, SK_ColorRED),
+        /*flush_now=*/true}},
+      /*fake_pending=*/{{10, 10, 10, 10}});
+  ASSERT_TRUE(snapshot);
+
+  SkBitmap snapshot_bitmap;
+  ASSERT_TRUE(snapshot->asLegacyBitmap(&snapshot_bitmap));
+  EXPECT_EQ(SK_ColorBLUE, snapshot_bitmap.getColor(5, 5));
+  EXPECT_EQ(SK_ColorRED, snapshot_bitmap.getColor(5, 15));
+}
+
+class PaintManagerPaintInPlaceTest : public testing::Test {
+ protected:
+  // Expects a paint of `expected_paint_rect`, fills it with `color` directly
+  // in the `PaintManager`'s surface, and returns the flushed snapshot, cropped
+  // to the plugin size.
+  sk_sp<SkImage> PaintInPlaceAndWaitForFlush(
+      const gfx::Rect& expected_paint_rect,
+      SkColor color) {
+    EXPECT_CALL(client_,
+                OnPaint(std::vector<gfx::Rect>{expected_paint_rect}, _, _))
+        .WillOnce([this, color](const std::vector<gfx::Rect>& paint_rects,
+                                std::vector<PaintReadyRect>& ready,
+                                std::vector<gfx::Rect>& pending) {
+          paint_manager_.surface_bitmap().erase(
+              color, gfx::RectToSkIRect(paint_rects[0]));
+          ready.emplace_back(paint_rects[0]);
+        });
+
+    sk_sp<SkImage> saved_snapshot;
+    base::RunLoop run_loop;
+    EXPECT_CALL(client_, UpdateSnapshot)
+        .WillOnce([&saved_snapshot, &run_loop](sk_sp<SkImage> snapshot) {
+          saved_snapshot = std::move(snapshot);
+          run_loop.Quit();
+        });
+    run_loop.Run();
+
+    if (!saved_snapshot)
+      return nullptr;
+
+    const gfx::Size plugin_size = paint_manager_.GetEffectiveSize();
+    return saved_snapshot->makeSubset(
+        static_cast<GrDirectContext*>(nullptr),
+        SkIRect::MakeWH(plugin_size.width(), plugin_size.height()));
+  }
+
+  // Must outlive `paint_manager_`, which checks the feature on construction.
+  base::test::ScopedFeatureList feature_list_{features::kPdfPaintInPlace};
+  NiceMock<FakeClient> client_;
+  PaintManager paint_manager_{&client_};
+};
+
+TEST_F(PaintManagerPaintInPlaceTest, PaintInPlace) {
+  ASSERT_TRUE(paint_manager_.paints_in_place());
+  paint_manager_.SetSize({20, 10}, 1.0f);
+
+  sk_sp<SkImage> first_snapshot =
+      PaintInPlaceAndWaitForFlush({0, 0, 20, 10}, SK_ColorRED);
+  ASSERT_TRUE(first_snapshot);
+
+  paint_manager_.InvalidateRect({5, 0, 5, 10});
+  sk_sp<SkImage> second_snapshot =
+      PaintInPlaceAndWaitForFlush({5, 0, 5, 10}, SK_ColorBLUE);
+  ASSERT_TRUE(second_snapshot);
+
+  // The first snapshot must not see the pixels painted afterwards.
+  sk_sp<SkSurface> expected_surface =
+      CreateSkiaSurfaceForTesting({20, 10}, SK_ColorRED);
+  SkBitmap expected_bitmap;
+  ASSERT_TRUE(expected_surface->makeImageSnapshot()->asLegacyBitmap(
+      &expected_bitmap));
+  SkBitmap snapshot_bitmap;
+  ASSERT_TRUE(first_snapshot->asLegacyBitmap(&snapshot_bitmap));
+  EXPECT_TRUE(cc::MatchesBitmap(snapshot_bitmap, expected_bitmap,
+                                cc::ExactPixelComparator()));
+
+  expected_surface->getCanvas()->clipIRect(SkIRect::MakeXYWH(5, 0, 5, 10));
+  expected_surface->getCanvas()->clear(SK_ColorBLUE);
+  ASSERT_TRUE(expected_surface->makeImageSnapshot()->asLegacyBitmap(
+      &expected_bitmap));
+  ASSERT_TRUE(second_snapshot->asLegacyBitmap(&snapshot_bitmap));
+  EXPECT_TRUE(cc::MatchesBitmap(snapshot_bitmap, expected_bitmap,
+                                cc::ExactPixelComparator()));
+}
+
+TEST_F(PaintManagerPaintInPlaceTest, Scroll) {
+  paint_manager_.SetSize({4, 5}, 1.0f);
+
+  // Paint the same non-uniform initial image as `PaintManagerTest`.
+  ASSERT_TRUE(PaintInPlaceAndWaitForFlush({0, 0, 4, 5}, SK_ColorRED));
+  paint_manager_.InvalidateRect({1, 1, 2, 2});
+  ASSERT_TRUE(PaintInPlaceAndWaitForFlush({1, 1, 2, 2}, SK_ColorGREEN));
+
+  // The scroll is applied to the surface before painting the exposed area.
+  paint_manager_.ScrollRect({0, 0, 4, 5}, {1, 0});
+  sk_sp<SkImage> snapshot =
+      PaintInPlaceAndWaitForFlush({0, 0, 1, 5}, SK_ColorMAGENTA);
+  ASSERT_TRUE(snapshot);
+
+  EXPECT_TRUE(MatchesPngFile(snapshot.get(),
+                             GetTestDataFilePath("scroll_right.png")));
+}
+
 }  // namespace
 
 }  // namespace chrome_pdf
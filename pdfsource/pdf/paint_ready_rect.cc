@@ -20,6 +20,9 @@ PaintReadyRect::PaintReadyRect(const gfx::Rect& rect,
   DCHECK(image_);
 }
 
+PaintReadyRect::PaintReadyRect(const gfx::Rect& rect, bool flush_now)
+    : rect_(rect), flush_now_(flush_now) {}
+
 PaintReadyRect::PaintReadyRect(const PaintReadyRect& other) = default;
 
 PaintReadyRect& PaintReadyRect::operator=(const PaintReadyRect& other) =
@@ -27,4 +30,9 @@ PaintReadyRect& PaintReadyRect::operator=(const PaintReadyRect& other) =
 
 PaintReadyRect::~PaintReadyRect() = default;
 
+const SkImage& PaintReadyRect::image() const {
+  DCHECK(image_);
+  return *image_;
+}
+
 }  // namespace chrome_pdf
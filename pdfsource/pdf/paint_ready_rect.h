@@ -21,6 +21,10 @@ class PaintReadyRect {
                  sk_sp<SkImage> image,
                  bool flush_now = false);
 
+  // For a rectangle that was painted directly into the `PaintManager`'s
+  // surface. See `PaintManager::paints_in_place()`.
+  explicit PaintReadyRect(const gfx::Rect& rect, bool flush_now = false);
+
   PaintReadyRect(const PaintReadyRect& other);
   PaintReadyRect& operator=(const PaintReadyRect& other);
   ~PaintReadyRect();
@@ -28,7 +32,12 @@ class PaintReadyRect {
   const gfx::Rect& rect() const { return rect_; }
   void set_rect(const gfx::Rect& rect) { rect_ = rect; }
 
-  const SkImage& image() const { return *image_; }
+  // Must not be called if `painted_in_place()`.
+  const SkImage& image() const;
+
+  // Whether the rectangle is already painted into the `PaintManager`'s
+  // surface, so there is no image to copy it from.
+  bool painted_in_place() const { return !image_; }
 
   // Whether to flush to screen immediately; otherwise, when the rest of the
   // plugin viewport is ready.
@@ -57,6 +57,7 @@ class Vector2d;
 
 namespace chrome_pdf {
 
+class AsyncDocumentCache;
 class Thumbnail;
 class UrlLoader;
 struct AccessibilityActionData;
@@ -243,6 +244,10 @@ class PDFEngine {
     // Creates and returns new URL loader for partial document requests.
     virtual std::unique_ptr<UrlLoader> CreateUrlLoader() = 0;
 
+    // Returns the cache to keep the downloaded parts of the document in, if
+    // any. It must outlive the engine.
+    virtual AsyncDocumentCache* GetDocumentCache() { return nullptr; }
+
     // Returns the current V8 isolate, if any.
     virtual v8::Isolate* GetIsolate() = 0;
 
@@ -313,11 +318,15 @@ class PDFEngine {
   virtual void ScrolledToXPosition(int position) = 0;
   virtual void ScrolledToYPosition(int position) = 0;
   // Paint is called a series of times. Before these n calls are made, PrePaint
-  // is called once. After Paint is called n times, PostPaint is called once.
-  virtual void PrePaint() = 0;
+  // is called once with the n rects. After Paint is called n times, PostPaint
+  // is called once. Paint adds the parts of `rect` that finished painting to
+  // `ready`, or to `ready_now` if they should be shown right away, without
+  // waiting for the parts that are still `pending`.
+  virtual void PrePaint(const std::vector<gfx::Rect>& rects) = 0;
   virtual void Paint(const gfx::Rect& rect,
                      SkBitmap& image_data,
                      std::vector<gfx::Rect>& ready,
+                     std::vector<gfx::Rect>& ready_now,
                      std::vector<gfx::Rect>& pending) = 0;
   virtual void PostPaint() = 0;
   virtual bool HandleInputEvent(const blink::WebInputEvent& event) = 0;
@@ -387,6 +396,8 @@ class PDFEngine {
   virtual int GetMostVisiblePage() = 0;
   // Returns whether the page at `index` is visible or not.
   virtual bool IsPageVisible(int index) const = 0;
+  // Gets the indices of the visible pages, in ascending order.
+  virtual std::vector<int> GetVisiblePages() const = 0;
   // Gets the current layout orientation.
   virtual PageOrientation GetCurrentOrientation() const = 0;
   // Gets the rectangle of the page not including the shadow.
@@ -491,6 +502,10 @@ class PDFEngine {
   virtual uint32_t GetLoadedByteSize() = 0;
   virtual bool ReadLoadedBytes(uint32_t length, void* buffer) = 0;
 
+  // Returns all the loaded bytes without copying them, or an empty span if
+  // they are not held in one piece. Then use ReadLoadedBytes() instead.
+  virtual base::span<const uint8_t> GetLoadedBytes() = 0;
+
   // Requests for a thumbnail to be sent using a callback when the page is ready
   // to be rendered. `send_callback` is run with the thumbnail data when ready.
   virtual void RequestThumbnail(int page_index,
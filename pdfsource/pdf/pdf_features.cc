@@ -17,14 +17,103 @@ BASE_FEATURE(kAccessiblePDFForm,
              "AccessiblePDFForm",
              base::FEATURE_DISABLED_BY_DEFAULT);
 
+// Sizes each slice of progressive page rendering from the measured render cost
+// of the page and the remaining frame time, instead of fixed timeouts.
+BASE_FEATURE(kPdfAdaptivePaintScheduling,
+             "PdfAdaptivePaintScheduling",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Sizes the range requests of partially loaded PDFs from the measured
+// bandwidth and round trip time of the connection, instead of a fixed number
+// of chunks. Has no effect unless kPdfPartialLoading is enabled too.
+BASE_FEATURE(kPdfAdaptiveRequestSize,
+             "PdfAdaptiveRequestSize",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Updates the find tick marks and result count once per find task, instead of
+// after every result, which makes searches with many results quadratic.
+BASE_FEATURE(kPdfBatchedFindUpdates,
+             "PdfBatchedFindUpdates",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Gathers the data of completely downloaded PDFs into one contiguous buffer,
+// which PDFium then parses in place, and which saving shares. If the size of
+// the PDF is known up front, the buffer gets allocated for all of it then, and
+// downloads fill it in place. Otherwise, the data gets copied into it once
+// complete, which briefly takes twice the memory.
+BASE_FEATURE(kPdfContiguousDocumentData,
+             "PdfContiguousDocumentData",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Also finds the phrases that continue from one page onto the next, once the
+// text of every page is indexed. Has no effect unless kPdfFindTextIndex is
+// enabled too.
+BASE_FEATURE(kPdfCrossPageFind,
+             "PdfCrossPageFind",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Keeps the normalized text of the pages of a document in memory once find has
+// extracted it, and fills in the rest in the background after the document
+// loads, so that later searches do not need to load the pages again.
+BASE_FEATURE(kPdfFindTextIndex,
+             "PdfFindTextIndex",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
 // "Incremental loading" refers to loading the PDF as it arrives.
 // TODO(crbug.com/40123601): Remove this once incremental loading is fixed.
 BASE_FEATURE(kPdfIncrementalLoading,
              "PdfIncrementalLoading",
              base::FEATURE_DISABLED_BY_DEFAULT);
 
+// Splits the time of each round of progressive rendering evenly between the
+// visible pages that need painting, so they fill in together.
+BASE_FEATURE(kPdfInterleavedPageRendering,
+             "PdfInterleavedPageRendering",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Paints a quick low-resolution rendering of pages as they enter the viewport,
+// before rendering them at full quality.
+BASE_FEATURE(kPdfLowResolutionPlaceholders,
+             "PdfLowResolutionPlaceholders",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Fetches scattered ranges of partially loaded PDFs with a single multi-range
+// request, rather than one request per range. Has no effect unless
+// kPdfPartialLoading is enabled too.
+BASE_FEATURE(kPdfMultiRangeRequests,
+             "PdfMultiRangeRequests",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Parses non-linearized PDFs as they load, like linearized ones, instead of
+// waiting for the whole file. PDFium then requests the trailer, the
+// cross-reference table and the objects of the visible pages ahead of the
+// rest. Has no effect unless kPdfIncrementalLoading is enabled too.
+BASE_FEATURE(kPdfNonLinearizedReadAhead,
+             "PdfNonLinearizedReadAhead",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
 BASE_FEATURE(kPdfOopif, "PdfOopif", base::FEATURE_DISABLED_BY_DEFAULT);
 
+// Paints directly into the pixels of the surface that gets flushed, instead of
+// into a separate image that gets copied onto the surface afterwards.
+BASE_FEATURE(kPdfPaintInPlace,
+             "PdfPaintInPlace",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Once the text of every page is indexed, matches find queries against it on
+// the thread pool, in shards of pages that search in parallel. Has no effect
+// unless kPdfFindTextIndex is enabled too.
+BASE_FEATURE(kPdfParallelFind,
+             "PdfParallelFind",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Fetches scattered ranges of partially loaded PDFs over several connections at
+// once, rather than one range after another. Has no effect unless
+// kPdfPartialLoading is enabled too.
+BASE_FEATURE(kPdfParallelRangeLoading,
+             "PdfParallelRangeLoading",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
 // "Partial loading" refers to loading only specific parts of the PDF.
 // TODO(crbug.com/40123601): Remove this once partial loading is fixed.
 BASE_FEATURE(kPdfPartialLoading,
@@ -33,6 +122,24 @@ BASE_FEATURE(kPdfPartialLoading,
 
 BASE_FEATURE(kPdfPortfolio, "PdfPortfolio", base::FEATURE_DISABLED_BY_DEFAULT);
 
+// Renders pages ahead of the viewport in the scroll direction into the rendered
+// tile cache while idle. Has no effect unless kPdfTileCache is enabled too.
+BASE_FEATURE(kPdfPrefetchRendering,
+             "PdfPrefetchRendering",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
+// Caches rendered page regions so they can be copied instead of rendered again
+// when they get repainted, e.g. when scrolling back or toggling zoom.
+BASE_FEATURE(kPdfTileCache, "PdfTileCache", base::FEATURE_DISABLED_BY_DEFAULT);
+
+// "Tiled rendering" refers to rendering dirty page regions as fixed-size tiles,
+// so partially rendered pages can be shown before the whole region finishes.
+// Finished tiles get flushed right away, except when painting in place after
+// the first paint, where they wait for the rest of the region.
+BASE_FEATURE(kPdfTiledRendering,
+             "PdfTiledRendering",
+             base::FEATURE_DISABLED_BY_DEFAULT);
+
 BASE_FEATURE(kPdfUseSkiaRenderer,
              "PdfUseSkiaRenderer",
              base::FEATURE_DISABLED_BY_DEFAULT);
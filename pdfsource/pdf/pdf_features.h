@@ -16,10 +16,26 @@ static_assert(BUILDFLAG(ENABLE_PDF), "ENABLE_PDF not set to true");
 namespace chrome_pdf::features {
 
 BASE_DECLARE_FEATURE(kAccessiblePDFForm);
+BASE_DECLARE_FEATURE(kPdfAdaptivePaintScheduling);
+BASE_DECLARE_FEATURE(kPdfAdaptiveRequestSize);
+BASE_DECLARE_FEATURE(kPdfBatchedFindUpdates);
+BASE_DECLARE_FEATURE(kPdfContiguousDocumentData);
+BASE_DECLARE_FEATURE(kPdfCrossPageFind);
+BASE_DECLARE_FEATURE(kPdfFindTextIndex);
 BASE_DECLARE_FEATURE(kPdfIncrementalLoading);
+BASE_DECLARE_FEATURE(kPdfInterleavedPageRendering);
+BASE_DECLARE_FEATURE(kPdfLowResolutionPlaceholders);
+BASE_DECLARE_FEATURE(kPdfMultiRangeRequests);
+BASE_DECLARE_FEATURE(kPdfNonLinearizedReadAhead);
 BASE_DECLARE_FEATURE(kPdfOopif);
+BASE_DECLARE_FEATURE(kPdfPaintInPlace);
+BASE_DECLARE_FEATURE(kPdfParallelFind);
+BASE_DECLARE_FEATURE(kPdfParallelRangeLoading);
 BASE_DECLARE_FEATURE(kPdfPartialLoading);
 BASE_DECLARE_FEATURE(kPdfPortfolio);
+BASE_DECLARE_FEATURE(kPdfPrefetchRendering);
+BASE_DECLARE_FEATURE(kPdfTileCache);
+BASE_DECLARE_FEATURE(kPdfTiledRendering);
 BASE_DECLARE_FEATURE(kPdfUseSkiaRenderer);
 BASE_DECLARE_FEATURE(kPdfXfaSupport);
 
@@ -23,6 +23,7 @@
 #include "base/check_op.h"
 #include "base/containers/fixed_flat_map.h"
 #include "base/containers/queue.h"
+#include "base/containers/span.h"
 #include "base/debug/crash_logging.h"
 #include "base/feature_list.h"
 #include "base/functional/bind.h"
@@ -832,6 +833,7 @@ void PdfViewWebPlugin::Invalidate(const gfx::Rect& rect) {
 }
 
 void PdfViewWebPlugin::DidScroll(const gfx::Vector2d& offset) {
+  UpdatePaintAffinityRects();
   if (!image_data_.drawsNothing())
     paint_manager_.ScrollRect(available_area_, offset);
 }
@@ -1103,6 +1105,10 @@ std::unique_ptr<UrlLoader> PdfViewWebPlugin::CreateUrlLoader() {
   return std::make_unique<UrlLoader>(weak_factory_.GetWeakPtr());
 }
 
+AsyncDocumentCache* PdfViewWebPlugin::GetDocumentCache() {
+  return client_->GetDocumentCache();
+}
+
 v8::Isolate* PdfViewWebPlugin::GetIsolate() {
   return client_->GetIsolate();
 }
@@ -1693,9 +1699,14 @@ void PdfViewWebPlugin::SaveToBuffer(const std::string& token) {
 #if BUILDFLAG(ENABLE_INK)
     uint32_t length = engine_->GetLoadedByteSize();
     if (IsSaveDataSizeValid(length)) {
-      base::Value::BlobStorage data(length);
-      if (engine_->ReadLoadedBytes(length, data.data()))
-        data_to_save = base::Value(std::move(data));
+      base::span<const uint8_t> loaded_bytes = engine_->GetLoadedBytes();
+      if (!loaded_bytes.empty()) {
+        data_to_save = base::Value(loaded_bytes);
+      } else {
+        base::Value::BlobStorage data(length);
+        if (engine_->ReadLoadedBytes(length, data.data()))
+          data_to_save = base::Value(std::move(data));
+      }
     }
 #else
     NOTREACHED_IN_MIGRATION();
@@ -1752,34 +1763,60 @@ void PdfViewWebPlugin::DoPaint(const std::vector<gfx::Rect>& paint_rects,
     return;
   }
 
+  // Paint straight into the pixels of the `PaintManager`'s surface when
+  // possible, so the ready rects need not copy them.
+  if (paint_manager_.paints_in_place() &&
+      paint_manager_.surface_bitmap().dimensions() ==
+          image_data_.dimensions()) {
+    image_data_ = paint_manager_.surface_bitmap();
+  }
+
   PrepareForFirstPaint(ready);
 
   if (!received_viewport_message_ || !needs_reraster_)
     return;
 
-  engine_->PrePaint();
-
-  std::vector<gfx::Rect> ready_rects;
+  // Intersect with plugin area since there could be pending invalidates from
+  // when the plugin area was larger.
+  std::vector<gfx::Rect> rects;
+  std::vector<gfx::Rect> pdf_rects;
   for (const gfx::Rect& paint_rect : paint_rects) {
-    // Intersect with plugin area since there could be pending invalidates from
-    // when the plugin area was larger.
     gfx::Rect rect =
         gfx::IntersectRects(paint_rect, gfx::Rect(plugin_rect_.size()));
     if (rect.IsEmpty())
       continue;
 
-    // Paint the rendering of the PDF document.
+    rects.push_back(rect);
     gfx::Rect pdf_rect = gfx::IntersectRects(rect, available_area_);
-    if (!pdf_rect.IsEmpty()) {
+    if (!pdf_rect.IsEmpty())
       pdf_rect.Offset(-available_area_.x(), 0);
+    pdf_rects.push_back(pdf_rect);
+  }
+
+  // Let the engine plan the whole round of paints before it starts.
+  engine_->PrePaint(pdf_rects);
+
+  std::vector<gfx::Rect> ready_rects;
+  std::vector<gfx::Rect> ready_now_rects;
+  for (size_t i = 0; i < rects.size(); ++i) {
+    const gfx::Rect& rect = rects[i];
 
+    // Paint the rendering of the PDF document.
+    const gfx::Rect& pdf_rect = pdf_rects[i];
+    if (!pdf_rect.IsEmpty()) {
       std::vector<gfx::Rect> pdf_ready;
+      std::vector<gfx::Rect> pdf_ready_now;
       std::vector<gfx::Rect> pdf_pending;
-      engine_->Paint(pdf_rect, image_data_, pdf_ready, pdf_pending);
+      engine_->Paint(pdf_rect, image_data_, pdf_ready, pdf_ready_now,
+                     pdf_pending);
       for (gfx::Rect& ready_rect : pdf_ready) {
         ready_rect.Offset(available_area_.OffsetFromOrigin());
         ready_rects.push_back(ready_rect);
       }
+      for (gfx::Rect& ready_rect : pdf_ready_now) {
+        ready_rect.Offset(available_area_.OffsetFromOrigin());
+        ready_now_rects.push_back(ready_rect);
+      }
       for (gfx::Rect& pending_rect : pdf_pending) {
         pending_rect.Offset(available_area_.OffsetFromOrigin());
         pending.push_back(pending_rect);
@@ -1811,11 +1848,15 @@ void PdfViewWebPlugin::DoPaint(const std::vector<gfx::Rect>& paint_rects,
 
   engine_->PostPaint();
 
-  // TODO(crbug.com/40203030): Write pixels directly to the `SkSurface` in
-  // `PaintManager`, rather than using an intermediate `SkBitmap` and `SkImage`.
-  sk_sp<SkImage> painted_image = image_data_.asImage();
+  sk_sp<SkImage> painted_image;
+  if ((!ready_rects.empty() || !ready_now_rects.empty()) && !PaintsInPlace())
+    painted_image = image_data_.asImage();
   for (const gfx::Rect& ready_rect : ready_rects)
-    ready.emplace_back(ready_rect, painted_image);
+    ready.push_back(MakePaintReadyRect(ready_rect, painted_image));
+  for (const gfx::Rect& ready_rect : ready_now_rects) {
+    ready.push_back(
+        MakePaintReadyRect(ready_rect, painted_image, /*flush_now=*/true));
+  }
 
   InvalidateAfterPaintDone();
 }
@@ -1828,8 +1869,25 @@ void PdfViewWebPlugin::PrepareForFirstPaint(
   // Fill the image data buffer with the background color.
   first_paint_ = false;
   image_data_.eraseColor(background_color_);
-  ready.emplace_back(gfx::SkIRectToRect(image_data_.bounds()),
-                     image_data_.asImage(), /*flush_now=*/true);
+  ready.push_back(MakePaintReadyRect(
+      gfx::SkIRectToRect(image_data_.bounds()),
+      PaintsInPlace() ? nullptr : image_data_.asImage(), /*flush_now=*/true));
+}
+
+bool PdfViewWebPlugin::PaintsInPlace() const {
+  return paint_manager_.paints_in_place() &&
+         image_data_.pixelRef() == paint_manager_.surface_bitmap().pixelRef();
+}
+
+PaintReadyRect PdfViewWebPlugin::MakePaintReadyRect(
+    const gfx::Rect& rect,
+    const sk_sp<SkImage>& painted_image,
+    bool flush_now) const {
+  if (PaintsInPlace())
+    return PaintReadyRect(rect, flush_now);
+
+  DCHECK(painted_image);
+  return PaintReadyRect(rect, painted_image, flush_now);
 }
 
 void PdfViewWebPlugin::OnGeometryChanged(double old_zoom,
@@ -1863,6 +1921,18 @@ void PdfViewWebPlugin::RecalculateAreas(double old_zoom,
 
   engine_->PageOffsetUpdated(available_area_.OffsetFromOrigin());
   engine_->PluginSizeUpdated(available_area_.size());
+  UpdatePaintAffinityRects();
+}
+
+void PdfViewWebPlugin::UpdatePaintAffinityRects() {
+  // The engine renders each page as a separate job. Only ask for the visible
+  // pages, since this runs for every scroll, regardless of the page count.
+  std::vector<gfx::Rect> page_rects;
+  for (int page_index : engine_->GetVisiblePages()) {
+    page_rects.push_back(engine_->GetPageScreenRect(page_index) +
+                         available_area_.OffsetFromOrigin());
+  }
+  paint_manager_.SetPaintAffinityRects(std::move(page_rects));
 }
 
 void PdfViewWebPlugin::CalculateBackgroundParts() {
@@ -27,6 +27,7 @@
 #include "pdf/loader/url_loader.h"
 #include "pdf/mojom/pdf.mojom.h"
 #include "pdf/paint_manager.h"
+#include "pdf/paint_ready_rect.h"
 #include "pdf/pdf_accessibility_action_handler.h"
 #include "pdf/pdf_accessibility_image_fetcher.h"
 #include "pdf/pdf_engine.h"
@@ -42,6 +43,8 @@
 #include "third_party/blink/public/web/web_print_params.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
 #include "ui/base/cursor/mojom/cursor_type.mojom-shared.h"
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
@@ -76,6 +79,7 @@ class MetafileSkia;
 
 namespace chrome_pdf {
 
+class AsyncDocumentCache;
 class MetricsHandler;
 class PDFiumEngine;
 class PdfAccessibilityDataHandler;
@@ -223,6 +227,10 @@ class PdfViewWebPlugin final : public PDFEngine::Client,
     // Prints the plugin element.
     virtual void Print() {}
 
+    // Returns the cache to keep downloaded documents in, if the client can
+    // provide one. It must outlive the plugin.
+    virtual AsyncDocumentCache* GetDocumentCache() { return nullptr; }
+
     // Sends over a string to be recorded by user metrics as a computed action.
     // When you use this, you need to also update the rules for extracting known
     // actions in tools/metrics/actions/extract_actions.py.
@@ -343,6 +351,7 @@ class PdfViewWebPlugin final : public PDFEngine::Client,
                   const void* data,
                   int length) override;
   std::unique_ptr<UrlLoader> CreateUrlLoader() override;
+  AsyncDocumentCache* GetDocumentCache() override;
   v8::Isolate* GetIsolate() override;
   std::vector<SearchStringResult> SearchString(const char16_t* string,
                                                const char16_t* term,
@@ -535,6 +544,17 @@ class PdfViewWebPlugin final : public PDFEngine::Client,
   // time.
   void PrepareForFirstPaint(std::vector<PaintReadyRect>& ready);
 
+  // Returns whether the image data buffer shares its pixels with the
+  // `PaintManager`'s surface.
+  bool PaintsInPlace() const;
+
+  // Returns a ready rect for `rect` of the image data buffer. The rect refers
+  // to the painted pixels in place if PaintsInPlace(), or to `painted_image`
+  // otherwise.
+  PaintReadyRect MakePaintReadyRect(const gfx::Rect& rect,
+                                    const sk_sp<SkImage>& painted_image,
+                                    bool flush_now = false) const;
+
   // Updates the available area and the background parts, notifies the PDF
   // engine, and updates the accessibility information.
   void OnGeometryChanged(double old_zoom, float old_device_scale);
@@ -543,6 +563,10 @@ class PdfViewWebPlugin final : public PDFEngine::Client,
   // the background parts, and notifies the PDF engine of geometry changes.
   void RecalculateAreas(double old_zoom, float old_device_scale);
 
+  // Tells `paint_manager_` where the visible pages are, so it can group dirty
+  // rects by page.
+  void UpdatePaintAffinityRects();
+
   // Figures out the location of any background rectangles (i.e. those that
   // aren't painted by the PDF engine).
   void CalculateBackgroundParts();
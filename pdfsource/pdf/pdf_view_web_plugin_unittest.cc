@@ -1214,10 +1214,12 @@ TEST_F(PdfViewWebPluginTest, OnPaintWithMultiplePaintRects) {
                                      gfx::Rect(0, 0, 40, 40));
 
   EXPECT_CALL(*engine_ptr_, Paint)
-      .WillRepeatedly(
-          [](const gfx::Rect& rect, SkBitmap& /*image_data*/,
-             std::vector<gfx::Rect>& ready,
-             std::vector<gfx::Rect>& /*pending*/) { ready.push_back(rect); });
+      .WillRepeatedly([](const gfx::Rect& rect, SkBitmap& /*image_data*/,
+                         std::vector<gfx::Rect>& ready,
+                         std::vector<gfx::Rect>& /*ready_now*/,
+                         std::vector<gfx::Rect>& /*pending*/) {
+        ready.push_back(rect);
+      });
   std::vector<PaintReadyRect> ready;
   std::vector<gfx::Rect> pending;
   plugin_->OnPaint(
@@ -1243,6 +1245,33 @@ TEST_F(PdfViewWebPluginTest, OnPaintWithMultiplePaintRects) {
   EXPECT_EQ(&ready[1].image(), &ready[2].image());
 }
 
+TEST_F(PdfViewWebPluginTest, OnPaintWithReadyNowRects) {
+  SetDocumentDimensions({100, 200});
+  UpdatePluginGeometryWithoutWaiting(/*device_scale=*/1.0f,
+                                     gfx::Rect(0, 0, 40, 40));
+
+  // The engine shows a placeholder right away, while the rest of the rect is
+  // still rendering.
+  EXPECT_CALL(*engine_ptr_, Paint)
+      .WillOnce([](const gfx::Rect& rect, SkBitmap& /*image_data*/,
+                   std::vector<gfx::Rect>& /*ready*/,
+                   std::vector<gfx::Rect>& ready_now,
+                   std::vector<gfx::Rect>& pending) {
+        ready_now.push_back(rect);
+        pending.push_back(rect);
+      });
+  std::vector<PaintReadyRect> ready;
+  std::vector<gfx::Rect> pending;
+  plugin_->OnPaint(/*paint_rects=*/{gfx::Rect(5, 5, 10, 10)}, ready, pending);
+
+  // Expect the initial background-clearing paint, and the placeholder, which
+  // both get flushed right away.
+  ASSERT_THAT(ready, SizeIs(2));
+  EXPECT_EQ(gfx::Rect(5, 5, 10, 10), ready[1].rect());
+  EXPECT_TRUE(ready[1].flush_now());
+  EXPECT_THAT(pending, ElementsAre(gfx::Rect(5, 5, 10, 10)));
+}
+
 TEST_F(PdfViewWebPluginTest, UpdateLayerTransformWithIdentity) {
   plugin_->UpdateLayerTransform(1.0f, gfx::Vector2dF());
   TestPaintSnapshots(/*device_scale=*/4.0f,
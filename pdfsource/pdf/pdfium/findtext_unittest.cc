@@ -3,17 +3,24 @@
 // found in the LICENSE file.
 
 #include <optional>
+#include <string>
 
 #include "base/check_op.h"
+#include "base/run_loop.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/test/gmock_callback_support.h"
+#include "base/test/scoped_feature_list.h"
 #include "pdf/document_layout.h"
+#include "pdf/pdf_features.h"
 #include "pdf/pdfium/pdfium_engine.h"
 #include "pdf/pdfium/pdfium_test_base.h"
 #include "pdf/test/test_client.h"
 #include "testing/gmock/include/gmock/gmock.h"
 
 using testing::_;
+using testing::EndsWith;
 using testing::InSequence;
+using testing::StartsWith;
 
 namespace chrome_pdf {
 
@@ -240,6 +247,286 @@ TEST_P(FindTextTest, SelectFindResultAndSwitchToTwoUpView) {
   ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
 }
 
+TEST_P(FindTextTest, FindTextWithBatchedUpdates) {
+  base::test::ScopedFeatureList scoped_feature_list(
+      features::kPdfBatchedFindUpdates);
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The count comes once per page, with the last page's in the final
+  // notification.
+  {
+    InSequence sequence;
+
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(5, /*final_result=*/false));
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(10, /*final_result=*/true));
+  }
+  engine->StartFind(u"o", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Without results, only the final notification comes.
+  ExpectInitialSearchResults(client, 0);
+  engine->StartFind(u"xyz", /*case_sensitive=*/true);
+}
+
+TEST_P(FindTextTest, FindTextWithTextIndex) {
+  base::test::ScopedFeatureList scoped_feature_list(
+      features::kPdfFindTextIndex);
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  ExpectInitialSearchResults(client, 10);
+  engine->StartFind(u"o", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Select the "o" in "Hello" on the first page, so the next search starts
+  // from there and wraps around to the start of the first page.
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // The second search uses the text of the pages the first one indexed, and
+  // finds the same matches as searching the pages would.
+  ExpectInitialSearchResults(client, 4);
+  engine->StartFind(u"world", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  ExpectInitialSearchResults(client, 2);
+  engine->StartFind(u"Hello", /*case_sensitive=*/true);
+}
+
+TEST_P(FindTextTest, RefineFindWhenTextIsExtended) {
+  base::test::ScopedFeatureList scoped_feature_list(
+      features::kPdfFindTextIndex);
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  ExpectInitialSearchResults(client, 10);
+  engine->StartFind(u"o", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Extending the text narrows down the previous results in one go.
+  EXPECT_CALL(client, NotifyNumberOfFindResultsChanged(_, false)).Times(0);
+  EXPECT_CALL(client,
+              NotifyNumberOfFindResultsChanged(4, /*final_result=*/true));
+  engine->StartFind(u"or", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  EXPECT_CALL(client, NotifyNumberOfFindResultsChanged(_, false)).Times(0);
+  EXPECT_CALL(client,
+              NotifyNumberOfFindResultsChanged(4, /*final_result=*/true));
+  engine->StartFind(u"orld!", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // The results cover the whole extended text.
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  EXPECT_EQ("orld!", engine->GetSelectedText());
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Other text needs a new search.
+  ExpectInitialSearchResults(client, 2);
+  engine->StartFind(u"Good", /*case_sensitive=*/true);
+}
+
+TEST_P(FindTextTest, FindTextWhenOverlappingTextIsExtended) {
+  base::test::ScopedFeatureList scoped_feature_list(
+      features::kPdfFindTextIndex);
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("repeated_text.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The page says "aaab". Matches do not overlap, so "aa" only matches once.
+  ExpectInitialSearchResults(client, 1);
+  engine->StartFind(u"aa", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // "aab" matches inside the skipped second match of "aa", so extending the
+  // text searches the page again.
+  ExpectInitialSearchResults(client, 1);
+  engine->StartFind(u"aab", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  EXPECT_EQ("aab", engine->GetSelectedText());
+}
+
+TEST_P(FindTextTest, FindTextFromSelectionOverlappingEarlierMatch) {
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("repeated_text.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The page says "aaab".
+  ExpectInitialSearchResults(client, 3);
+  engine->StartFind(u"a", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Select the second "a", so the next search starts from there.
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(1, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // "aa" matches from the selection, even though searching the whole page
+  // would match the "aa" before it instead.
+  ExpectInitialSearchResults(client, 1);
+  engine->StartFind(u"aa", /*case_sensitive=*/true);
+}
+
+TEST_P(FindTextTest, FindTextAcrossPages) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfCrossPageFind, features::kPdfFindTextIndex}, {});
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The first page ends with "world!", and the second one starts with "Hello".
+  // Matches across pages come in from the thread pool once every page has
+  // been searched.
+  base::RunLoop run_loop;
+  {
+    InSequence sequence;
+
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(1, /*final_result=*/false));
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(1, /*final_result=*/true))
+        .WillOnce(base::test::RunClosure(run_loop.QuitClosure()));
+  }
+  engine->StartFind(u"world! Hello", /*case_sensitive=*/true);
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Selecting the result selects its parts on both pages.
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  std::string selected_text = engine->GetSelectedText();
+  EXPECT_THAT(selected_text, StartsWith("world!"));
+  EXPECT_THAT(selected_text, EndsWith("Hello"));
+}
+
+TEST_P(FindTextTest, FindTextAcrossPagesWhenTextIsExtended) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfCrossPageFind, features::kPdfFindTextIndex}, {});
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  base::RunLoop run_loop;
+  EXPECT_CALL(client, NotifyNumberOfFindResultsChanged(_, false))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(client,
+              NotifyNumberOfFindResultsChanged(4, /*final_result=*/true))
+      .WillOnce(base::test::RunClosure(run_loop.QuitClosure()));
+  engine->StartFind(u"world!", /*case_sensitive=*/true);
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Extending the text searches the document again, instead of narrowing down
+  // the previous results within their pages, so the match that continues on
+  // the next page still comes in.
+  base::RunLoop second_run_loop;
+  EXPECT_CALL(client, NotifyNumberOfFindResultsChanged(_, false))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(client,
+              NotifyNumberOfFindResultsChanged(1, /*final_result=*/true))
+      .WillOnce(base::test::RunClosure(second_run_loop.QuitClosure()));
+  engine->StartFind(u"world! Hello", /*case_sensitive=*/true);
+  second_run_loop.Run();
+}
+
+TEST_P(FindTextTest, FindTextAcrossPagesOverlappingMatchOnPage) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfCrossPageFind, features::kPdfFindTextIndex}, {});
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("overlapping_text_across_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The pages say "x a" and "a a". The match across the pages overlaps the
+  // match on the second page, so only the latter counts.
+  base::RunLoop run_loop;
+  EXPECT_CALL(client, NotifyNumberOfFindResultsChanged(_, false))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(client,
+              NotifyNumberOfFindResultsChanged(1, /*final_result=*/true))
+      .WillOnce(base::test::RunClosure(run_loop.QuitClosure()));
+  engine->StartFind(u"a a", /*case_sensitive=*/true);
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  EXPECT_CALL(client, NotifySelectedFindResultChanged(0, _));
+  ASSERT_TRUE(engine->SelectFindResult(/*forward=*/true));
+  EXPECT_EQ("a a", engine->GetSelectedText());
+}
+
+TEST_P(FindTextTest, FindTextInParallel) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfFindTextIndex, features::kPdfParallelFind}, {});
+  FindTextTestClient client(/*expected_case_sensitive=*/true);
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("hello_world2.pdf"));
+  ASSERT_TRUE(engine);
+
+  // The first search goes one page at a time, and indexes every page.
+  ExpectInitialSearchResults(client, 10);
+  engine->StartFind(u"o", /*case_sensitive=*/true);
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Searches of the indexed document finish on the thread pool, and still add
+  // the results one at a time.
+  base::RunLoop run_loop;
+  {
+    InSequence sequence;
+
+    for (int i = 1; i < 5; ++i) {
+      EXPECT_CALL(client,
+                  NotifyNumberOfFindResultsChanged(i, /*final_result=*/false));
+    }
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(4, /*final_result=*/true))
+        .WillOnce(base::test::RunClosure(run_loop.QuitClosure()));
+  }
+  engine->StartFind(u"world", /*case_sensitive=*/true);
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(&client);
+
+  // Starting another search drops the results of the one in progress.
+  base::RunLoop second_run_loop;
+  {
+    InSequence sequence;
+
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(1, /*final_result=*/false));
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(2, /*final_result=*/false));
+    EXPECT_CALL(client,
+                NotifyNumberOfFindResultsChanged(2, /*final_result=*/true))
+        .WillOnce(base::test::RunClosure(second_run_loop.QuitClosure()));
+  }
+  engine->StartFind(u"Hello", /*case_sensitive=*/true);
+  engine->StartFind(u"Goodbye", /*case_sensitive=*/true);
+  second_run_loop.Run();
+}
+
 INSTANTIATE_TEST_SUITE_P(All, FindTextTest, testing::Bool());
 
 }  // namespace chrome_pdf
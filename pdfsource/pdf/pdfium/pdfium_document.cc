@@ -4,9 +4,12 @@
 
 #include "pdf/pdfium/pdfium_document.h"
 
+#include <stdint.h>
+
 #include <utility>
 
 #include "base/check.h"
+#include "base/containers/span.h"
 #include "base/memory/raw_ptr.h"
 #include "pdf/loader/document_loader.h"
 
@@ -107,8 +110,16 @@ void PDFiumDocument::LoadDocument(const std::string& password) {
   const char* password_cstr = password.empty() ? nullptr : password.c_str();
   if (doc_loader_->IsDocumentComplete() &&
       !FPDFAvail_IsLinearized(fpdf_availability_.get())) {
-    doc_handle_.reset(
-        FPDF_LoadCustomDocument(file_access_.get(), password_cstr));
+    // Let PDFium parse the document in place if the loader holds it in one
+    // piece, rather than copying it out block by block.
+    base::span<const uint8_t> data = doc_loader_->GetCompleteData();
+    if (!data.empty()) {
+      doc_handle_.reset(
+          FPDF_LoadMemDocument64(data.data(), data.size(), password_cstr));
+    } else {
+      doc_handle_.reset(
+          FPDF_LoadCustomDocument(file_access_.get(), password_cstr));
+    }
   } else {
     doc_handle_.reset(
         FPDFAvail_GetDocument(fpdf_availability_.get(), password_cstr));
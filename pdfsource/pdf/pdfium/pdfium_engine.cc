@@ -14,8 +14,10 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <utility>
@@ -35,6 +37,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/task/thread_pool.h"
 #include "base/time/time.h"
 #include "base/types/optional_util.h"
 #include "build/build_config.h"
@@ -44,6 +47,7 @@
 #include "gin/public/v8_platform.h"
 #include "pdf/accessibility_structs.h"
 #include "pdf/draw_utils/coordinates.h"
+#include "pdf/draw_utils/highlight.h"
 #include "pdf/draw_utils/shadow.h"
 #include "pdf/input_utils.h"
 #include "pdf/loader/document_loader_impl.h"
@@ -56,6 +60,7 @@
 #include "pdf/pdfium/pdfium_document_metadata.h"
 #include "pdf/pdfium/pdfium_mem_buffer_file_write.h"
 #include "pdf/pdfium/pdfium_permissions.h"
+#include "pdf/pdfium/pdfium_text_matcher.h"
 #include "pdf/pdfium/pdfium_unsupported_features.h"
 #include "printing/mojom/print.mojom-shared.h"
 #include "printing/units.h"
@@ -76,7 +81,11 @@
 #include "third_party/pdfium/public/fpdf_searchex.h"
 #include "third_party/pdfium/public/fpdfview.h"
 #include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSamplingOptions.h"
 #include "ui/base/cursor/mojom/cursor_type.mojom-shared.h"
 #include "ui/base/window_open_disposition_utils.h"
 #include "ui/events/keycodes/keyboard_codes.h"
@@ -86,6 +95,7 @@
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/rect_f.h"
 #include "ui/gfx/geometry/size.h"
+#include "ui/gfx/geometry/skia_conversions.h"
 #include "ui/gfx/geometry/vector2d.h"
 #include "v8/include/v8.h"
 
@@ -148,6 +158,67 @@ constexpr base::TimeDelta kMaxProgressivePaintTime = base::Milliseconds(300);
 constexpr base::TimeDelta kMaxInitialProgressivePaintTime =
     base::Milliseconds(250);
 
+// The edge length of the square tiles that dirty page regions are split into
+// when tiled rendering is enabled. Small enough that a single tile of a complex
+// page renders within one frame, large enough to keep per-tile overhead (form
+// drawing, shadows, selections) low.
+constexpr int kRenderTileSize = 256;
+
+// The memory budget for cached rendered tiles when the tile cache is enabled.
+// Enough for a few screenfuls of pages at typical zoom levels.
+constexpr size_t kMaxRenderedTileCacheSizeInBytes = 64 * 1024 * 1024;
+
+// The scale, relative to the size of the page on screen, at which
+// low-resolution page placeholders are rendered.
+constexpr float kPlaceholderScale = 0.25f;
+
+// How long rendering a placeholder takes in one go before the round of paints
+// moves on.
+constexpr base::TimeDelta kPlaceholderRenderTime = base::Milliseconds(4);
+
+// How long prefetching renders in one go before yielding to other tasks.
+constexpr base::TimeDelta kPrefetchRenderTime = base::Milliseconds(10);
+
+// The maximum number of pages ahead of the viewport to prefetch.
+constexpr int kMaxPrefetchPages = 3;
+
+// The maximum size of the tiles queued for prefetching. A fraction of the tile
+// cache budget, so prefetching does not evict the tiles around the viewport.
+constexpr size_t kMaxPrefetchSizeInBytes = kMaxRenderedTileCacheSizeInBytes / 4;
+
+// With adaptive paint scheduling, how long a round of paints may take while the
+// user scrolls or zooms: a frame at 60 fps, minus headroom for compositing.
+constexpr base::TimeDelta kInteractivePaintFrameBudget =
+    base::Milliseconds(12);
+
+// With adaptive paint scheduling, how long a round of paints may take while the
+// user is idle. Long enough to keep the overhead of each round low, and short
+// enough that input arriving during a round is not noticeably delayed.
+constexpr base::TimeDelta kIdlePaintFrameBudget = base::Milliseconds(50);
+
+// How long after the last scroll or zoom paints still get the interactive
+// frame budget.
+constexpr base::TimeDelta kInteractivePaintWindow = base::Milliseconds(250);
+
+// The shortest slice a progressive paint gets, so it keeps making progress even
+// once the frame budget is used up.
+constexpr base::TimeDelta kMinProgressivePaintTime = base::Milliseconds(4);
+
+// How much longer than the frame budget a progressive paint may run, if its
+// page's render cost suggests that lets it finish rather than take another
+// round of paints.
+constexpr base::TimeDelta kMaxProgressivePaintOvershoot =
+    base::Milliseconds(4);
+
+// How long find searches pages from the text index in one go before yielding
+// to other tasks.
+constexpr base::TimeDelta kFindTimePerTask = base::Milliseconds(10);
+
+// How many pages one thread pool task searches in a parallel find. Small enough
+// that the first results come in quickly, and that long documents split into
+// enough shards to keep all cores busy.
+constexpr size_t kPagesPerFindShard = 16;
+
 FontMappingMode g_font_mapping_mode = FontMappingMode::kNoMapping;
 
 template <class S>
@@ -350,31 +421,6 @@ std::string ConvertViewIntToViewString(unsigned long view_int) {
   }
 }
 
-// Simplify to \" for searching
-constexpr wchar_t kHebrewPunctuationGershayimCharacter = 0x05F4;
-constexpr wchar_t kLeftDoubleQuotationMarkCharacter = 0x201C;
-constexpr wchar_t kRightDoubleQuotationMarkCharacter = 0x201D;
-
-// Simplify \' for searching
-constexpr wchar_t kHebrewPunctuationGereshCharacter = 0x05F3;
-constexpr wchar_t kLeftSingleQuotationMarkCharacter = 0x2018;
-constexpr wchar_t kRightSingleQuotationMarkCharacter = 0x2019;
-
-wchar_t SimplifyForSearch(wchar_t c) {
-  switch (c) {
-    case kHebrewPunctuationGershayimCharacter:
-    case kLeftDoubleQuotationMarkCharacter:
-    case kRightDoubleQuotationMarkCharacter:
-      return L'\"';
-    case kHebrewPunctuationGereshCharacter:
-    case kLeftSingleQuotationMarkCharacter:
-    case kRightSingleQuotationMarkCharacter:
-      return L'\'';
-    default:
-      return c;
-  }
-}
-
 FocusObjectType GetAnnotationFocusType(FPDF_ANNOTATION_SUBTYPE annot_type) {
   switch (annot_type) {
     case FPDF_ANNOT_LINK:
@@ -561,6 +607,34 @@ PDFiumEngine::PDFiumEngine(PDFEngine::Client* client,
   IFSDK_PAUSE::version = 1;
   IFSDK_PAUSE::user = nullptr;
   IFSDK_PAUSE::NeedToPauseNow = Pause_NeedToPauseNow;
+
+  adaptive_paint_scheduling_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfAdaptivePaintScheduling);
+  interleaved_page_rendering_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfInterleavedPageRendering);
+  tiled_rendering_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfTiledRendering);
+  placeholders_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfLowResolutionPlaceholders);
+  if (base::FeatureList::IsEnabled(features::kPdfTileCache)) {
+    rendered_tile_cache_ =
+        std::make_unique<RenderedTileCache>(kMaxRenderedTileCacheSizeInBytes);
+  }
+  prefetch_enabled_ =
+      rendered_tile_cache_ &&
+      base::FeatureList::IsEnabled(features::kPdfPrefetchRendering);
+  read_ahead_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfNonLinearizedReadAhead);
+  batch_find_updates_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfBatchedFindUpdates);
+  find_text_index_enabled_ =
+      base::FeatureList::IsEnabled(features::kPdfFindTextIndex);
+  cross_page_find_enabled_ =
+      find_text_index_enabled_ &&
+      base::FeatureList::IsEnabled(features::kPdfCrossPageFind);
+  parallel_find_enabled_ =
+      find_text_index_enabled_ &&
+      base::FeatureList::IsEnabled(features::kPdfParallelFind);
 }
 
 PDFiumEngine::~PDFiumEngine() {
@@ -583,6 +657,14 @@ void PDFiumEngine::SetDocumentLoaderForTesting(
   doc_loader_set_for_testing_ = true;
 }
 
+size_t PDFiumEngine::GetCachedTileCountForTesting() const {
+  return rendered_tile_cache_ ? rendered_tile_cache_->size() : 0;
+}
+
+base::TimeDelta PDFiumEngine::GetProgressivePaintTimeoutForTesting() const {
+  return progressive_paint_timeout_;
+}
+
 // static
 FontMappingMode PDFiumEngine::GetFontMappingMode() {
   return g_font_mapping_mode;
@@ -594,6 +676,7 @@ void PDFiumEngine::PageOffsetUpdated(const gfx::Vector2d& page_offset) {
 
 void PDFiumEngine::PluginSizeUpdated(const gfx::Size& size) {
   CancelPaints();
+  CancelPrefetch();
 
   plugin_size_ = size;
   CalculateVisiblePages();
@@ -613,6 +696,7 @@ void PDFiumEngine::PluginSizeUpdated(const gfx::Size& size) {
 
 void PDFiumEngine::ScrolledToXPosition(int position) {
   CancelPaints();
+  last_interaction_time_ = base::TimeTicks::Now();
 
   gfx::Vector2d diff(position_.x() - position, 0);
   position_.set_x(position);
@@ -627,6 +711,7 @@ void PDFiumEngine::ScrolledToXPosition(int position) {
 
 void PDFiumEngine::ScrolledToYPosition(int position) {
   CancelPaints();
+  last_interaction_time_ = base::TimeTicks::Now();
 
   gfx::Vector2d diff(0, position_.y() - position);
   position_.set_y(position);
@@ -637,16 +722,38 @@ void PDFiumEngine::ScrolledToYPosition(int position) {
   client_->CaretChanged(caret_rect_);
 
   OnSelectionPositionChanged();
+  UpdatePrefetch(-diff.y());
 }
 
-void PDFiumEngine::PrePaint() {
+void PDFiumEngine::PrePaint(const std::vector<gfx::Rect>& rects) {
   for (auto& paint : progressive_paints_)
     paint.set_painted(false);
+  paint_frame_start_time_ = base::TimeTicks::Now();
+
+  page_share_deadlines_.clear();
+  unpainted_page_count_ = 0;
+  if (!interleaved_page_rendering_enabled_)
+    return;
+
+  // Count the pages all of the round's rects cover, so the round's time gets
+  // shared between them rather than between the pages of each rect.
+  for (int index : visible_pages_) {
+    if (!pages_[index]->available())
+      continue;
+    const gfx::Rect page_rect_in_screen = GetPageScreenRect(index);
+    if (std::any_of(rects.begin(), rects.end(),
+                    [&page_rect_in_screen](const gfx::Rect& rect) {
+                      return rect.Intersects(page_rect_in_screen);
+                    })) {
+      ++unpainted_page_count_;
+    }
+  }
 }
 
 void PDFiumEngine::Paint(const gfx::Rect& rect,
                          SkBitmap& image_data,
                          std::vector<gfx::Rect>& ready,
+                         std::vector<gfx::Rect>& ready_now,
                          std::vector<gfx::Rect>& pending) {
   gfx::Rect leftover = rect;
 
@@ -684,39 +791,45 @@ void PDFiumEngine::Paint(const gfx::Rect& rect,
       leftover.Subtract(dirty_in_screen);
     }
 
-    if (pages_[index]->available()) {
-      int progressive = GetProgressiveIndex(index);
-      if (progressive != -1) {
-        DCHECK_GE(progressive, 0);
-        DCHECK_LT(static_cast<size_t>(progressive), progressive_paints_.size());
-        if (progressive_paints_[progressive].rect() != dirty_in_screen) {
-          // The PDFium code can only handle one progressive paint at a time, so
-          // queue this up. Previously we used to merge the rects when this
-          // happened, but it made scrolling up on complex PDFs very slow since
-          // there would be a damaged rect at the top (from scroll) and at the
-          // bottom (from toolbar).
-          pending.push_back(dirty_in_screen);
-          continue;
-        }
-      }
+    if (!pages_[index]->available()) {
+      PaintUnavailablePage(index, dirty_in_screen, image_data);
+      ready.push_back(dirty_in_screen);
+      continue;
+    }
 
-      if (progressive == -1) {
-        progressive = StartPaint(index, dirty_in_screen);
-        progressive_paint_timeout_ = kMaxInitialProgressivePaintTime;
-      } else {
-        progressive_paint_timeout_ = kMaxProgressivePaintTime;
-      }
+    // PDFium can only render on this thread, so the pages cannot render in
+    // parallel. Instead, give each page an even share of the round of paints,
+    // so the progressive paints of all the visible pages advance together
+    // rather than one page after another.
+    if (interleaved_page_rendering_enabled_)
+      page_paint_deadline_ = GetPageShareDeadline(index);
 
-      progressive_paints_[progressive].set_painted(true);
-      if (ContinuePaint(progressive, image_data)) {
-        FinishPaint(progressive, image_data);
-        ready.push_back(dirty_in_screen);
-      } else {
-        pending.push_back(dirty_in_screen);
+    if (!tiled_rendering_enabled_) {
+      PaintPageRect(index, dirty_in_screen, image_data, ready, ready_now,
+                    pending);
+      continue;
+    }
+
+    // Render the dirty region one tile at a time. Finished tiles are reported
+    // as ready right away, so they are not rendered again if the rest of the
+    // region gets requeued or its progressive paint gets canceled, and so they
+    // show without waiting for the rest of the region. The grid is anchored to
+    // the page so tile boundaries do not depend on `rect`.
+    const gfx::Point page_origin = GetPageScreenRect(index).origin();
+    for (const gfx::Rect& tile : draw_utils::GetTilesForRect(
+             dirty_in_screen, page_origin, kRenderTileSize)) {
+      int progressive = GetProgressiveIndex(index);
+      bool continues_paint =
+          progressive != -1 && progressive_paints_[progressive].rect() == tile;
+      if (!continues_paint && base::TimeTicks::Now() >= GetPaintDeadline()) {
+        // Out of time for this round of paints. Leave the remaining tiles for
+        // the next round, but always continue a tile that is already underway
+        // so its progress is not thrown away by PostPaint().
+        pending.push_back(tile);
+        continue;
       }
-    } else {
-      PaintUnavailablePage(index, dirty_in_screen, image_data);
-      ready.push_back(dirty_in_screen);
+      PaintPageRect(index, tile, image_data, /*ready=*/ready_now, ready_now,
+                    pending);
     }
   }
 
@@ -724,7 +837,150 @@ void PDFiumEngine::Paint(const gfx::Rect& rect,
                                 base::TimeTicks::Now() - begin_time);
 }
 
+void PDFiumEngine::PaintPageRect(int page_index,
+                                 const gfx::Rect& dirty,
+                                 SkBitmap& image_data,
+                                 std::vector<gfx::Rect>& ready,
+                                 std::vector<gfx::Rect>& ready_now,
+                                 std::vector<gfx::Rect>& pending) {
+  if (PaintFromTileCache(page_index, dirty, image_data)) {
+    ready.push_back(dirty);
+    return;
+  }
+
+  if (placeholders_enabled_ && !refining_pages_.contains(page_index)) {
+    if (!RenderPlaceholder(page_index)) {
+      pending.push_back(dirty);
+      return;
+    }
+    if (PaintPlaceholder(page_index, dirty, image_data)) {
+      // Show the placeholder right away, even while other rects are still
+      // pending. The full quality paint starts with the next round of paints,
+      // since it would overwrite the placeholder in `image_data` before it
+      // gets shown.
+      ready_now.push_back(dirty);
+      pending.push_back(dirty);
+      return;
+    }
+  }
+
+  int progressive = GetProgressiveIndex(page_index);
+  if (progressive != -1) {
+    DCHECK_GE(progressive, 0);
+    DCHECK_LT(static_cast<size_t>(progressive), progressive_paints_.size());
+    if (progressive_paints_[progressive].rect() != dirty) {
+      // The PDFium code can only handle one progressive paint at a time, so
+      // queue this up. Previously we used to merge the rects when this
+      // happened, but it made scrolling up on complex PDFs very slow since
+      // there would be a damaged rect at the top (from scroll) and at the
+      // bottom (from toolbar).
+      pending.push_back(dirty);
+      return;
+    }
+  }
+
+  const bool new_paint = progressive == -1;
+  if (new_paint) {
+    // The page is visible now, so paint it on screen rather than prefetch it.
+    if (IsPrefetchingPage(page_index))
+      CancelPrefetchPaint();
+    progressive = StartPaint(page_index, dirty);
+  }
+  progressive_paint_timeout_ =
+      GetProgressivePaintTimeout(progressive, new_paint);
+
+  ProgressivePaint& paint = progressive_paints_[progressive];
+  paint.set_painted(true);
+  if (ContinuePaint(paint, image_data)) {
+    FinishPaint(paint, image_data);
+    progressive_paints_.erase(progressive_paints_.begin() + progressive);
+    MaybeRequestPendingThumbnail(page_index);
+    ready.push_back(dirty);
+  } else {
+    pending.push_back(dirty);
+  }
+}
+
+base::TimeDelta PDFiumEngine::GetProgressivePaintTimeout(int progressive_index,
+                                                         bool new_paint) const {
+  DCHECK_GE(progressive_index, 0);
+  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
+
+  // All the paints in a round share the frame budget, so use what is left.
+  base::TimeDelta timeout = std::max(
+      GetPaintDeadline() - base::TimeTicks::Now(), kMinProgressivePaintTime);
+
+  if (!adaptive_paint_scheduling_enabled_) {
+    base::TimeDelta fixed_timeout =
+        new_paint ? kMaxInitialProgressivePaintTime : kMaxProgressivePaintTime;
+    return interleaved_page_rendering_enabled_
+               ? std::min(fixed_timeout, timeout)
+               : fixed_timeout;
+  }
+
+  // Let the paint run slightly over budget if it is expected to finish then,
+  // since every extra round of paints adds overhead and delays the result.
+  const ProgressivePaint& paint = progressive_paints_[progressive_index];
+  std::optional<base::TimeDelta> render_time =
+      pages_[paint.page_index()]->EstimateRenderTime(
+          static_cast<int64_t>(paint.rect().size().Area64()));
+  if (render_time.has_value()) {
+    base::TimeDelta remaining_render_time =
+        render_time.value() - paint.render_time();
+    if (remaining_render_time > timeout &&
+        remaining_render_time <= timeout + kMaxProgressivePaintOvershoot) {
+      timeout += kMaxProgressivePaintOvershoot;
+    }
+  }
+  return timeout;
+}
+
+base::TimeTicks PDFiumEngine::GetPaintDeadline() const {
+  return interleaved_page_rendering_enabled_
+             ? page_paint_deadline_
+             : paint_frame_start_time_ + GetPaintFrameBudget();
+}
+
+base::TimeTicks PDFiumEngine::GetPageShareDeadline(int page_index) {
+  DCHECK(interleaved_page_rendering_enabled_);
+  auto it = page_share_deadlines_.find(page_index);
+  if (it != page_share_deadlines_.end())
+    return it->second;
+
+  // A page not counted when the round started, e.g. one that became available
+  // since, still only gets a share of the time left.
+  const int64_t sharing_page_count =
+      std::max<int64_t>(unpainted_page_count_, 1);
+  if (unpainted_page_count_ > 0)
+    --unpainted_page_count_;
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeTicks frame_deadline =
+      paint_frame_start_time_ + GetPaintFrameBudget();
+  const base::TimeTicks deadline =
+      now + std::max(frame_deadline - now, base::TimeDelta()) /
+                sharing_page_count;
+  page_share_deadlines_[page_index] = deadline;
+  return deadline;
+}
+
+base::TimeDelta PDFiumEngine::GetPaintFrameBudget() const {
+  if (!adaptive_paint_scheduling_enabled_)
+    return kMaxProgressivePaintTime;
+
+  return base::TimeTicks::Now() - last_interaction_time_ <
+                 kInteractivePaintWindow
+             ? kInteractivePaintFrameBudget
+             : kIdlePaintFrameBudget;
+}
+
 void PDFiumEngine::PostPaint() {
+  for (int page_index : placeholder_painted_pages_) {
+    refining_pages_.insert(page_index);
+    page_placeholders_.erase(page_index);
+  }
+  placeholder_painted_pages_.clear();
+
   for (size_t i = 0; i < progressive_paints_.size(); ++i) {
     if (progressive_paints_[i].painted())
       continue;
@@ -746,7 +1002,9 @@ bool PDFiumEngine::HandleDocumentLoad(std::unique_ptr<UrlLoader> loader,
       base::FeatureList::IsEnabled(features::kPdfIncrementalLoading);
 
   if (!doc_loader_set_for_testing_) {
-    doc_loader_ = std::make_unique<DocumentLoaderImpl>(this);
+    auto doc_loader = std::make_unique<DocumentLoaderImpl>(this);
+    doc_loader->SetDocumentCache(client_->GetDocumentCache());
+    doc_loader_ = std::move(doc_loader);
     if (!doc_loader_->Init(
             std::make_unique<URLLoaderWrapperImpl>(std::move(loader)),
             original_url))
@@ -768,16 +1026,27 @@ void PDFiumEngine::AppendPage(PDFEngine* engine, int index) {
   CHECK(PageIndexInBounds(index));
 
   // Unload and delete the blank page before appending.
+  CancelPlaceholder(index);
+  if (IsPrefetchingPage(index))
+    CancelPrefetchPaint();
   pages_[index]->Unload();
   pages_[index]->set_calculated_links(false);
   gfx::Size curr_page_size = GetPageSize(index);
   FPDFPage_Delete(doc(), index);
   FPDF_ImportPages(doc(), static_cast<PDFiumEngine*>(engine)->doc(), "1",
                    index);
+
+  // The text of the page changed, so index it again.
+  text_index_.RemovePage(index);
+  ScheduleTextIndexing(index);
+
   gfx::Size new_page_size = GetPageSize(index);
   if (curr_page_size != new_page_size) {
     DCHECK(document_loaded_);
     LoadPageInfo();
+    InvalidateAllCachedTiles();
+  } else {
+    InvalidateCachedTiles(index);
   }
   client_->Invalidate(GetPageScreenRect(index));
 }
@@ -801,8 +1070,10 @@ void PDFiumEngine::OnPendingRequestComplete() {
     // files.
     // See http://code.google.com/p/chromium/issues/detail?id=59400
     // To improve user experience we download entire file for non-linearized
-    // PDF.
-    if (!IsLinearized()) {
+    // PDF, unless reading ahead. PDFium then finds the objects it needs
+    // through the cross-reference table, and its download hints fetch them
+    // ahead of the rest of the file.
+    if (!IsLinearized() && !read_ahead_enabled_) {
       // Wait complete document.
       process_when_pending_request_complete_ = false;
       document_->ResetFPDFAvailability();
@@ -883,6 +1154,7 @@ void PDFiumEngine::FinishLoadingDocument() {
       continue;
 
     pages_[i]->MarkAvailable();
+    ScheduleTextIndexing(i);
     // We still need to call IsPageAvail() even if the whole document is
     // already downloaded.
     FPDFAvail_IsPageAvail(fpdf_availability(), i, &download_hints);
@@ -908,6 +1180,8 @@ void PDFiumEngine::FinishLoadingDocument() {
     return;
   called_do_document_action_ = true;
 
+  ScheduleTextIndexing(0);
+
   // These can only be called now, as the JS might end up needing a page.
   FORM_DoDocumentJSAction(form());
   FORM_DoDocumentOpenAction(form());
@@ -947,6 +1221,44 @@ void PDFiumEngine::ContinueFind(bool case_sensitive) {
   StartFind(current_find_text_, case_sensitive);
 }
 
+void PDFiumEngine::ScheduleTextIndexing(size_t page_index) {
+  // Indexing starts once the document finished loading.
+  if (!find_text_index_enabled_ || !called_do_document_action_)
+    return;
+
+  next_page_to_index_ = std::min(next_page_to_index_, page_index);
+  if (text_indexing_scheduled_)
+    return;
+
+  text_indexing_scheduled_ = true;
+  base::SingleThreadTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(&PDFiumEngine::ContinueTextIndexing,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void PDFiumEngine::ContinueTextIndexing() {
+  text_indexing_scheduled_ = false;
+
+  // Skip the pages that searches added already.
+  while (next_page_to_index_ < pages_.size() &&
+         text_index_.GetPage(next_page_to_index_)) {
+    ++next_page_to_index_;
+  }
+  if (next_page_to_index_ >= pages_.size())
+    return;
+
+  // Pages that are not available yet get scheduled again once their data
+  // arrives.
+  PDFiumPage* page = pages_[next_page_to_index_++].get();
+  if (page->available()) {
+    text_index_.AddPage(*page);
+    if (!IsPageVisible(page->index()))
+      page->Unload();
+  }
+
+  ScheduleTextIndexing(next_page_to_index_);
+}
+
 bool PDFiumEngine::HandleInputEvent(const blink::WebInputEvent& event) {
   DCHECK(!defer_page_unload_);
   defer_page_unload_ = true;
@@ -1144,6 +1456,10 @@ bool PDFiumEngine::ReadLoadedBytes(uint32_t length, void* buffer) {
   return doc_loader_->GetBlock(0, length, buffer);
 }
 
+base::span<const uint8_t> PDFiumEngine::GetLoadedBytes() {
+  return doc_loader_->GetCompleteData();
+}
+
 void PDFiumEngine::SetFormSelectedText(FPDF_FORMHANDLE form_handle,
                                        FPDF_PAGE page) {
   std::u16string selected_form_text16 = CallPDFiumWideStringBufferApi(
@@ -1785,11 +2101,15 @@ void PDFiumEngine::StartFind(const std::u16string& text, bool case_sensitive) {
   }
 
   bool first_search = (current_find_text_ != text);
+  if (first_search && RefineFind(text, case_sensitive))
+    return;
+
   int character_to_start_searching_from = 0;
   if (first_search) {
     std::vector<PDFiumRange> old_selection = selection_;
     StopFind();
     current_find_text_ = text;
+    current_find_case_sensitive_ = case_sensitive;
 
     if (old_selection.empty()) {
       // Start searching from the beginning of the document.
@@ -1806,50 +2126,78 @@ void PDFiumEngine::StartFind(const std::u16string& text, bool case_sensitive) {
     search_in_progress_ = true;
   }
 
-  int current_page = next_page_to_search_;
+  // A parallel find adds its results as its shards finish searching, and the
+  // search for matches across pages adds them once it is done.
+  if (parallel_find_ || cross_page_find_in_progress_)
+    return;
 
-  if (pages_[current_page]->available()) {
-    // Don't use PDFium to search for now, since it doesn't support unicode
-    // text. Leave the code for now to avoid bit-rot, in case it's fixed later.
-    // The extra parens suppress a -Wunreachable-code warning.
-    if ((false)) {
-      SearchUsingPDFium(text, case_sensitive, first_search,
-                        character_to_start_searching_from, current_page);
-    } else {
+  if (first_search && parallel_find_enabled_ &&
+      text_index_.HasAllPages(pages_.size())) {
+    StartParallelFind(text, case_sensitive);
+    return;
+  }
+
+  // Pages in `text_index_` search without PDFium, so search as many of them as
+  // fit in one task. Other pages get a task each.
+  const base::TimeTicks deadline = base::TimeTicks::Now() + kFindTimePerTask;
+  while (true) {
+    int current_page = next_page_to_search_;
+
+    if (find_text_index_enabled_ && text_index_.GetPage(current_page)) {
       SearchUsingICU(text, case_sensitive, first_search,
                      character_to_start_searching_from, current_page);
-    }
+    } else if (pages_[current_page]->available()) {
+      // Don't use PDFium to search for now, since it doesn't support unicode
+      // text. Leave the code for now to avoid bit-rot, in case it's fixed
+      // later. The extra parens suppress a -Wunreachable-code warning.
+      if ((false)) {
+        SearchUsingPDFium(text, case_sensitive, first_search,
+                          character_to_start_searching_from, current_page);
+      } else {
+        SearchUsingICU(text, case_sensitive, first_search,
+                       character_to_start_searching_from, current_page);
+      }
 
-    if (!IsPageVisible(current_page))
-      pages_[current_page]->Unload();
-  }
+      if (!IsPageVisible(current_page))
+        pages_[current_page]->Unload();
+    }
 
-  if (next_page_to_search_ != last_page_to_search_ ||
-      (first_search && last_character_index_to_search_ != -1)) {
-    ++next_page_to_search_;
-  }
+    if (next_page_to_search_ != last_page_to_search_ ||
+        (first_search && last_character_index_to_search_ != -1)) {
+      ++next_page_to_search_;
+    }
 
-  if (next_page_to_search_ == static_cast<int>(pages_.size()))
-    next_page_to_search_ = 0;
-  // If there's only one page in the document and we start searching midway,
-  // then we'll want to search the page one more time.
-  bool end_of_search =
-      next_page_to_search_ == last_page_to_search_ &&
-      // Only one page but didn't start midway.
-      ((pages_.size() == 1 && last_character_index_to_search_ == -1) ||
-       // Started midway, but only 1 page and we already looped around.
-       (pages_.size() == 1 && !first_search) ||
-       // Started midway, and we've just looped around.
-       (pages_.size() > 1 && current_page == next_page_to_search_));
+    if (next_page_to_search_ == static_cast<int>(pages_.size()))
+      next_page_to_search_ = 0;
+    // If there's only one page in the document and we start searching midway,
+    // then we'll want to search the page one more time.
+    bool end_of_search =
+        next_page_to_search_ == last_page_to_search_ &&
+        // Only one page but didn't start midway.
+        ((pages_.size() == 1 && last_character_index_to_search_ == -1) ||
+         // Started midway, but only 1 page and we already looped around.
+         (pages_.size() == 1 && !first_search) ||
+         // Started midway, and we've just looped around.
+         (pages_.size() > 1 && current_page == next_page_to_search_));
+
+    if (end_of_search) {
+      FinishFind(text, case_sensitive);
+      return;
+    }
 
-  if (end_of_search) {
-    search_in_progress_ = false;
+    if (!find_text_index_enabled_ ||
+        !text_index_.GetPage(next_page_to_search_) ||
+        base::TimeTicks::Now() >= deadline) {
+      break;
+    }
 
-    // Send the final notification.
-    client_->NotifyNumberOfFindResultsChanged(find_results_.size(), true);
-    return;
+    // Continue like ContinueFind() would.
+    first_search = false;
+    character_to_start_searching_from = 0;
   }
 
+  SendFindResultUpdates(/*final_result=*/false);
+
   // In unit tests, just call ContinueFind() directly for simplicity and reduce
   // the need to use RunLoops.
   if (doc_loader_set_for_testing_) {
@@ -1862,6 +2210,286 @@ void PDFiumEngine::StartFind(const std::u16string& text, bool case_sensitive) {
   }
 }
 
+bool PDFiumEngine::RefineFind(const std::u16string& text,
+                              bool case_sensitive) {
+  // Only a finished search for a prefix of `text` has all the matches of
+  // `text` among its results. A case-sensitive search misses the matches that
+  // a case-insensitive one needs. Results only get refined within their page,
+  // which misses the matches that `text` extends onto the next page.
+  if (!find_text_index_enabled_ || cross_page_find_enabled_ ||
+      search_in_progress_ || current_find_text_.empty() ||
+      !base::StartsWith(text, current_find_text_) ||
+      (current_find_case_sensitive_ && !case_sensitive)) {
+    return false;
+  }
+
+  for (const PDFiumRange& result : find_results_) {
+    if (!text_index_.GetPage(result.page_index()))
+      return false;
+  }
+
+  // A match of `text` could start inside a previous match, where the search
+  // skipped a match of the previous text.
+  if (CanFindTermOverlap(current_find_text_, current_find_case_sensitive_))
+    return false;
+
+  std::u16string adjusted_term = text;
+  for (char16_t& c : adjusted_term)
+    c = SimplifyForSearch(c);
+
+  // Leave room for matches that take more page text than the term has
+  // characters, like ones with accents in the page text.
+  const size_t extra_length = 2 * (text.size() - current_find_text_.size());
+
+  std::vector<PDFiumRange> refined_results;
+  for (const PDFiumRange& result : find_results_) {
+    const PDFiumTextIndex::PageText* page_text =
+        text_index_.GetPage(result.page_index());
+    const std::u16string& page_string = page_text->text->data;
+    const std::vector<int>& char_indices = page_text->char_indices;
+    auto start_it = std::ranges::lower_bound(char_indices, result.char_index());
+    auto end_it = std::lower_bound(start_it, char_indices.end(),
+                                   result.char_index() + result.char_count());
+    if (start_it == char_indices.end() || *start_it != result.char_index())
+      continue;
+
+    // Only search the previous match and the characters after it.
+    const size_t start = start_it - char_indices.begin();
+    const size_t length = std::min<size_t>(
+        end_it - start_it + extra_length, page_string.size() - start);
+    const std::u16string window = page_string.substr(start, length);
+    std::vector<PDFEngine::Client::SearchStringResult> results =
+        client_->SearchString(window.c_str(), adjusted_term.c_str(),
+                              case_sensitive);
+    if (results.empty() || results[0].start_index != 0)
+      continue;
+
+    const int end = char_indices[start + results[0].length];
+    DCHECK_LT(result.char_index(), end);
+    refined_results.emplace_back(pages_[result.page_index()].get(),
+                                 result.char_index(),
+                                 end - result.char_index());
+  }
+
+  SelectionChangeInvalidator selection_invalidator(this);
+  selection_.clear();
+  current_find_index_.reset();
+  current_find_text_ = text;
+  current_find_case_sensitive_ = case_sensitive;
+  find_results_ = std::move(refined_results);
+
+  UpdateTickMarks();
+  client_->NotifyNumberOfFindResultsChanged(find_results_.size(), true);
+  return true;
+}
+
+bool PDFiumEngine::CanFindTermOverlap(const std::u16string& term,
+                                      bool case_sensitive) {
+  std::u16string adjusted_term = term;
+  for (char16_t& c : adjusted_term)
+    c = SimplifyForSearch(c);
+
+  // Matches overlap if the end of the term can match its start. Leave it to
+  // the client to tell, as it may match characters that differ.
+  for (size_t length = 1; length < adjusted_term.size(); ++length) {
+    const std::u16string prefix = adjusted_term.substr(0, length);
+    const std::u16string suffix =
+        adjusted_term.substr(adjusted_term.size() - length);
+    if (!client_->SearchString(suffix.c_str(), prefix.c_str(), case_sensitive)
+             .empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PDFiumEngine::StartParallelFind(const std::u16string& text,
+                                     bool case_sensitive) {
+  DCHECK(!parallel_find_);
+
+  std::u16string adjusted_term = text;
+  for (char16_t& c : adjusted_term)
+    c = SimplifyForSearch(c);
+
+  ParallelFind& find = parallel_find_.emplace();
+  const int page_count = pages_.size();
+  for (int i = 0; i < page_count; ++i)
+    find.pages.push_back((next_page_to_search_ + i) % page_count);
+  // Come back to the part of the page before the selection last.
+  if (last_character_index_to_search_ != -1)
+    find.pages.push_back(last_page_to_search_);
+
+  const size_t shard_count =
+      (find.pages.size() + kPagesPerFindShard - 1) / kPagesPerFindShard;
+  find.shard_matches.resize(shard_count);
+  for (size_t shard_index = 0; shard_index < shard_count; ++shard_index) {
+    const size_t begin = shard_index * kPagesPerFindShard;
+    const size_t end = std::min(begin + kPagesPerFindShard, find.pages.size());
+    // Share the page text with the search rather than copy it.
+    std::vector<SharedPageText> texts;
+    texts.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i)
+      texts.push_back(text_index_.GetPage(find.pages[i])->text);
+
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+        base::BindOnce(&SearchPageTexts, std::move(texts), adjusted_term,
+                       case_sensitive),
+        base::BindOnce(&PDFiumEngine::OnFindShardSearched,
+                       find_weak_factory_.GetWeakPtr(), shard_index));
+  }
+}
+
+void PDFiumEngine::OnFindShardSearched(
+    size_t shard_index,
+    std::vector<std::vector<PDFEngine::Client::SearchStringResult>> matches) {
+  DCHECK(parallel_find_);
+  ParallelFind& find = parallel_find_.value();
+  find.shard_matches[shard_index] = std::move(matches);
+
+  // Add the results in the order the search covers the pages, so they come in
+  // the same way as they do when searching one page per task.
+  while (find.next_shard < find.shard_matches.size() &&
+         find.shard_matches[find.next_shard]) {
+    std::vector<ParallelFind::PageMatches> shard_matches =
+        std::move(find.shard_matches[find.next_shard].value());
+    find.shard_matches[find.next_shard].reset();
+    const size_t begin = find.next_shard * kPagesPerFindShard;
+    ++find.next_shard;
+
+    for (size_t i = 0; i < shard_matches.size(); ++i) {
+      const size_t position = begin + i;
+      const int page_index = find.pages[position];
+      // The pages may have changed since the search started.
+      const PDFiumTextIndex::PageText* page_text =
+          text_index_.GetPage(page_index);
+      if (!page_text)
+        continue;
+
+      for (const auto& match : shard_matches[i]) {
+        int start = page_text->char_indices[match.start_index];
+        int end = page_text->char_indices[match.start_index + match.length];
+
+        // If the search started from a selection, the first search of its
+        // page covers the part after the selection, and the last one the part
+        // before it.
+        if (last_character_index_to_search_ != -1) {
+          if (position == 0 && start < last_character_index_to_search_)
+            continue;
+          if (position == find.pages.size() - 1 &&
+              end > last_character_index_to_search_) {
+            continue;
+          }
+        }
+
+        DCHECK_LT(start, end);
+        AddFindResult(
+            PDFiumRange(pages_[page_index].get(), start, end - start));
+      }
+    }
+  }
+
+  if (find.next_shard < find.shard_matches.size()) {
+    SendFindResultUpdates(/*final_result=*/false);
+    return;
+  }
+
+  parallel_find_.reset();
+  FinishFind(current_find_text_, current_find_case_sensitive_);
+}
+
+void PDFiumEngine::FinishFind(const std::u16string& term,
+                              bool case_sensitive) {
+  if (!cross_page_find_enabled_ || !text_index_.HasAllPages(pages_.size())) {
+    search_in_progress_ = false;
+
+    // Send the final notification.
+    SendFindResultUpdates(/*final_result=*/true);
+    return;
+  }
+
+  std::u16string adjusted_term = term;
+  for (char16_t& c : adjusted_term)
+    c = SimplifyForSearch(c);
+
+  // Share the page text with the search rather than copy it.
+  std::vector<SharedPageText> texts;
+  texts.reserve(pages_.size());
+  for (size_t i = 0; i < pages_.size(); ++i)
+    texts.push_back(text_index_.GetPage(i)->text);
+
+  cross_page_find_in_progress_ = true;
+  SendFindResultUpdates(/*final_result=*/false);
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+      base::BindOnce(&FindCrossPageMatches, std::move(texts),
+                     std::move(adjusted_term), case_sensitive),
+      base::BindOnce(&PDFiumEngine::OnCrossPageMatchesFound,
+                     find_weak_factory_.GetWeakPtr()));
+}
+
+void PDFiumEngine::OnCrossPageMatchesFound(
+    std::vector<CrossPageMatch> matches) {
+  DCHECK(cross_page_find_in_progress_);
+  cross_page_find_in_progress_ = false;
+
+  for (const CrossPageMatch& match : matches) {
+    std::vector<PDFiumRange> ranges;
+    for (int page_index = match.start.page_index;
+         page_index <= match.end.page_index; ++page_index) {
+      // The pages may have changed since the search started.
+      const PDFiumTextIndex::PageText* page_text =
+          text_index_.GetPage(page_index);
+      if (!page_text || page_text->char_indices.empty()) {
+        ranges.clear();
+        break;
+      }
+
+      const std::vector<int>& char_indices = page_text->char_indices;
+      const size_t start_index = page_index == match.start.page_index
+                                     ? match.start.text_index
+                                     : 0;
+      const size_t end_index = page_index == match.end.page_index
+                                   ? match.end.text_index
+                                   : char_indices.size() - 1;
+      if (end_index >= char_indices.size()) {
+        ranges.clear();
+        break;
+      }
+
+      const int start = char_indices[start_index];
+      const int end = char_indices[end_index];
+      if (start < end)
+        ranges.emplace_back(pages_[page_index].get(), start, end - start);
+    }
+    if (ranges.empty())
+      continue;
+
+    // Keep the matches already found within a page, or across pages, over the
+    // ones that overlap them, like a search of a single page keeps the first
+    // of two overlapping matches.
+    if (std::ranges::any_of(ranges, [this](const PDFiumRange& range) {
+          return OverlapsFindResult(range);
+        })) {
+      continue;
+    }
+
+    // The result is the part on the first page, and selecting it selects the
+    // rest too.
+    if (ranges.size() > 1) {
+      find_result_continuations_.emplace(
+          std::make_pair(ranges[0].page_index(), ranges[0].char_index()),
+          std::vector<PDFiumRange>(ranges.begin() + 1, ranges.end()));
+    }
+    AddFindResult(ranges[0]);
+  }
+
+  search_in_progress_ = false;
+
+  // Send the final notification.
+  SendFindResultUpdates(/*final_result=*/true);
+}
+
 void PDFiumEngine::SearchUsingPDFium(const std::u16string& term,
                                      bool case_sensitive,
                                      bool first_search,
@@ -1907,143 +2535,116 @@ void PDFiumEngine::SearchUsingICU(const std::u16string& term,
   for (char16_t& c : adjusted_term)
     c = SimplifyForSearch(c);
 
-  const int original_text_length = pages_[current_page]->GetCharCount();
-  int text_length = original_text_length;
-  if (character_to_start_searching_from) {
-    text_length -= character_to_start_searching_from;
-  } else if (!first_search && last_character_index_to_search_ != -1 &&
-             current_page == last_page_to_search_) {
-    text_length = last_character_index_to_search_;
-  }
-  if (text_length <= 0)
-    return;
-
-  std::u16string page_text;
-  PDFiumAPIStringBufferAdapter<std::u16string> api_string_adapter(
-      &page_text, text_length, false);
-  unsigned short* data =
-      reinterpret_cast<unsigned short*>(api_string_adapter.GetData());
-  int written =
-      FPDFText_GetText(pages_[current_page]->GetTextPage(),
-                       character_to_start_searching_from, text_length, data);
-  api_string_adapter.Close(written);
-
-  const gfx::RectF page_bounds = pages_[current_page]->GetCroppedRect();
-  std::u16string adjusted_page_text;
-  adjusted_page_text.reserve(page_text.size());
-  // Values in `removed_indices` are in the adjusted text index space and
-  // indicate a character was removed from the page text before the given
-  // index. If multiple characters are removed in a row then there will be
-  // multiple entries with the same value.
-  std::vector<size_t> removed_indices;
-  // When walking through the page text collapse any whitespace regions,
-  // including \r and \n, down to a single ' ' character. This code does
-  // not use base::CollapseWhitespace(), because that function does not
-  // return where the collapsing occurs, but uses the same underlying list of
-  // whitespace characters. Calculating where the collapsed regions are after
-  // the fact is as complex as collapsing them manually.
-  for (size_t i = 0; i < page_text.size(); i++) {
-    // Filter out characters outside the page bounds, which are semantically not
-    // part of the page.
-    if (!pages_[current_page]->IsCharInPageBounds(
-            character_to_start_searching_from + i, page_bounds)) {
-      removed_indices.push_back(adjusted_page_text.size());
-      continue;
-    }
-
-    char16_t c = page_text[i];
-    // Collapse whitespace regions by inserting a ' ' into the
-    // adjusted text and recording any removed whitespace indices as preceding
-    // it.
-    if (base::IsUnicodeWhitespace(c)) {
-      size_t whitespace_region_begin = i;
-      while (i < page_text.size() && base::IsUnicodeWhitespace(page_text[i]))
-        ++i;
-
-      size_t count = i - whitespace_region_begin - 1;
-      removed_indices.insert(removed_indices.end(), count,
-                             adjusted_page_text.size());
-      adjusted_page_text.push_back(' ');
-      if (i >= page_text.size())
-        break;
-      c = page_text[i];
-    }
-
-    if (IsIgnorableCharacter(c))
-      removed_indices.push_back(adjusted_page_text.size());
-    else
-      adjusted_page_text.push_back(SimplifyForSearch(c));
-  }
-
-  if (adjusted_page_text.empty())
+  // The wrapped around search of the page the search started on stops where
+  // the first search of the page started.
+  const bool search_to_last_character =
+      !first_search && last_character_index_to_search_ != -1 &&
+      current_page == last_page_to_search_;
+
+  std::optional<PDFiumTextIndex::PageText> extracted_page_text;
+  const PDFiumTextIndex::PageText* page_text = nullptr;
+  if (find_text_index_enabled_) {
+    page_text = text_index_.GetPage(current_page);
+    if (!page_text)
+      page_text = &text_index_.AddPage(*pages_[current_page]);
+  } else {
+    extracted_page_text =
+        PDFiumTextIndex::ExtractPageText(*pages_[current_page]);
+    page_text = &extracted_page_text.value();
+  }
+
+  // Only search the part of the normalized page text that maps to the part of
+  // the page this search covers. Filtering the matches of the whole page
+  // instead would lose matches that overlap one starting before that part.
+  const std::vector<int>& char_indices = page_text->char_indices;
+  const size_t text_begin = static_cast<size_t>(
+      std::ranges::lower_bound(char_indices,
+                               character_to_start_searching_from) -
+      char_indices.begin());
+  size_t text_end = char_indices.size();
+  if (search_to_last_character) {
+    text_end = static_cast<size_t>(
+        std::ranges::upper_bound(char_indices,
+                                 last_character_index_to_search_) -
+        char_indices.begin());
+  }
+  // `char_indices` has one more entry than the text, for its end.
+  if (text_end == 0 || text_begin >= --text_end)
     return;
 
+  const std::u16string text =
+      page_text->text->data.substr(text_begin, text_end - text_begin);
   std::vector<PDFEngine::Client::SearchStringResult> results =
-      client_->SearchString(adjusted_page_text.c_str(), adjusted_term.c_str(),
+      client_->SearchString(text.c_str(), adjusted_term.c_str(),
                             case_sensitive);
   for (const auto& result : results) {
-    // Need to convert from adjusted page text start to page text start, by
-    // incrementing for all the characters adjusted before it in the string.
-    auto removed_indices_begin = std::upper_bound(
-        removed_indices.begin(), removed_indices.end(), result.start_index);
-    size_t page_text_result_start_index =
-        result.start_index +
-        std::distance(removed_indices.begin(), removed_indices_begin);
-
-    // Need to convert the adjusted page length into a page text length, since
-    // the matching range may have adjusted characters within it. This
-    // conversion only cares about skipped characters in the result interval.
-    auto removed_indices_end =
-        std::upper_bound(removed_indices_begin, removed_indices.end(),
-                         result.start_index + result.length);
-    int term_removed_count =
-        std::distance(removed_indices_begin, removed_indices_end);
-    int page_text_result_length = result.length + term_removed_count;
-
-    // Need to map the indexes from the page text, which may have generated
-    // characters like space etc, to character indices from the page.
-    int text_to_start_searching_from = FPDFText_GetTextIndexFromCharIndex(
-        pages_[current_page]->GetTextPage(), character_to_start_searching_from);
-    int temp_start =
-        page_text_result_start_index + text_to_start_searching_from;
-    int start = FPDFText_GetCharIndexFromTextIndex(
-        pages_[current_page]->GetTextPage(), temp_start);
-    int end = FPDFText_GetCharIndexFromTextIndex(
-        pages_[current_page]->GetTextPage(),
-        temp_start + page_text_result_length);
-
-    // If `term` occurs at the end of a page, then `end` will be -1 due to the
-    // index being out of bounds. Compensate for this case so the range
-    // character count calculation below works out.
-    if (temp_start + page_text_result_length == original_text_length) {
-      DCHECK_EQ(-1, end);
-      end = original_text_length;
-    }
+    // Map the match in the normalized page text to characters of the page.
+    const size_t match_begin = text_begin + result.start_index;
+    int start = char_indices[match_begin];
+    int end = char_indices[match_begin + result.length];
     DCHECK_LT(start, end);
-    DCHECK_EQ(term.size() + term_removed_count,
-              static_cast<size_t>(end - start));
     AddFindResult(PDFiumRange(pages_[current_page].get(), start, end - start));
   }
 }
 
 void PDFiumEngine::AddFindResult(const PDFiumRange& result) {
   // Figure out where to insert the new location, since we could have
-  // started searching midway and now we wrapped.
-  size_t result_index;
-  int page_index = result.page_index();
-  int char_index = result.char_index();
-  for (result_index = 0; result_index < find_results_.size(); ++result_index) {
-    if (find_results_[result_index].page_index() > page_index ||
-        (find_results_[result_index].page_index() == page_index &&
-         find_results_[result_index].char_index() > char_index)) {
-      break;
-    }
+  // started searching midway and now we wrapped. Results mostly come in
+  // order, in which case this appends.
+  auto position = [](const PDFiumRange& range) {
+    return std::make_pair(range.page_index(), range.char_index());
+  };
+  find_results_.insert(
+      std::ranges::upper_bound(find_results_, position(result), {}, position),
+      result);
+
+  if (batch_find_updates_enabled_) {
+    find_result_updates_pending_ = true;
+    return;
   }
-  find_results_.insert(find_results_.begin() + result_index, result);
+
   UpdateTickMarks();
   client_->NotifyNumberOfFindResultsChanged(find_results_.size(), false);
 }
 
+bool PDFiumEngine::OverlapsFindResult(const PDFiumRange& range) const {
+  auto overlaps = [&range](const PDFiumRange& other) {
+    return other.page_index() == range.page_index() &&
+           other.char_index() < range.char_index() + range.char_count() &&
+           range.char_index() < other.char_index() + other.char_count();
+  };
+
+  // The results do not overlap each other, so the last one that starts before
+  // `range` ends is the only one that can overlap it.
+  auto position = [](const PDFiumRange& result) {
+    return std::make_pair(result.page_index(), result.char_index());
+  };
+  const int range_end = range.char_index() + range.char_count();
+  auto it = std::ranges::lower_bound(
+      find_results_, std::make_pair(range.page_index(), range_end), {},
+      position);
+  if (it != find_results_.begin() && overlaps(*std::prev(it)))
+    return true;
+
+  for (const auto& [start, continuation] : find_result_continuations_) {
+    if (std::ranges::any_of(continuation, overlaps))
+      return true;
+  }
+  return false;
+}
+
+void PDFiumEngine::SendFindResultUpdates(bool final_result) {
+  if (find_result_updates_pending_) {
+    find_result_updates_pending_ = false;
+    UpdateTickMarks();
+  } else if (!final_result) {
+    return;
+  }
+
+  client_->NotifyNumberOfFindResultsChanged(find_results_.size(),
+                                            final_result);
+}
+
 bool PDFiumEngine::SelectFindResult(bool forward) {
   if (find_results_.empty())
     return false;
@@ -2077,7 +2678,14 @@ bool PDFiumEngine::SelectFindResult(bool forward) {
   // Update the selection before telling the client to scroll, since it could
   // paint then.
   selection_.clear();
-  selection_.push_back(find_results_[current_find_index_.value()]);
+  const PDFiumRange& result = find_results_[current_find_index_.value()];
+  selection_.push_back(result);
+  auto continuation = find_result_continuations_.find(
+      std::make_pair(result.page_index(), result.char_index()));
+  if (continuation != find_result_continuations_.end()) {
+    selection_.insert(selection_.end(), continuation->second.begin(),
+                      continuation->second.end());
+  }
 
   // If the result is not in view, scroll to it.
   gfx::Rect bounding_rect;
@@ -2120,6 +2728,10 @@ void PDFiumEngine::StopFind() {
   last_character_index_to_search_ = -1;
   current_find_index_.reset();
   current_find_text_.clear();
+  find_result_continuations_.clear();
+  parallel_find_.reset();
+  cross_page_find_in_progress_ = false;
+  find_result_updates_pending_ = false;
 
   UpdateTickMarks();
   find_weak_factory_.InvalidateWeakPtrs();
@@ -2144,11 +2756,21 @@ std::vector<gfx::Rect> PDFiumEngine::GetAllScreenRectsUnion(
 void PDFiumEngine::UpdateTickMarks() {
   std::vector<gfx::Rect> tickmarks =
       GetAllScreenRectsUnion(find_results_, gfx::Point());
+  for (const auto& [position, ranges] : find_result_continuations_) {
+    std::vector<gfx::Rect> continuation_tickmarks =
+        GetAllScreenRectsUnion(ranges, gfx::Point());
+    tickmarks.insert(tickmarks.end(), continuation_tickmarks.begin(),
+                     continuation_tickmarks.end());
+  }
   client_->UpdateTickMarks(tickmarks);
 }
 
 void PDFiumEngine::ZoomUpdated(double new_zoom_level) {
   CancelPaints();
+  CancelPrefetch();
+  CancelPlaceholders();
+  refining_pages_.clear();
+  last_interaction_time_ = base::TimeTicks::Now();
 
   current_zoom_ = new_zoom_level;
 
@@ -2175,6 +2797,9 @@ bool PDFiumEngine::IsReadOnly() const {
 void PDFiumEngine::SetReadOnly(bool enable) {
   read_only_ = enable;
 
+  // Form field highlights are part of the rendered tiles.
+  InvalidateAllCachedTiles();
+
   // Restore form highlights.
   if (!read_only_) {
     FPDF_SetFormFieldHighlightAlpha(form(), kFormHighlightAlpha);
@@ -2206,6 +2831,10 @@ void PDFiumEngine::DisplayAnnotations(bool display) {
 
 void PDFiumEngine::InvalidateAllPages() {
   CancelPaints();
+  CancelPrefetch();
+  InvalidateAllCachedTiles();
+  CancelPlaceholders();
+  refining_pages_.clear();
   StopFind();
   DCHECK(document_loaded_);
   RefreshCurrentDocumentLayout();
@@ -2702,6 +3331,10 @@ void PDFiumEngine::AppendBlankPages(size_t num_pages) {
 
   selection_.clear();
   pending_pages_.clear();
+  text_index_.Clear();
+  ScheduleTextIndexing(0);
+  CancelPlaceholders();
+  CancelPrefetch();
 
   // Delete all pages except the first one.
   while (pages_.size() > 1) {
@@ -2889,6 +3522,7 @@ std::vector<gfx::Size> PDFiumEngine::LoadPageSizes(
 
   const bool doc_complete = doc_loader_->IsDocumentComplete();
   const bool is_linear = IsLinearized();
+  const bool is_read_ahead = !is_linear && read_ahead_enabled_ && !doc_complete;
   for (size_t i = 0; i < new_page_count; ++i) {
     // Get page availability. If `document_loaded_` == true and the page is not
     // new, then the page has been constructed already. Get page availability
@@ -2902,6 +3536,12 @@ std::vector<gfx::Size> PDFiumEngine::LoadPageSizes(
       int linear_page_avail =
           FPDFAvail_IsPageAvail(fpdf_availability(), i, &download_hints);
       page_available = linear_page_avail == PDF_DATA_AVAIL;
+    } else if (is_read_ahead) {
+      // Without hint tables, finding out what a page needs takes loading its
+      // objects. Leave requesting them to CalculateVisiblePages(), so that the
+      // visible pages come first.
+      page_available = FPDFAvail_IsPageAvail(fpdf_availability(), i,
+                                             nullptr) == PDF_DATA_AVAIL;
     } else {
       page_available = doc_complete;
     }
@@ -2921,8 +3561,10 @@ std::vector<gfx::Size> PDFiumEngine::LoadPageSizes(
   for (size_t i = pages_.size(); i < new_page_count; ++i) {
     auto page = std::make_unique<PDFiumPage>(this, i);
     if (document_loaded_ &&
-        FPDFAvail_IsPageAvail(fpdf_availability(), i, nullptr))
+        FPDFAvail_IsPageAvail(fpdf_availability(), i, nullptr)) {
       page->MarkAvailable();
+      ScheduleTextIndexing(i);
+    }
     pages_.push_back(std::move(page));
   }
 
@@ -2932,6 +3574,7 @@ std::vector<gfx::Size> PDFiumEngine::LoadPageSizes(
       pages_[i]->Unload();
 
     pages_.resize(new_page_count);
+    text_index_.Truncate(new_page_count);
   }
 
   return page_sizes;
@@ -3029,6 +3672,10 @@ void PDFiumEngine::CalculateVisiblePages() {
       visible_pages_.push_back(i);
       CheckPageAvailable(i, &pending_pages_);
     } else {
+      // Show a placeholder again if the page comes back into view.
+      refining_pages_.erase(i);
+      CancelPlaceholder(i);
+
       // Need to unload pages when we're not using them, since some PDFs use a
       // lot of memory.  See http://crbug.com/48791
       if (defer_page_unload_) {
@@ -3061,6 +3708,12 @@ bool PDFiumEngine::IsPageVisible(int index) const {
   return base::Contains(visible_pages_, index);
 }
 
+std::vector<int> PDFiumEngine::GetVisiblePages() const {
+  // CalculateVisiblePages() must have been called first to populate
+  // `visible_pages_`.
+  return visible_pages_;
+}
+
 PageOrientation PDFiumEngine::GetCurrentOrientation() const {
   return layout_.options().default_page_orientation();
 }
@@ -3088,8 +3741,10 @@ bool PDFiumEngine::CheckPageAvailable(int index, std::vector<int>* pending) {
     return false;
   }
 
-  if (index < num_pages)
+  if (index < num_pages) {
     pages_[index]->MarkAvailable();
+    ScheduleTextIndexing(index);
+  }
   if (default_page_size_.IsEmpty())
     default_page_size_ = GetPageSize(index);
   return true;
@@ -3166,25 +3821,23 @@ int PDFiumEngine::StartPaint(int page_index, const gfx::Rect& dirty) {
   return progressive_paints_.size() - 1;
 }
 
-bool PDFiumEngine::ContinuePaint(int progressive_index, SkBitmap& image_data) {
-  DCHECK_GE(progressive_index, 0);
-  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
-
-  last_progressive_start_time_ = base::Time::Now();
+bool PDFiumEngine::ContinuePaint(ProgressivePaint& paint,
+                                 SkBitmap& image_data) {
+  last_progressive_start_time_ = base::TimeTicks::Now();
 
-  int page_index = progressive_paints_[progressive_index].page_index();
+  int page_index = paint.page_index();
   DCHECK(PageIndexInBounds(page_index));
 
   int rv;
   FPDF_PAGE page = pages_[page_index]->GetPage();
-  if (progressive_paints_[progressive_index].bitmap()) {
+  if (paint.bitmap()) {
     rv = FPDF_RenderPage_Continue(page, this);
   } else {
     int start_x;
     int start_y;
     int size_x;
     int size_y;
-    gfx::Rect dirty = progressive_paints_[progressive_index].rect();
+    gfx::Rect dirty = paint.rect();
     GetPDFiumRect(page_index, dirty, &start_x, &start_y, &size_x, &size_y);
 
     bool has_alpha = !!FPDFPage_HasTransparency(page);
@@ -3195,24 +3848,22 @@ bool PDFiumEngine::ContinuePaint(int progressive_index, SkBitmap& image_data) {
         new_bitmap.get(), page, start_x, start_y, size_x, size_y,
         ToPDFiumRotation(layout_.options().default_page_orientation()),
         GetRenderingFlags(), this);
-    progressive_paints_[progressive_index].SetBitmapAndImageData(
-        std::move(new_bitmap), image_data);
+    paint.SetBitmapAndImageData(std::move(new_bitmap), image_data);
   }
+  paint.add_render_time(base::TimeTicks::Now() - last_progressive_start_time_);
   return rv != FPDF_RENDER_TOBECONTINUED;
 }
 
-void PDFiumEngine::FinishPaint(int progressive_index, SkBitmap& image_data) {
-  DCHECK_GE(progressive_index, 0);
-  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
-
-  int page_index = progressive_paints_[progressive_index].page_index();
-  gfx::Rect dirty_in_screen = progressive_paints_[progressive_index].rect();
+void PDFiumEngine::FinishPaint(const ProgressivePaint& paint,
+                               SkBitmap& image_data) {
+  int page_index = paint.page_index();
+  gfx::Rect dirty_in_screen = paint.rect();
 
   int start_x;
   int start_y;
   int size_x;
   int size_y;
-  FPDF_BITMAP bitmap = progressive_paints_[progressive_index].bitmap();
+  FPDF_BITMAP bitmap = paint.bitmap();
   GetPDFiumRect(page_index, dirty_in_screen, &start_x, &start_y, &size_x,
                 &size_y);
 
@@ -3222,18 +3873,35 @@ void PDFiumEngine::FinishPaint(int progressive_index, SkBitmap& image_data) {
                ToPDFiumRotation(layout_.options().default_page_orientation()),
                GetRenderingFlags());
 
-  FillPageSides(progressive_index);
+  FillPageSides(paint);
 
   // Paint the page shadows.
-  PaintPageShadow(progressive_index, image_data);
+  PaintPageShadow(paint, image_data);
+
+  // Cache the tile before drawing selections, which change independently of
+  // the page contents. Skip tiles where PDFium reported form text selections,
+  // since those only get reported while drawing the forms.
+  if (rendered_tile_cache_ && form_highlights_.empty()) {
+    // Match the horizontal offset GetRegion() applies to screen coordinates.
+    SkBitmap tile;
+    if (tile.tryAllocPixels(image_data.info().makeWH(
+            dirty_in_screen.width(), dirty_in_screen.height())) &&
+        image_data.readPixels(tile.pixmap(),
+                              dirty_in_screen.x() + page_offset_.x(),
+                              dirty_in_screen.y())) {
+      rendered_tile_cache_->Put(GetRenderedTileKey(page_index, dirty_in_screen),
+                                std::move(tile));
+    }
+  }
 
-  DrawSelections(progressive_index, image_data);
+  DrawSelections(page_index, dirty_in_screen, image_data);
   form_highlights_.clear();
 
-  FPDF_RenderPage_Close(pages_[page_index]->GetPage());
-  progressive_paints_.erase(progressive_paints_.begin() + progressive_index);
+  pages_[page_index]->RecordRenderTime(
+      paint.render_time(),
+      static_cast<int64_t>(dirty_in_screen.size().Area64()));
 
-  MaybeRequestPendingThumbnail(page_index);
+  FPDF_RenderPage_Close(pages_[page_index]->GetPage());
 }
 
 void PDFiumEngine::CancelPaints() {
@@ -3243,13 +3911,10 @@ void PDFiumEngine::CancelPaints() {
   progressive_paints_.clear();
 }
 
-void PDFiumEngine::FillPageSides(int progressive_index) {
-  DCHECK_GE(progressive_index, 0);
-  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
-
-  int page_index = progressive_paints_[progressive_index].page_index();
-  gfx::Rect dirty_in_screen = progressive_paints_[progressive_index].rect();
-  FPDF_BITMAP bitmap = progressive_paints_[progressive_index].bitmap();
+void PDFiumEngine::FillPageSides(const ProgressivePaint& paint) {
+  int page_index = paint.page_index();
+  gfx::Rect dirty_in_screen = paint.rect();
+  FPDF_BITMAP bitmap = paint.bitmap();
   gfx::Insets insets = GetInsets(layout_.options(), page_index, pages_.size());
 
   gfx::Rect page_rect = pages_[page_index]->rect();
@@ -3305,13 +3970,10 @@ void PDFiumEngine::FillPageSides(int progressive_index) {
                       client_->GetBackgroundColor());
 }
 
-void PDFiumEngine::PaintPageShadow(int progressive_index,
+void PDFiumEngine::PaintPageShadow(const ProgressivePaint& paint,
                                    SkBitmap& image_data) {
-  DCHECK_GE(progressive_index, 0);
-  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
-
-  int page_index = progressive_paints_[progressive_index].page_index();
-  gfx::Rect dirty_in_screen = progressive_paints_[progressive_index].rect();
+  int page_index = paint.page_index();
+  gfx::Rect dirty_in_screen = paint.rect();
   gfx::Rect shadow_rect(pages_[page_index]->rect());
   gfx::Insets insets = GetInsets(layout_.options(), page_index, pages_.size());
   shadow_rect.Inset(ScaleToCeiledInsets(insets, -1));
@@ -3327,17 +3989,10 @@ void PDFiumEngine::PaintPageShadow(int progressive_index,
   DrawPageShadow(page_rect, shadow_rect, dirty_in_screen, image_data);
 }
 
-void PDFiumEngine::DrawSelections(int progressive_index,
+void PDFiumEngine::DrawSelections(int page_index,
+                                  const gfx::Rect& dirty_in_screen,
                                   SkBitmap& image_data) const {
-  DCHECK_GE(progressive_index, 0);
-  DCHECK_LT(static_cast<size_t>(progressive_index), progressive_paints_.size());
-
-  int page_index = progressive_paints_[progressive_index].page_index();
-  gfx::Rect dirty_in_screen = progressive_paints_[progressive_index].rect();
-
-  const std::optional<RegionData> region =
-      GetRegion(dirty_in_screen.origin(), image_data);
-  if (!region.has_value()) {
+  if (!GetRegion(dirty_in_screen.origin(), image_data).has_value()) {
     return;
   }
 
@@ -3351,28 +4006,354 @@ void PDFiumEngine::DrawSelections(int progressive_index,
         range.GetScreenRects(visible_rect.origin(), current_zoom_,
                              layout_.options().default_page_orientation());
     for (const auto& rect : rects) {
-      gfx::Rect visible_selection = gfx::IntersectRects(rect, dirty_in_screen);
-      if (visible_selection.IsEmpty()) {
+      highlighted_rects.push_back(gfx::IntersectRects(rect, dirty_in_screen));
+    }
+  }
+
+  for (const auto& highlight : form_highlights_) {
+    highlighted_rects.push_back(
+        gfx::IntersectRects(highlight, dirty_in_screen));
+  }
+
+  // Match the horizontal offset GetRegion() applies to screen coordinates.
+  for (auto& rect : highlighted_rects) {
+    rect.Offset(page_offset_.x(), 0);
+  }
+  draw_utils::HighlightRects(highlighted_rects, kHighlightColor, image_data);
+}
+
+RenderedTileCache::Key PDFiumEngine::GetRenderedTileKey(
+    int page_index,
+    const gfx::Rect& dirty_in_screen) const {
+  gfx::Rect page_rect_in_screen = GetPageScreenRect(page_index);
+
+  RenderedTileCache::Key key;
+  key.page_index = page_index;
+  key.zoom = current_zoom_;
+  key.orientation = layout_.options().default_page_orientation();
+  key.grayscale = render_grayscale_;
+  key.annotations = render_annots_;
+  key.background_color = client_->GetBackgroundColor();
+  key.page_size = page_rect_in_screen.size();
+  key.rect = dirty_in_screen - page_rect_in_screen.OffsetFromOrigin();
+  return key;
+}
+
+bool PDFiumEngine::PaintFromTileCache(int page_index,
+                                      const gfx::Rect& dirty_in_screen,
+                                      SkBitmap& image_data) {
+  if (!rendered_tile_cache_)
+    return false;
+
+  RenderedTileCache::Key key = GetRenderedTileKey(page_index, dirty_in_screen);
+  gfx::Rect rect_in_tile(dirty_in_screen.size());
+  const SkBitmap* tile = rendered_tile_cache_->Get(key);
+  if (!tile) {
+    // Prefetched tiles cover whole cells of the tile grid, but the viewport
+    // may clip the requested region to part of a cell.
+    for (const gfx::Rect& cell : draw_utils::GetTilesForRect(
+             gfx::Rect(key.page_size), gfx::Point(), kRenderTileSize)) {
+      if (!cell.Contains(key.rect))
         continue;
-      }
 
-      visible_selection.Offset(-dirty_in_screen.OffsetFromOrigin());
-      Highlight(region.value(), visible_selection, kHighlightColor,
-                highlighted_rects);
+      rect_in_tile.set_origin(key.rect.origin() - cell.OffsetFromOrigin());
+      key.rect = cell;
+      tile = rendered_tile_cache_->Get(key);
+      break;
     }
+    if (!tile)
+      return false;
   }
 
-  for (const auto& highlight : form_highlights_) {
-    gfx::Rect visible_selection =
-        gfx::IntersectRects(highlight, dirty_in_screen);
-    if (visible_selection.IsEmpty()) {
-      continue;
+  SkPixmap pixmap;
+  if (!tile->pixmap().extractSubset(&pixmap,
+                                    gfx::RectToSkIRect(rect_in_tile)) ||
+      !image_data.writePixels(pixmap, dirty_in_screen.x() + page_offset_.x(),
+                              dirty_in_screen.y())) {
+    return false;
+  }
+
+  DrawSelections(page_index, dirty_in_screen, image_data);
+  return true;
+}
+
+bool PDFiumEngine::PaintPlaceholder(int page_index,
+                                    const gfx::Rect& dirty_in_screen,
+                                    SkBitmap& image_data) {
+  auto it = page_placeholders_.find(page_index);
+  if (it == page_placeholders_.end())
+    return false;
+  placeholder_painted_pages_.insert(page_index);
+
+  // Like PaintUnavailablePage(), only cover the page itself. The borders and
+  // shadow get painted along with the full quality rendering. Match the
+  // horizontal offset GetRegion() applies to screen coordinates.
+  const gfx::Vector2d offset(page_offset_.x(), 0);
+  SkCanvas canvas(image_data);
+  canvas.clipRect(gfx::RectToSkRect(dirty_in_screen + offset));
+  canvas.drawImageRect(
+      it->second.asImage(),
+      gfx::RectToSkRect(GetScreenRect(pages_[page_index]->rect()) + offset),
+      SkSamplingOptions(SkFilterMode::kLinear));
+  return true;
+}
+
+bool PDFiumEngine::IsPlaceholderPending(int page_index) const {
+  return placeholder_render_ && placeholder_render_->page_index == page_index;
+}
+
+bool PDFiumEngine::RenderPlaceholder(int page_index) {
+  if (page_placeholders_.contains(page_index))
+    return true;
+  if (placeholder_render_ && placeholder_render_->page_index != page_index)
+    return false;
+
+  if (!placeholder_render_) {
+    placeholder_render_.emplace();
+    placeholder_render_->page_index = page_index;
+  }
+
+  FPDF_PAGE page = pages_[page_index]->GetPage();
+  last_progressive_start_time_ = base::TimeTicks::Now();
+  progressive_paint_timeout_ = kPlaceholderRenderTime;
+  int rv = FPDF_RENDER_FAILED;
+  if (!placeholder_render_->bitmap && IsPrefetchingPage(page_index))
+    CancelPrefetchPaint();
+  if (placeholder_render_->bitmap) {
+    rv = FPDF_RenderPage_Continue(page, this);
+  } else if (GetProgressiveIndex(page_index) == -1) {
+    // Size the placeholder from the page on screen, so it stays cheap to
+    // render at low zoom levels.
+    const gfx::Size page_size =
+        GetScreenRect(pages_[page_index]->rect()).size();
+    const int width =
+        std::max(1, static_cast<int>(page_size.width() * kPlaceholderScale));
+    const int height =
+        std::max(1, static_cast<int>(page_size.height() * kPlaceholderScale));
+
+    SkBitmap& placeholder = placeholder_render_->placeholder;
+    if (placeholder.tryAllocN32Pixels(width, height, /*isOpaque=*/true)) {
+      placeholder_render_->bitmap.reset(FPDFBitmap_CreateEx(
+          width, height, FPDFBitmap_BGRx, placeholder.getPixels(),
+          base::checked_cast<int>(placeholder.rowBytes())));
+      FPDFBitmap_FillRect(placeholder_render_->bitmap.get(), 0, 0, width,
+                          height, 0xFFFFFFFF);
+      rv = FPDF_RenderPageBitmap_Start(
+          placeholder_render_->bitmap.get(), page, 0, 0, width, height,
+          ToPDFiumRotation(layout_.options().default_page_orientation()),
+          GetRenderingFlags(), this);
     }
+  }
+
+  if (rv == FPDF_RENDER_TOBECONTINUED)
+    return false;
+
+  if (placeholder_render_->bitmap)
+    FPDF_RenderPage_Close(page);
+  if (rv == FPDF_RENDER_DONE) {
+    page_placeholders_[page_index] =
+        std::move(placeholder_render_->placeholder);
+  } else {
+    // Render the page at full quality right away instead.
+    refining_pages_.insert(page_index);
+  }
+  placeholder_render_.reset();
+  return true;
+}
+
+void PDFiumEngine::CancelPlaceholder(int page_index) {
+  if (placeholder_render_ && placeholder_render_->page_index == page_index) {
+    if (placeholder_render_->bitmap)
+      FPDF_RenderPage_Close(pages_[page_index]->GetPage());
+    placeholder_render_.reset();
+  }
+  page_placeholders_.erase(page_index);
+  placeholder_painted_pages_.erase(page_index);
+}
+
+void PDFiumEngine::CancelPlaceholders() {
+  if (placeholder_render_) {
+    if (placeholder_render_->bitmap)
+      FPDF_RenderPage_Close(pages_[placeholder_render_->page_index]->GetPage());
+    placeholder_render_.reset();
+  }
+  page_placeholders_.clear();
+  placeholder_painted_pages_.clear();
+}
+
+void PDFiumEngine::UpdatePrefetch(int scroll_delta) {
+  if (!prefetch_enabled_ || scroll_delta == 0 || plugin_size().IsEmpty())
+    return;
+
+  const int direction = scroll_delta > 0 ? 1 : -1;
+  if (direction != prefetch_direction_) {
+    // Whatever is queued is behind the viewport now.
+    CancelPrefetch();
+    prefetch_direction_ = direction;
+  }
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta elapsed = now - last_scroll_time_;
+  last_scroll_time_ = now;
+
+  // Prefetch one page ahead, plus another one for every viewport height per
+  // second the view scrolls at.
+  int num_pages = 1;
+  if (elapsed.is_positive()) {
+    const double viewports_per_second =
+        std::abs(scroll_delta) / elapsed.InSecondsF() / plugin_size().height();
+    num_pages += static_cast<int>(
+        std::min(viewports_per_second, static_cast<double>(kMaxPrefetchPages)));
+  }
+  SchedulePrefetch(std::min(num_pages, kMaxPrefetchPages));
+}
+
+void PDFiumEngine::SchedulePrefetch(int num_pages) {
+  DCHECK_NE(prefetch_direction_, 0);
+
+  prefetch_tiles_.clear();
+  if (visible_pages_.empty())
+    return;
 
-    visible_selection.Offset(-dirty_in_screen.OffsetFromOrigin());
-    Highlight(region.value(), visible_selection, kHighlightColor,
-              highlighted_rects);
+  int page_index = prefetch_direction_ > 0 ? visible_pages_.back() + 1
+                                           : visible_pages_.front() - 1;
+  size_t size_in_bytes = 0;
+  bool over_budget = false;
+  for (int i = 0;
+       i < num_pages && !over_budget && PageIndexInBounds(page_index);
+       ++i, page_index += prefetch_direction_) {
+    // Do not trigger downloads for pages the user may never look at.
+    if (!pages_[page_index]->available())
+      break;
+
+    std::vector<gfx::Rect> tiles = draw_utils::GetTilesForRect(
+        gfx::Rect(GetPageScreenRect(page_index).size()), gfx::Point(),
+        kRenderTileSize);
+
+    // Start with the edge of the page closest to the viewport.
+    if (prefetch_direction_ < 0)
+      std::reverse(tiles.begin(), tiles.end());
+
+    for (const gfx::Rect& tile : tiles) {
+      size_in_bytes += static_cast<size_t>(tile.width()) * tile.height() * 4;
+      if (size_in_bytes > kMaxPrefetchSizeInBytes) {
+        over_budget = true;
+        break;
+      }
+      prefetch_tiles_.emplace_back(page_index, tile);
+    }
+  }
+
+  if (prefetch_tiles_.empty() || prefetch_weak_factory_.HasWeakPtrs())
+    return;
+
+  base::SingleThreadTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(&PDFiumEngine::ContinuePrefetch,
+                                prefetch_weak_factory_.GetWeakPtr()));
+}
+
+void PDFiumEngine::CancelPrefetch() {
+  prefetch_weak_factory_.InvalidateWeakPtrs();
+  CancelPrefetchPaint();
+  prefetch_tiles_.clear();
+  prefetch_image_data_.reset();
+}
+
+void PDFiumEngine::ContinuePrefetch() {
+  if (prefetch_tiles_.empty())
+    return;
+
+  const auto& [page_index, tile] = prefetch_tiles_.front();
+  if (RenderPrefetchTile(page_index, tile))
+    prefetch_tiles_.erase(prefetch_tiles_.begin());
+
+  if (prefetch_tiles_.empty()) {
+    prefetch_image_data_.reset();
+    return;
   }
+
+  base::SingleThreadTaskRunner::GetCurrentDefault()->PostTask(
+      FROM_HERE, base::BindOnce(&PDFiumEngine::ContinuePrefetch,
+                                prefetch_weak_factory_.GetWeakPtr()));
+}
+
+bool PDFiumEngine::RenderPrefetchTile(int page_index, const gfx::Rect& tile) {
+  DCHECK(rendered_tile_cache_);
+
+  // The queue changed since the tile being rendered was started.
+  if (prefetch_paint_ && (prefetch_paint_->paint.page_index() != page_index ||
+                          prefetch_paint_->tile != tile)) {
+    CancelPrefetchPaint();
+  }
+
+  // The page is visible, and gets painted on screen instead. It also cannot
+  // render while its placeholder does.
+  if (GetProgressiveIndex(page_index) != -1 || IsPlaceholderPending(page_index))
+    return true;
+
+  gfx::Rect page_rect_in_screen = GetPageScreenRect(page_index);
+  if (!prefetch_paint_) {
+    if (rendered_tile_cache_->Contains(GetRenderedTileKey(
+            page_index, tile + page_rect_in_screen.OffsetFromOrigin()))) {
+      return true;
+    }
+
+    const gfx::Size size = plugin_size();
+    if (!gfx::Rect(size).Contains(gfx::Rect(tile.size())))
+      return true;
+
+    if (prefetch_image_data_.width() != size.width() ||
+        prefetch_image_data_.height() != size.height()) {
+      if (!prefetch_image_data_.tryAllocN32Pixels(size.width(), size.height()))
+        return true;
+    }
+  }
+
+  // The painting code works in screen coordinates, so pretend the view is
+  // scrolled such that the tile is at the top-left corner of the scratch
+  // image. This is not observable, since it only lasts for this call, and
+  // gets set up the same way again when rendering continues.
+  base::AutoReset<gfx::Point> scoped_position(
+      &position_, position_ + page_rect_in_screen.OffsetFromOrigin() +
+                      tile.OffsetFromOrigin());
+  base::AutoReset<gfx::Vector2d> scoped_page_offset(&page_offset_,
+                                                    gfx::Vector2d());
+  if (!prefetch_paint_) {
+    prefetch_paint_.emplace(
+        pages_[page_index].get(), tile,
+        tile + GetPageScreenRect(page_index).OffsetFromOrigin());
+  }
+
+  progressive_paint_timeout_ = kPrefetchRenderTime;
+  if (!ContinuePaint(prefetch_paint_->paint, prefetch_image_data_))
+    return false;
+
+  // Caches the tile.
+  FinishPaint(prefetch_paint_->paint, prefetch_image_data_);
+  prefetch_paint_.reset();
+  return true;
+}
+
+bool PDFiumEngine::IsPrefetchingPage(int page_index) const {
+  return prefetch_paint_ && prefetch_paint_->paint.page_index() == page_index;
+}
+
+void PDFiumEngine::CancelPrefetchPaint() {
+  if (!prefetch_paint_)
+    return;
+
+  FPDF_RenderPage_Close(pages_[prefetch_paint_->paint.page_index()]->GetPage());
+  prefetch_paint_.reset();
+}
+
+void PDFiumEngine::InvalidateCachedTiles(int page_index) {
+  if (rendered_tile_cache_)
+    rendered_tile_cache_->InvalidatePage(page_index);
+}
+
+void PDFiumEngine::InvalidateAllCachedTiles() {
+  if (rendered_tile_cache_)
+    rendered_tile_cache_->Clear();
 }
 
 void PDFiumEngine::PaintUnavailablePage(int page_index,
@@ -3484,55 +4465,6 @@ gfx::RectF PDFiumEngine::GetPageBoundingBox(int page_index) {
   return page->GetBoundingBox();
 }
 
-void PDFiumEngine::Highlight(const RegionData& region,
-                             const gfx::Rect& rect,
-                             SkColor color,
-                             std::vector<gfx::Rect>& highlighted_rects) const {
-  gfx::Rect new_rect = rect;
-  for (const auto& highlighted : highlighted_rects) {
-    new_rect.Subtract(highlighted);
-  }
-  if (new_rect.IsEmpty()) {
-    return;
-  }
-
-  std::vector<size_t> overlapping_rect_indices;
-  for (size_t i = 0; i < highlighted_rects.size(); ++i) {
-    if (new_rect.Intersects((highlighted_rects)[i])) {
-      overlapping_rect_indices.push_back(i);
-    }
-  }
-
-  highlighted_rects.push_back(new_rect);
-  int l = new_rect.x();
-  int t = new_rect.y();
-  int w = new_rect.width();
-  int h = new_rect.height();
-  SkColor4f color_f = SkColor4f::FromColor(color);
-  for (int y = t; y < t + h; ++y) {
-    base::span<uint8_t> row =
-        region.buffer.subspan(y * region.stride, region.stride);
-    for (int x = l; x < l + w; ++x) {
-      bool overlaps = false;
-      for (size_t i : overlapping_rect_indices) {
-        const auto& highlighted = (highlighted_rects)[i];
-        if (highlighted.Contains(x, y)) {
-          overlaps = true;
-          break;
-        }
-      }
-      if (overlaps) {
-        continue;
-      }
-
-      uint8_t* pixel = row.data() + x * 4;
-      pixel[0] = static_cast<uint8_t>(pixel[0] * color_f.fB);
-      pixel[1] = static_cast<uint8_t>(pixel[1] * color_f.fG);
-      pixel[2] = static_cast<uint8_t>(pixel[2] * color_f.fR);
-    }
-  }
-}
-
 PDFiumEngine::SelectionChangeInvalidator::SelectionChangeInvalidator(
     PDFiumEngine* engine)
     : engine_(engine),
@@ -3713,10 +4645,13 @@ void PDFiumEngine::DrawPageShadow(const gfx::Rect& page_rc,
                              shadow_rect.bottom() - page_rect.bottom()});
   depth = static_cast<uint32_t>(depth * 1.5) + 1;
 
-  // We need to check depth only to verify our copy of shadow matrix is correct.
-  if (!page_shadow_ || page_shadow_->depth() != depth) {
-    page_shadow_ = std::make_unique<draw_utils::ShadowMatrix>(
-        depth, factor, client_->GetBackgroundColor());
+  // We need to check depth and background only to verify our copy of shadow
+  // matrix is correct.
+  const SkColor background_color = client_->GetBackgroundColor();
+  if (!page_shadow_ || page_shadow_->depth() != depth ||
+      page_shadow_->background() != background_color) {
+    page_shadow_ = std::make_unique<draw_utils::ShadowMatrix>(depth, factor,
+                                                              background_color);
   }
 
   DCHECK(!image_data.isNull());
@@ -3896,7 +4831,7 @@ bool PDFiumEngine::IsPageCharacterIndexInBounds(
 
 FPDF_BOOL PDFiumEngine::Pause_NeedToPauseNow(IFSDK_PAUSE* param) {
   PDFiumEngine* engine = static_cast<PDFiumEngine*>(param);
-  return base::Time::Now() - engine->last_progressive_start_time_ >
+  return base::TimeTicks::Now() - engine->last_progressive_start_time_ >
          engine->progressive_paint_timeout_;
 }
 
@@ -4282,7 +5217,11 @@ void PDFiumEngine::RequestThumbnail(int page_index,
   // Thumbnails cannot be generated in the middle of a progressive paint of a
   // page. Generate the thumbnail immediately only if the page is not currently
   // being progressively painted. Otherwise, wait for progressive painting to
-  // finish.
+  // finish. A placeholder render of the page can simply start over later.
+  if (placeholder_render_ && placeholder_render_->page_index == page_index)
+    CancelPlaceholder(page_index);
+  if (IsPrefetchingPage(page_index))
+    CancelPrefetchPaint();
   const int progressive_index = GetProgressiveIndex(page_index);
   if (progressive_index == -1) {
     pages_[page_index]->RequestThumbnail(device_pixel_ratio,
@@ -4330,6 +5269,35 @@ void PDFiumEngine::ProgressivePaint::SetBitmapAndImageData(
   image_data_ = std::move(image_data);
 }
 
+PDFiumEngine::PrefetchPaint::PrefetchPaint(PDFiumPage* page,
+                                           const gfx::Rect& tile,
+                                           const gfx::Rect& dirty_in_screen)
+    : tile(tile),
+      paint(page->index(), dirty_in_screen),
+      unload_preventer(page) {}
+
+PDFiumEngine::PrefetchPaint::~PrefetchPaint() = default;
+
+PDFiumEngine::PlaceholderRender::PlaceholderRender() = default;
+
+PDFiumEngine::PlaceholderRender::PlaceholderRender(
+    PlaceholderRender&& other) noexcept = default;
+
+PDFiumEngine::PlaceholderRender& PDFiumEngine::PlaceholderRender::operator=(
+    PlaceholderRender&& other) noexcept = default;
+
+PDFiumEngine::PlaceholderRender::~PlaceholderRender() = default;
+
+PDFiumEngine::ParallelFind::ParallelFind() = default;
+
+PDFiumEngine::ParallelFind::ParallelFind(ParallelFind&& other) noexcept =
+    default;
+
+PDFiumEngine::ParallelFind& PDFiumEngine::ParallelFind::operator=(
+    ParallelFind&& other) noexcept = default;
+
+PDFiumEngine::ParallelFind::~ParallelFind() = default;
+
 PDFiumEngine::PendingThumbnail::PendingThumbnail() = default;
 
 PDFiumEngine::PendingThumbnail::PendingThumbnail(PendingThumbnail&& that) =
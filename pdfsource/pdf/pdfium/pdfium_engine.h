@@ -12,9 +12,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
 #include "base/containers/span.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/raw_span.h"
@@ -31,6 +33,9 @@
 #include "pdf/pdfium/pdfium_page.h"
 #include "pdf/pdfium/pdfium_print.h"
 #include "pdf/pdfium/pdfium_range.h"
+#include "pdf/pdfium/pdfium_text_index.h"
+#include "pdf/pdfium/pdfium_text_matcher.h"
+#include "pdf/rendered_tile_cache.h"
 #include "third_party/pdfium/public/cpp/fpdf_scopers.h"
 #include "third_party/pdfium/public/fpdf_formfill.h"
 #include "third_party/pdfium/public/fpdf_progressive.h"
@@ -84,6 +89,13 @@ class PDFiumEngine : public PDFEngine,
   // HandleDocumentLoad().
   void SetDocumentLoaderForTesting(std::unique_ptr<DocumentLoader> loader);
 
+  // Returns the number of tiles in the rendered tile cache, or 0 if it is
+  // disabled.
+  size_t GetCachedTileCountForTesting() const;
+
+  // Returns the timeout of the last progressive paint slice.
+  base::TimeDelta GetProgressivePaintTimeoutForTesting() const;
+
   // Returns the FontMappingMode set during PDFium SDK initialization.
   static FontMappingMode GetFontMappingMode();
 
@@ -97,10 +109,11 @@ class PDFiumEngine : public PDFEngine,
   void PluginSizeUpdated(const gfx::Size& size) override;
   void ScrolledToXPosition(int position) override;
   void ScrolledToYPosition(int position) override;
-  void PrePaint() override;
+  void PrePaint(const std::vector<gfx::Rect>& rects) override;
   void Paint(const gfx::Rect& rect,
              SkBitmap& image_data,
              std::vector<gfx::Rect>& ready,
+             std::vector<gfx::Rect>& ready_now,
              std::vector<gfx::Rect>& pending) override;
   void PostPaint() override;
   bool HandleInputEvent(const blink::WebInputEvent& event) override;
@@ -144,6 +157,7 @@ class PDFiumEngine : public PDFEngine,
       const std::string& destination) override;
   int GetMostVisiblePage() override;
   bool IsPageVisible(int index) const override;
+  std::vector<int> GetVisiblePages() const override;
   PageOrientation GetCurrentOrientation() const override;
   gfx::Rect GetPageBoundsRect(int index) override;
   gfx::Rect GetPageContentsRect(int index) override;
@@ -190,6 +204,7 @@ class PDFiumEngine : public PDFEngine,
   bool IsPDFDocTagged() override;
   uint32_t GetLoadedByteSize() override;
   bool ReadLoadedBytes(uint32_t length, void* buffer) override;
+  base::span<const uint8_t> GetLoadedBytes() override;
   void RequestThumbnail(int page_index,
                         float device_pixel_ratio,
                         SendThumbnailCallback send_callback) override;
@@ -218,6 +233,8 @@ class PDFiumEngine : public PDFEngine,
   bool IsValidLink(const std::string& url);
 
  private:
+  class ProgressivePaint;
+
   // This helper class is used to detect the difference in selection between
   // construction and destruction.  At destruction, it invalidates all the
   // parts that are newly selected, along with all the parts that used to be
@@ -385,9 +402,61 @@ class PDFiumEngine : public PDFEngine,
   // Called to continue searching so we don't block the main thread.
   void ContinueFind(bool case_sensitive);
 
-  // Inserts a find result into `find_results_`, which is sorted.
+  // If the previous search finished and `text` extends its text, narrows its
+  // results down to the ones that still match, instead of searching the whole
+  // document again. Returns false if the previous results cannot be reused.
+  bool RefineFind(const std::u16string& text, bool case_sensitive);
+
+  // Returns whether two matches of `term` may overlap, in which case a search
+  // finds only the first of them.
+  bool CanFindTermOverlap(const std::u16string& term, bool case_sensitive);
+
+  // Ends the current search once every page has been searched. If the
+  // PdfCrossPageFind feature is enabled and every page is in `text_index_`,
+  // first looks for the matches of `term` that continue on the pages after the
+  // one they start on, on the thread pool.
+  void FinishFind(const std::u16string& term, bool case_sensitive);
+
+  // Called with the matches FinishFind() found across pages. Adds them to
+  // `find_results_`, and sends the final notification.
+  void OnCrossPageMatchesFound(std::vector<CrossPageMatch> matches);
+
+  // Searches all pages of `text_index_` for `text` on the thread pool, instead
+  // of one page per task like StartFind() does otherwise.
+  void StartParallelFind(const std::u16string& text, bool case_sensitive);
+
+  // Called with the matches of the pages of the shard at `shard_index` of the
+  // current parallel find. Adds the matches of all shards up to the first one
+  // that is still pending to `find_results_`.
+  void OnFindShardSearched(
+      size_t shard_index,
+      std::vector<std::vector<PDFEngine::Client::SearchStringResult>> matches);
+
+  // Makes ContinueTextIndexing() check `page_index` again, and schedules it if
+  // it is not scheduled yet. Called whenever a page becomes available or its
+  // text changes, so pages that were not available when indexing got to them
+  // are indexed once their data arrives. Does nothing if the PdfFindTextIndex
+  // feature is disabled or before the document finished loading.
+  void ScheduleTextIndexing(size_t page_index);
+
+  // Adds the next page that is not in `text_index_` yet, one page per task so
+  // we don't block the main thread. Only used if the PdfFindTextIndex feature
+  // is enabled.
+  void ContinueTextIndexing();
+
+  // Inserts a find result into `find_results_`, which is sorted. If the
+  // PdfBatchedFindUpdates feature is enabled, leaves updating the tick marks
+  // and the result count to SendFindResultUpdates().
   void AddFindResult(const PDFiumRange& result);
 
+  // Returns whether `range` overlaps one of `find_results_`, or a part on a
+  // later page of one that spans pages.
+  bool OverlapsFindResult(const PDFiumRange& range) const;
+
+  // Updates the tick marks and sends the result count, if AddFindResult() added
+  // any results since the last time. Always sends the count if `final_result`.
+  void SendFindResultUpdates(bool final_result);
+
   // Search a page using PDFium's methods.  Doesn't work with unicode.  This
   // function is just kept arount in case PDFium code is fixed.
   void SearchUsingPDFium(const std::u16string& term,
@@ -450,11 +519,44 @@ class PDFiumEngine : public PDFEngine,
 
   // Continues a paint operation that was started earlier.  Returns true if the
   // paint is done, or false if it needs to be continued.
-  bool ContinuePaint(int progressive_index, SkBitmap& image_data);
+  bool ContinuePaint(ProgressivePaint& paint, SkBitmap& image_data);
 
   // Called once PDFium is finished rendering a page so that we draw our
-  // borders, highlighting etc.
-  void FinishPaint(int progressive_index, SkBitmap& image_data);
+  // borders, highlighting etc. The caller then drops `paint`.
+  void FinishPaint(const ProgressivePaint& paint, SkBitmap& image_data);
+
+  // Renders `dirty`, a rectangle in screen coordinates within the page at
+  // `page_index`, starting or continuing a progressive paint as needed.
+  // Appends `dirty` to `ready` if rendering finished, or to `pending`
+  // otherwise. Also appends it to `ready_now` if a placeholder got painted
+  // meanwhile.
+  void PaintPageRect(int page_index,
+                     const gfx::Rect& dirty,
+                     SkBitmap& image_data,
+                     std::vector<gfx::Rect>& ready,
+                     std::vector<gfx::Rect>& ready_now,
+                     std::vector<gfx::Rect>& pending);
+
+  // Returns how long the next slice of the progressive paint at
+  // `progressive_index` may run before PDFium pauses. `new_paint` is whether
+  // the paint was just started.
+  base::TimeDelta GetProgressivePaintTimeout(int progressive_index,
+                                             bool new_paint) const;
+
+  // Returns how long a round of paints may take in total. With adaptive paint
+  // scheduling, this is shorter while the user scrolls or zooms, so the view
+  // keeps up with the input.
+  base::TimeDelta GetPaintFrameBudget() const;
+
+  // Returns when the page being painted should stop starting new work, so the
+  // rest of the round of paints stays within the frame budget.
+  base::TimeTicks GetPaintDeadline() const;
+
+  // With interleaved page rendering, returns the end of the share of the round
+  // of paints for the page at `page_index`. The first time a page gets painted
+  // in the round, it gets an even share of the time left between it and the
+  // round's other pages that have not been painted yet.
+  base::TimeTicks GetPageShareDeadline(int page_index);
 
   // Stops any paints that are in progress.
   void CancelPaints();
@@ -465,12 +567,86 @@ class PDFiumEngine : public PDFEngine,
 
   // If the page is narrower than the document size, paint the extra space
   // with the page background.
-  void FillPageSides(int progressive_index);
+  void FillPageSides(const ProgressivePaint& paint);
 
-  void PaintPageShadow(int progressive_index, SkBitmap& image_data);
+  void PaintPageShadow(const ProgressivePaint& paint, SkBitmap& image_data);
 
-  // Highlight visible find results and selections.
-  void DrawSelections(int progressive_index, SkBitmap& image_data) const;
+  // Highlight visible find results and selections within `dirty_in_screen` on
+  // the page at `page_index`.
+  void DrawSelections(int page_index,
+                      const gfx::Rect& dirty_in_screen,
+                      SkBitmap& image_data) const;
+
+  // Returns the key that identifies `dirty_in_screen`, a rectangle within the
+  // page at `page_index`, in `rendered_tile_cache_` given the current zoom and
+  // rendering options.
+  RenderedTileCache::Key GetRenderedTileKey(
+      int page_index,
+      const gfx::Rect& dirty_in_screen) const;
+
+  // Copies `dirty_in_screen` from `rendered_tile_cache_` into `image_data` and
+  // draws selections on top. Returns false if the tile is not cached.
+  bool PaintFromTileCache(int page_index,
+                          const gfx::Rect& dirty_in_screen,
+                          SkBitmap& image_data);
+
+  // Paints the low-resolution approximation of the page at `page_index`
+  // within `dirty_in_screen`. Returns false if the page has no placeholder.
+  bool PaintPlaceholder(int page_index,
+                        const gfx::Rect& dirty_in_screen,
+                        SkBitmap& image_data);
+
+  // Returns whether the placeholder of the page at `page_index` is being
+  // rendered. PDFium can only render a page one way at a time, so the page
+  // cannot be rendered at full quality meanwhile.
+  bool IsPlaceholderPending(int page_index) const;
+
+  // Renders the placeholder of the page at `page_index` progressively, for a
+  // bounded amount of time, so rendering it never blocks a paint. Returns
+  // whether the page is done with its placeholder, which is then either in
+  // `page_placeholders_`, or failed to render, and the page gets rendered at
+  // full quality right away. Only one placeholder renders at a time, so
+  // returns false while another page's placeholder is rendering.
+  bool RenderPlaceholder(int page_index);
+
+  // Stops rendering the placeholder of the page at `page_index`, and drops it.
+  void CancelPlaceholder(int page_index);
+
+  // Stops rendering placeholders, and drops all of them.
+  void CancelPlaceholders();
+
+  // Called when the view scrolls vertically by `scroll_delta`. Tracks the
+  // scroll direction and velocity, and schedules prefetching of the pages
+  // ahead of the viewport.
+  void UpdatePrefetch(int scroll_delta);
+
+  // Queues the tiles of the `num_pages` pages after the visible ones, in the
+  // current scroll direction, up to the prefetch memory budget.
+  void SchedulePrefetch(int num_pages);
+
+  // Stops prefetching and drops the queued tiles.
+  void CancelPrefetch();
+
+  // Renders the next queued tile for a bounded amount of time, then posts a
+  // task to continue with the rest of the queue.
+  void ContinuePrefetch();
+
+  // Renders the tile at `tile`, relative to the page at `page_index`, into
+  // `rendered_tile_cache_`. Returns false if rendering needs to be continued.
+  bool RenderPrefetchTile(int page_index, const gfx::Rect& tile);
+
+  // Returns whether a prefetched tile of the page at `page_index` is being
+  // rendered.
+  bool IsPrefetchingPage(int page_index) const;
+
+  // Stops rendering the prefetched tile, if any. Needed before the page gets
+  // rendered some other way, since PDFium renders a page one way at a time.
+  void CancelPrefetchPaint();
+
+  // Drops cached tiles of the page at `page_index`, or of all pages, after
+  // their contents changed.
+  void InvalidateCachedTiles(int page_index);
+  void InvalidateAllCachedTiles();
 
   // Paints an page that hasn't finished downloading.
   void PaintUnavailablePage(int page_index,
@@ -505,14 +681,6 @@ class PDFiumEngine : public PDFEngine,
   // coordinates. (i.e. 0,0 is top left corner of plugin area)
   gfx::Rect GetScreenRect(const gfx::Rect& rect) const;
 
-  // Given an image `region`, highlights `rect`.
-  // `highlighted_rects` contains the already highlighted rectangles and will be
-  // updated to include `rect` if `rect` has not already been highlighted.
-  void Highlight(const RegionData& region,
-                 const gfx::Rect& rect,
-                 SkColor color,
-                 std::vector<gfx::Rect>& highlighted_rects) const;
-
   // Helper function to convert a device to page coordinates.  If the page is
   // not yet loaded, `page_x` and `page_y` will be set to 0.
   void DeviceToPage(int page_index,
@@ -712,6 +880,13 @@ class PDFiumEngine : public PDFEngine,
 
   // The current text used for searching.
   std::u16string current_find_text_;
+  // Whether the current search is case sensitive.
+  bool current_find_case_sensitive_ = false;
+  // Whether find sends the tick marks and result count once per task, rather
+  // than for every result.
+  bool batch_find_updates_enabled_ = false;
+  // Whether AddFindResult() added results that have not been sent yet.
+  bool find_result_updates_pending_ = false;
   // The results found.
   std::vector<PDFiumRange> find_results_;
   // Whether a search is in progress.
@@ -725,6 +900,46 @@ class PDFiumEngine : public PDFEngine,
   std::optional<size_t> current_find_index_;
   // Where to resume searching. (0-based)
   std::optional<size_t> resume_find_index_;
+  // Whether searches keep the text of the pages in `text_index_`.
+  bool find_text_index_enabled_ = false;
+  // The text of the pages searched so far, or indexed after loading.
+  PDFiumTextIndex text_index_;
+  // Which page ContinueTextIndexing() checks next.
+  size_t next_page_to_index_ = 0;
+  // Whether a ContinueTextIndexing() task is posted.
+  bool text_indexing_scheduled_ = false;
+  // Whether searches of a completely indexed document run on the thread pool.
+  bool parallel_find_enabled_ = false;
+  // Whether searches also find matches that continue on the next pages.
+  bool cross_page_find_enabled_ = false;
+  // The parts on the following pages of the results in `find_results_` that
+  // span pages, by the page and character index of the result.
+  base::flat_map<std::pair<int, int>, std::vector<PDFiumRange>>
+      find_result_continuations_;
+  // Whether the current search is looking for matches across pages.
+  bool cross_page_find_in_progress_ = false;
+
+  // A search that runs on the thread pool.
+  struct ParallelFind {
+    ParallelFind();
+    ParallelFind(ParallelFind&& other) noexcept;
+    ParallelFind& operator=(ParallelFind&& other) noexcept;
+    ~ParallelFind();
+
+    using PageMatches = std::vector<PDFEngine::Client::SearchStringResult>;
+
+    // The pages in the order the search covers them. Starts and ends with the
+    // same page if the search started from a selection.
+    std::vector<int> pages;
+
+    // The matches of each shard of `pages` that has not been added to
+    // `find_results_` yet, once the shard finished searching.
+    std::vector<std::optional<std::vector<PageMatches>>> shard_matches;
+
+    // The first shard that has not been added to `find_results_` yet.
+    size_t next_shard = 0;
+  };
+  std::optional<ParallelFind> parallel_find_;
 
   std::unique_ptr<PDFiumPermissions> permissions_;
 
@@ -793,8 +1008,10 @@ class PDFiumEngine : public PDFEngine,
     const gfx::Rect& rect() const { return rect_; }
     FPDF_BITMAP bitmap() const { return bitmap_.get(); }
     bool painted() const { return painted_; }
+    base::TimeDelta render_time() const { return render_time_; }
 
     void set_painted(bool enable) { painted_ = enable; }
+    void add_render_time(base::TimeDelta time) { render_time_ += time; }
     void SetBitmapAndImageData(ScopedFPDFBitmap bitmap, SkBitmap image_data);
 
    private:
@@ -805,19 +1022,125 @@ class PDFiumEngine : public PDFEngine,
     // Temporary used to figure out if in a series of Paint() calls whether this
     // pending paint was updated or not.
     bool painted_ = false;
+    // Total time spent in PDFium rendering this paint so far.
+    base::TimeDelta render_time_;
   };
   std::vector<ProgressivePaint> progressive_paints_;
 
   // Keeps track of when we started the last progressive paint, so that in our
   // callback we can determine if we need to pause.
-  base::Time last_progressive_start_time_;
+  base::TimeTicks last_progressive_start_time_;
 
   // The timeout to use for the current progressive paint.
   base::TimeDelta progressive_paint_timeout_;
 
+  // Whether dirty page regions are rendered as fixed-size tiles. PDFium is not
+  // thread-safe, so tiles are rendered one after another on this thread, and
+  // each round of paints stops starting new tiles once it runs out of time.
+  bool tiled_rendering_enabled_ = false;
+
+  // When the current round of paints started, set in PrePaint().
+  base::TimeTicks paint_frame_start_time_;
+
+  // Whether progressive paint slices are sized from the measured render cost of
+  // each page and the remaining frame budget, rather than fixed timeouts.
+  bool adaptive_paint_scheduling_enabled_ = false;
+
+  // When the user last scrolled or zoomed.
+  base::TimeTicks last_interaction_time_;
+
+  // Whether the pages painted in a round of paints share its frame budget
+  // evenly, so visible pages fill in together rather than one at a time.
+  bool interleaved_page_rendering_enabled_ = false;
+
+  // With interleaved page rendering, the end of the current page's share of
+  // the round of paints.
+  base::TimeTicks page_paint_deadline_;
+
+  // With interleaved page rendering, the end of the share of each page painted
+  // so far in the current round of paints.
+  base::flat_map<int, base::TimeTicks> page_share_deadlines_;
+
+  // With interleaved page rendering, how many pages that the current round of
+  // paints covers have not been painted yet in it.
+  size_t unpainted_page_count_ = 0;
+
   // Shadow matrix for generating the page shadow bitmap.
   std::unique_ptr<draw_utils::ShadowMatrix> page_shadow_;
 
+  // Whether pages entering the viewport first get a low-resolution placeholder
+  // before they are rendered at full quality.
+  bool placeholders_enabled_ = false;
+
+  // Rendered placeholders that have not been painted yet, by page index.
+  base::flat_map<int, SkBitmap> page_placeholders_;
+
+  // Pages that painted their placeholder during the current round of paints.
+  // Their placeholders get dropped in PostPaint(), once the pages move on to
+  // full quality rendering.
+  base::flat_set<int> placeholder_painted_pages_;
+
+  // A placeholder that is being rendered progressively.
+  struct PlaceholderRender {
+    PlaceholderRender();
+    PlaceholderRender(PlaceholderRender&& other) noexcept;
+    PlaceholderRender& operator=(PlaceholderRender&& other) noexcept;
+    ~PlaceholderRender();
+
+    int page_index = -1;
+
+    // The placeholder, and the PDFium bitmap that wraps its pixels once
+    // rendering started.
+    SkBitmap placeholder;
+    ScopedFPDFBitmap bitmap;
+  };
+  std::optional<PlaceholderRender> placeholder_render_;
+
+  // Visible pages that already showed their placeholder, and are now rendered
+  // at full quality.
+  base::flat_set<int> refining_pages_;
+
+  // Whether pages ahead of the viewport get rendered into
+  // `rendered_tile_cache_` while idle. Requires the tile cache.
+  bool prefetch_enabled_ = false;
+
+  // The last vertical scroll direction: 1 for down, -1 for up, 0 if unknown.
+  int prefetch_direction_ = 0;
+
+  // When the view last scrolled vertically, to estimate the scroll velocity.
+  base::TimeTicks last_scroll_time_;
+
+  // Tiles left to prefetch, in order, as page indices and tile rectangles
+  // relative to the page's screen rectangle.
+  std::vector<std::pair<int, gfx::Rect>> prefetch_tiles_;
+
+  // Scratch image that prefetched tiles get rendered into. Sized like the
+  // plugin, since painting code expects screen coordinates.
+  SkBitmap prefetch_image_data_;
+
+  // The prefetched tile being rendered. Kept apart from `progressive_paints_`,
+  // so paints of the visible pages neither cancel nor restart it, and it
+  // resumes where it left off in the next task.
+  struct PrefetchPaint {
+    PrefetchPaint(PDFiumPage* page,
+                  const gfx::Rect& tile,
+                  const gfx::Rect& dirty_in_screen);
+    ~PrefetchPaint();
+
+    // The tile, relative to the page's screen rectangle.
+    gfx::Rect tile;
+
+    ProgressivePaint paint;
+
+    // Keeps the page loaded while it is out of view.
+    PDFiumPage::ScopedUnloadPreventer unload_preventer;
+  };
+  std::optional<PrefetchPaint> prefetch_paint_;
+
+  // Cache of rendered tiles, before selections are drawn on top. Only set if
+  // the PdfTileCache feature is enabled.
+  std::unique_ptr<RenderedTileCache> rendered_tile_cache_;
+
   // Pending thumbnail requests.
   struct PendingThumbnail {
     PendingThumbnail();
@@ -843,6 +1166,10 @@ class PDFiumEngine : public PDFEngine,
   // downloading.
   bool process_when_pending_request_complete_ = true;
 
+  // Whether non-linearized documents get processed as their data comes in too.
+  // Otherwise, only linearized ones do.
+  bool read_ahead_enabled_ = false;
+
   enum class RangeSelectionDirection { Left, Right };
   RangeSelectionDirection range_selection_direction_ =
       RangeSelectionDirection::Right;
@@ -863,6 +1190,10 @@ class PDFiumEngine : public PDFEngine,
   // function. This allows those weak pointers to be invalidated during
   // StopFind(), and keeps the invalidation separated from `weak_factory_`.
   base::WeakPtrFactory<PDFiumEngine> find_weak_factory_{this};
+
+  // Weak pointers from this factory are used to bind the ContinuePrefetch()
+  // function, so CancelPrefetch() can invalidate them.
+  base::WeakPtrFactory<PDFiumEngine> prefetch_weak_factory_{this};
 };
 
 }  // namespace chrome_pdf
@@ -8,6 +8,7 @@
 #include <optional>
 #include <utility>
 
+#include "base/feature_list.h"
 #include "base/functional/bind.h"
 #include "base/memory/raw_span.h"
 #include "base/no_destructor.h"
@@ -16,6 +17,7 @@
 #include "pdf/document_metadata.h"
 #include "pdf/loader/document_loader.h"
 #include "pdf/loader/url_loader_wrapper.h"
+#include "pdf/pdf_features.h"
 #include "pdf/pdfium/pdfium_api_string_buffer_adapter.h"
 #include "pdf/pdfium/pdfium_document.h"
 #include "pdf/pdfium/pdfium_document_metadata.h"
@@ -74,6 +76,13 @@ class DataDocumentLoader : public DocumentLoader {
     memcpy(buf, copy_span.data(), copy_span.size());
     return true;
   }
+  base::span<const uint8_t> GetCompleteData() const override {
+    // Only have PDFium parse `pdf_data_` in place when it does so for the
+    // documents the viewer loads, too.
+    if (!base::FeatureList::IsEnabled(features::kPdfContiguousDocumentData))
+      return {};
+    return pdf_data_;
+  }
   bool IsDataAvailable(uint32_t position, uint32_t size) const override {
     CHECK_LE(position, GetDocumentSize());
     CHECK_LE(size, GetDocumentSize() - position);
@@ -11,7 +11,9 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "base/functional/callback.h"
 #include "base/hash/md5.h"
@@ -23,6 +25,7 @@
 #include "base/test/mock_callback.h"
 #include "base/test/scoped_feature_list.h"
 #include "base/time/time.h"
+#include "base/time/time_override.h"
 #include "build/build_config.h"
 #include "pdf/document_attachment_info.h"
 #include "pdf/document_layout.h"
@@ -40,17 +43,23 @@
 #include "third_party/blink/public/common/input/web_keyboard_event.h"
 #include "third_party/blink/public/common/input/web_mouse_event.h"
 #include "third_party/blink/public/common/input/web_pointer_properties.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
 #include "ui/events/keycodes/keyboard_codes.h"
 #include "ui/gfx/geometry/point.h"
 #include "ui/gfx/geometry/point_f.h"
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
+#include "ui/gfx/geometry/vector2d.h"
 
 namespace chrome_pdf {
 
 namespace {
 
 using ::testing::_;
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::InSequence;
 using ::testing::Invoke;
 using ::testing::IsEmpty;
@@ -58,6 +67,16 @@ using ::testing::NiceMock;
 using ::testing::Not;
 using ::testing::Return;
 using ::testing::StrictMock;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+// The time returned by FrozenTimeTicksNow(). Stays put unless a test moves it,
+// so paint slices can be checked against the time each round of paints has.
+base::TimeTicks g_frozen_time_ticks;
+
+base::TimeTicks FrozenTimeTicksNow() {
+  return g_frozen_time_ticks;
+}
 
 MATCHER_P2(LayoutWithSize, width, height, "") {
   return arg.size() == gfx::Size(width, height);
@@ -170,6 +189,24 @@ class PDFiumEngineTest : public PDFiumTestBase {
     return loaded_incrementally;
   }
 
+  // Repeatedly paints `rect` and whatever is left pending until nothing is,
+  // returning all the rectangles that became ready, whether right away or not.
+  std::vector<gfx::Rect> PaintUntilDone(PDFiumEngine& engine,
+                                        const gfx::Rect& rect,
+                                        SkBitmap& image_data) {
+    std::vector<gfx::Rect> to_paint = {rect};
+    std::vector<gfx::Rect> ready;
+    while (!to_paint.empty()) {
+      std::vector<gfx::Rect> pending;
+      engine.PrePaint(to_paint);
+      for (const gfx::Rect& paint_rect : to_paint)
+        engine.Paint(paint_rect, image_data, ready, ready, pending);
+      engine.PostPaint();
+      to_paint = std::move(pending);
+    }
+    return ready;
+  }
+
   void FinishWithPluginSizeUpdated(PDFiumEngine& engine) {
     engine.PluginSizeUpdated({});
 
@@ -630,6 +667,57 @@ TEST_P(PDFiumEngineTest, IncrementalLoadingFeatureDisabled) {
   EXPECT_FALSE(TryLoadIncrementally());
 }
 
+TEST_P(PDFiumEngineTest, ReadAheadNonLinearized) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfIncrementalLoading, features::kPdfNonLinearizedReadAhead},
+      {});
+
+  NiceMock<MockTestClient> client;
+  InitializeEngineResult initialize_result = InitializeEngineWithoutLoading(
+      &client, FILE_PATH_LITERAL("non_linearized_multi_pages.pdf"));
+  ASSERT_TRUE(initialize_result.engine);
+  PDFiumEngine& engine = *initialize_result.engine;
+  TestDocumentLoader& document_loader = *initialize_result.document_loader;
+
+  // The pages show up once the trailer, the cross-reference table and the
+  // page tree are in.
+  while (engine.GetNumberOfPages() == 0 &&
+         document_loader.SimulateLoadData(1024)) {
+  }
+  ASSERT_EQ(3, engine.GetNumberOfPages());
+  EXPECT_FALSE(document_loader.IsDocumentComplete());
+
+  // The first page comes in ahead of the large contents of the other pages.
+  engine.PluginSizeUpdated({1024, 4096});
+  while (!GetPDFiumPageForTest(engine, 0).available() &&
+         document_loader.SimulateLoadData(1024)) {
+  }
+  EXPECT_TRUE(GetPDFiumPageForTest(engine, 0).available());
+  EXPECT_FALSE(document_loader.IsDocumentComplete());
+
+  initialize_result.FinishLoading();
+  EXPECT_EQ(3, CountAvailablePages(engine));
+}
+
+TEST_P(PDFiumEngineTest, NoReadAheadNonLinearizedByDefault) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(features::kPdfIncrementalLoading);
+
+  NiceMock<MockTestClient> client;
+  InitializeEngineResult initialize_result = InitializeEngineWithoutLoading(
+      &client, FILE_PATH_LITERAL("non_linearized_multi_pages.pdf"));
+  ASSERT_TRUE(initialize_result.engine);
+  PDFiumEngine& engine = *initialize_result.engine;
+
+  // Nothing gets parsed before the whole file is in.
+  while (initialize_result.document_loader->SimulateLoadData(1024))
+    EXPECT_EQ(0, engine.GetNumberOfPages());
+
+  engine.PluginSizeUpdated({1024, 4096});
+  EXPECT_EQ(3, engine.GetNumberOfPages());
+}
+
 TEST_P(PDFiumEngineTest, RequestThumbnail) {
   TestClient client;
   std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
@@ -691,6 +779,486 @@ TEST_P(PDFiumEngineTest, RequestThumbnailLinearized) {
   initialize_result.FinishLoading();
 }
 
+TEST_P(PDFiumEngineTest, GetVisiblePages) {
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("rectangles_multi_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  engine->PluginSizeUpdated({400, 300});
+  EXPECT_THAT(engine->GetVisiblePages(), ElementsAre(0));
+
+  // Scroll to where the first two pages meet.
+  const int page_1_top = engine->GetPageScreenRect(1).y();
+  engine->ScrolledToYPosition(page_1_top - 10);
+  EXPECT_THAT(engine->GetVisiblePages(), ElementsAre(0, 1));
+}
+
+TEST_P(PDFiumEngineTest, PaintWithTiledRendering) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(features::kPdfTiledRendering);
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(1024, 1024);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+
+  std::vector<gfx::Rect> ready =
+      PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data);
+
+  // The page is larger than a single tile, so it gets painted in several
+  // non-overlapping pieces.
+  ASSERT_GT(ready.size(), 1u);
+  for (size_t i = 0; i < ready.size(); ++i) {
+    EXPECT_LE(ready[i].width(), 256);
+    EXPECT_LE(ready[i].height(), 256);
+    for (size_t j = i + 1; j < ready.size(); ++j)
+      EXPECT_FALSE(ready[i].Intersects(ready[j]));
+  }
+}
+
+TEST_P(PDFiumEngineTest, PaintWithTiledRenderingShowsTilesRightAway) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(features::kPdfTiledRendering);
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(1024, 1024);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+
+  // Finished tiles do not wait for the rest of the region.
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> ready_now;
+  std::vector<gfx::Rect> to_paint = {gfx::Rect(kPluginSize)};
+  while (!to_paint.empty()) {
+    std::vector<gfx::Rect> pending;
+    engine->PrePaint(to_paint);
+    for (const gfx::Rect& paint_rect : to_paint)
+      engine->Paint(paint_rect, image_data, ready, ready_now, pending);
+    engine->PostPaint();
+    to_paint = std::move(pending);
+  }
+  EXPECT_TRUE(ready.empty());
+  EXPECT_GT(ready_now.size(), 1u);
+}
+
+TEST_P(PDFiumEngineTest, PaintWithTileCache) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfTileCache, features::kPdfTiledRendering}, {});
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(400, 400);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap rendered;
+  rendered.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+  rendered.eraseColor(SK_ColorBLACK);
+  std::vector<gfx::Rect> rendered_rects =
+      PaintUntilDone(*engine, gfx::Rect(kPluginSize), rendered);
+
+  // Repainting the same region is served from the cache, in a single round
+  // of paints, with the same result.
+  SkBitmap cached;
+  cached.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+  cached.eraseColor(SK_ColorBLACK);
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> pending;
+  engine->PrePaint({gfx::Rect(kPluginSize)});
+  engine->Paint(gfx::Rect(kPluginSize), cached, ready, ready, pending);
+  engine->PostPaint();
+  EXPECT_TRUE(pending.empty());
+  EXPECT_THAT(ready, UnorderedElementsAreArray(rendered_rects));
+  for (const gfx::Rect& rect : ready) {
+    for (int y = rect.y(); y < rect.bottom(); ++y) {
+      for (int x = rect.x(); x < rect.right(); ++x)
+        ASSERT_EQ(rendered.getColor(x, y), cached.getColor(x, y));
+    }
+  }
+}
+
+TEST_P(PDFiumEngineTest, PaintWithTileCacheAndPageOffset) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfTileCache, features::kPdfTiledRendering}, {});
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  // Center the document horizontally, like the plugin does when the document
+  // is narrower than the plugin.
+  constexpr gfx::Size kPluginSize(400, 400);
+  constexpr gfx::Vector2d kPageOffset(60, 0);
+  engine->PluginSizeUpdated(kPluginSize);
+  engine->PageOffsetUpdated(kPageOffset);
+  const gfx::Size image_size = kPluginSize + gfx::Size(2 * kPageOffset.x(), 0);
+  SkBitmap rendered;
+  rendered.allocN32Pixels(image_size.width(), image_size.height());
+  rendered.eraseColor(SK_ColorBLACK);
+  std::vector<gfx::Rect> rendered_rects =
+      PaintUntilDone(*engine, gfx::Rect(kPluginSize), rendered);
+
+  // Tiles are cached from, and painted back to, the offset position.
+  SkBitmap cached;
+  cached.allocN32Pixels(image_size.width(), image_size.height());
+  cached.eraseColor(SK_ColorBLACK);
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> pending;
+  engine->PrePaint({gfx::Rect(kPluginSize)});
+  engine->Paint(gfx::Rect(kPluginSize), cached, ready, ready, pending);
+  engine->PostPaint();
+  EXPECT_TRUE(pending.empty());
+  EXPECT_THAT(ready, UnorderedElementsAreArray(rendered_rects));
+  for (int y = 0; y < image_size.height(); ++y) {
+    for (int x = 0; x < image_size.width(); ++x)
+      ASSERT_EQ(rendered.getColor(x, y), cached.getColor(x, y)) << x;
+  }
+}
+
+class BackgroundColorTestClient : public TestClient {
+ public:
+  BackgroundColorTestClient() = default;
+  ~BackgroundColorTestClient() override = default;
+  BackgroundColorTestClient(const BackgroundColorTestClient&) = delete;
+  BackgroundColorTestClient& operator=(const BackgroundColorTestClient&) =
+      delete;
+
+  void set_background_color(SkColor background_color) {
+    background_color_ = background_color;
+  }
+
+  // PDFEngine::Client:
+  SkColor GetBackgroundColor() const override { return background_color_; }
+
+ private:
+  SkColor background_color_ = SK_ColorTRANSPARENT;
+};
+
+TEST_P(PDFiumEngineTest, PaintWithTileCacheAfterBackgroundColorChange) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfTileCache, features::kPdfTiledRendering}, {});
+
+  BackgroundColorTestClient client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(400, 400);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+  ASSERT_FALSE(PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data)
+                   .empty());
+  const size_t tile_count = engine->GetCachedTileCountForTesting();
+  ASSERT_GT(tile_count, 0u);
+
+  // Repainting with the same background color is served from the cache.
+  PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data);
+  EXPECT_EQ(tile_count, engine->GetCachedTileCountForTesting());
+
+  // The tiles include the page sides and shadow drawn in the background color,
+  // so a new background color renders the tiles again.
+  client.set_background_color(SK_ColorGRAY);
+  PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data);
+  EXPECT_EQ(2 * tile_count, engine->GetCachedTileCountForTesting());
+}
+
+TEST_P(PDFiumEngineTest, PrefetchPagesInScrollDirection) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      {features::kPdfPrefetchRendering, features::kPdfTileCache}, {});
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("rectangles_multi_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  // Only the first page is visible.
+  engine->PluginSizeUpdated({400, 300});
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, engine->GetCachedTileCountForTesting());
+
+  // Scrolling down renders the next page while idle.
+  engine->ScrolledToYPosition(10);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_GT(engine->GetCachedTileCountForTesting(), 0u);
+}
+
+TEST_P(PDFiumEngineTest, PrefetchRequiresTileCache) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures({features::kPdfPrefetchRendering},
+                                       {features::kPdfTileCache});
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("rectangles_multi_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  engine->PluginSizeUpdated({400, 300});
+  engine->ScrolledToYPosition(10);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0u, engine->GetCachedTileCountForTesting());
+}
+
+class InvalidateTestClient : public TestClient {
+ public:
+  InvalidateTestClient() = default;
+  ~InvalidateTestClient() override = default;
+  InvalidateTestClient(const InvalidateTestClient&) = delete;
+  InvalidateTestClient& operator=(const InvalidateTestClient&) = delete;
+
+  // Mock PDFEngine::Client methods.
+  MOCK_METHOD(void, Invalidate, (const gfx::Rect&), (override));
+};
+
+TEST_P(PDFiumEngineTest, PaintWithLowResolutionPlaceholders) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(
+      features::kPdfLowResolutionPlaceholders);
+
+  NiceMock<InvalidateTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(400, 400);
+  constexpr gfx::Vector2d kPageOffset(60, 0);
+  engine->PluginSizeUpdated(kPluginSize);
+  engine->PageOffsetUpdated(kPageOffset);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width() + 2 * kPageOffset.x(),
+                            kPluginSize.height());
+  image_data.eraseColor(SK_ColorBLACK);
+
+  // The placeholder renders within the rounds of paints, and shows right away
+  // once it is ready, while the full quality paint is still pending. Showing
+  // it does not need another invalidation.
+  EXPECT_CALL(client, Invalidate).Times(0);
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> ready_now;
+  std::vector<gfx::Rect> pending;
+  do {
+    ready.clear();
+    pending.clear();
+    engine->PrePaint({gfx::Rect(kPluginSize)});
+    engine->Paint(gfx::Rect(kPluginSize), image_data, ready, ready_now,
+                  pending);
+    engine->PostPaint();
+  } while (ready_now.empty() && !pending.empty());
+  EXPECT_TRUE(ready.empty());
+  ASSERT_EQ(1u, ready_now.size());
+  EXPECT_THAT(pending, ElementsAreArray(ready_now));
+
+  // The placeholder shows at the page's offset position.
+  const gfx::Point page_center = engine->GetPageScreenRect(0).CenterPoint();
+  const int y = page_center.y();
+  EXPECT_EQ(SK_ColorBLACK, image_data.getColor(kPageOffset.x() / 2, y));
+  EXPECT_NE(SK_ColorBLACK,
+            image_data.getColor(page_center.x() + kPageOffset.x(), y));
+
+  // Subsequent paints render at full quality, without another placeholder.
+  EXPECT_THAT(PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data),
+              UnorderedElementsAreArray(ready_now));
+}
+
+TEST_P(PDFiumEngineTest, PaintLowResolutionPlaceholderWhileOtherPageIsPending) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(
+      features::kPdfLowResolutionPlaceholders);
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("rectangles_multi_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  // Only the first page is visible.
+  constexpr gfx::Size kPluginSize(400, 300);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+  ASSERT_FALSE(PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data)
+                   .empty());
+
+  // Scroll to where the first two pages meet. The first page's rect paints in
+  // the same rounds, but does not hold back the second page's placeholder,
+  // which shows right away.
+  const gfx::Rect page_1_rect = engine->GetPageScreenRect(1);
+  engine->ScrolledToYPosition(page_1_rect.y() - 10);
+  const gfx::Rect page_0_rect =
+      gfx::IntersectRects(engine->GetPageScreenRect(0), gfx::Rect(kPluginSize));
+  const gfx::Rect placeholder_rect =
+      gfx::IntersectRects(engine->GetPageScreenRect(1), gfx::Rect(kPluginSize));
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> ready_now;
+  std::vector<gfx::Rect> pending;
+  do {
+    pending.clear();
+    engine->PrePaint({page_0_rect, placeholder_rect});
+    engine->Paint(page_0_rect, image_data, ready, ready_now, pending);
+    engine->Paint(placeholder_rect, image_data, ready, ready_now, pending);
+    engine->PostPaint();
+  } while (ready_now.empty() && !pending.empty());
+  EXPECT_THAT(ready_now, ElementsAre(placeholder_rect));
+  EXPECT_THAT(pending, Contains(placeholder_rect));
+}
+
+TEST_P(PDFiumEngineTest, PaintWithAdaptivePaintScheduling) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(
+      features::kPdfAdaptivePaintScheduling);
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+
+  constexpr gfx::Size kPluginSize(1024, 1024);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+
+  // No render cost is known before the page gets rendered.
+  EXPECT_FALSE(
+      GetPDFiumPageForTest(*engine, 0).EstimateRenderTime(/*pixel_count=*/1));
+
+  // Scrolling switches to the shorter interactive frame budget, but the paint
+  // still completes over as many rounds as it needs.
+  engine->ScrolledToYPosition(0);
+  EXPECT_FALSE(
+      PaintUntilDone(*engine, gfx::Rect(kPluginSize), image_data).empty());
+
+  // Rendering the page recorded its render cost.
+  EXPECT_TRUE(
+      GetPDFiumPageForTest(*engine, 0).EstimateRenderTime(/*pixel_count=*/1));
+}
+
+TEST_P(PDFiumEngineTest, PaintWithAdaptivePaintSchedulingSizesSlices) {
+  constexpr gfx::Size kPluginSize(1024, 1024);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+
+  // Returns how long the first slice of a paint of the whole plugin may take.
+  // The clock is stopped, so the paint uses none of its time.
+  auto get_first_slice_timeout = [&image_data,
+                                   &kPluginSize](PDFiumEngine& engine) {
+    std::vector<gfx::Rect> ready;
+    std::vector<gfx::Rect> pending;
+    engine.PrePaint({gfx::Rect(kPluginSize)});
+    engine.Paint(gfx::Rect(kPluginSize), image_data, ready, ready, pending);
+    engine.PostPaint();
+    return engine.GetProgressivePaintTimeoutForTesting();
+  };
+
+  g_frozen_time_ticks = base::TimeTicks::Now();
+  base::subtle::ScopedTimeClockOverrides time_override(
+      /*time_override=*/nullptr, &FrozenTimeTicksNow,
+      /*thread_ticks_override=*/nullptr);
+
+  {
+    // Without the feature, every new paint gets the same fixed slice.
+    base::test::ScopedFeatureList scoped_feature_list;
+    scoped_feature_list.InitAndDisableFeature(
+        features::kPdfAdaptivePaintScheduling);
+    NiceMock<MockTestClient> client;
+    std::unique_ptr<PDFiumEngine> engine =
+        InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+    ASSERT_TRUE(engine);
+    engine->PluginSizeUpdated(kPluginSize);
+
+    engine->ScrolledToYPosition(0);
+    EXPECT_EQ(base::Milliseconds(250), get_first_slice_timeout(*engine));
+    g_frozen_time_ticks += base::Seconds(1);
+    EXPECT_EQ(base::Milliseconds(250), get_first_slice_timeout(*engine));
+  }
+
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(
+      features::kPdfAdaptivePaintScheduling);
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine =
+      InitializeEngine(&client, FILE_PATH_LITERAL("rectangles.pdf"));
+  ASSERT_TRUE(engine);
+  engine->PluginSizeUpdated(kPluginSize);
+
+  // With the feature, slices fit a frame while the user interacts, and get
+  // longer once they stop.
+  engine->ScrolledToYPosition(0);
+  EXPECT_EQ(base::Milliseconds(12), get_first_slice_timeout(*engine));
+  g_frozen_time_ticks += base::Seconds(1);
+  EXPECT_EQ(base::Milliseconds(50), get_first_slice_timeout(*engine));
+}
+
+TEST_P(PDFiumEngineTest, PaintWithInterleavedPageRendering) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatures(
+      /*enabled_features=*/{features::kPdfAdaptivePaintScheduling,
+                            features::kPdfInterleavedPageRendering},
+      /*disabled_features=*/{});
+
+  NiceMock<MockTestClient> client;
+  std::unique_ptr<PDFiumEngine> engine = InitializeEngine(
+      &client, FILE_PATH_LITERAL("rectangles_multi_pages.pdf"));
+  ASSERT_TRUE(engine);
+
+  DocumentLayout::Options options;
+  options.set_page_spread(DocumentLayout::PageSpread::kTwoUpOdd);
+  engine->SetDocumentLayout(DocumentLayout::PageSpread::kTwoUpOdd);
+  engine->ApplyDocumentLayout(options);
+
+  constexpr gfx::Size kPluginSize(1024, 1024);
+  engine->PluginSizeUpdated(kPluginSize);
+  SkBitmap image_data;
+  image_data.allocN32Pixels(kPluginSize.width(), kPluginSize.height());
+
+  // Paint each half of the spread as its own rect, with the clock stopped so
+  // the first page only uses up the time the test says it does. Stop it well
+  // after the last scroll, so the frame budget stays the same.
+  const gfx::Rect page_0_rect =
+      gfx::IntersectRects(engine->GetPageScreenRect(0), gfx::Rect(kPluginSize));
+  const gfx::Rect page_1_rect =
+      gfx::IntersectRects(engine->GetPageScreenRect(1), gfx::Rect(kPluginSize));
+  g_frozen_time_ticks = base::TimeTicks::Now() + base::Seconds(1);
+  base::subtle::ScopedTimeClockOverrides time_override(
+      /*time_override=*/nullptr, &FrozenTimeTicksNow,
+      /*thread_ticks_override=*/nullptr);
+
+  std::vector<gfx::Rect> ready;
+  std::vector<gfx::Rect> pending;
+  engine->PrePaint({page_0_rect, page_1_rect});
+  engine->Paint(page_0_rect, image_data, ready, ready, pending);
+  const base::TimeDelta page_0_timeout =
+      engine->GetProgressivePaintTimeoutForTesting();
+  g_frozen_time_ticks += page_0_timeout;
+  engine->Paint(page_1_rect, image_data, ready, ready, pending);
+  const base::TimeDelta page_1_timeout =
+      engine->GetProgressivePaintTimeoutForTesting();
+  engine->PostPaint();
+
+  // Both pages made progress within the round. The first page got half of the
+  // round rather than all of it, so using up its share left the other half for
+  // the second page.
+  EXPECT_THAT(ready, UnorderedElementsAre(page_0_rect, page_1_rect));
+  EXPECT_TRUE(pending.empty());
+  EXPECT_GT(page_0_timeout, base::TimeDelta());
+  EXPECT_EQ(page_0_timeout, page_1_timeout);
+}
+
 TEST_P(PDFiumEngineTest, HandleInputEventKeyDown) {
   NiceMock<MockTestClient> client;
   std::unique_ptr<PDFiumEngine> engine =
@@ -148,6 +148,8 @@ void PDFiumFormFiller::Form_Invalidate(FPDF_FORMFILLINFO* param,
     return;
   }
 
+  engine->InvalidateCachedTiles(page_index);
+
   gfx::Rect rect = engine->pages_[page_index]->PageToScreen(
       engine->GetVisibleRect().origin(), engine->current_zoom_, left, top,
       right, bottom, engine->layout_.options().default_page_orientation());
@@ -217,6 +219,9 @@ FPDF_SYSTEMTIME PDFiumFormFiller::Form_GetLocalTime(FPDF_FORMFILLINFO* param) {
 void PDFiumFormFiller::Form_OnChange(FPDF_FORMFILLINFO* param) {
   EngineInIsolateScope engine_scope = GetEngineInIsolateScope(param);
   PDFiumEngine* engine = engine_scope.engine();
+  // A field value change can update calculated fields on any page, including
+  // pages that are not loaded and therefore never get invalidated.
+  engine->InvalidateAllCachedTiles();
   engine->EnteredEditMode();
 }
 
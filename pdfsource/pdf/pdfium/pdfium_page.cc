@@ -62,6 +62,11 @@ constexpr float k360DegreesInRadians = base::DegToRad(360.0f);
 constexpr float kPointsToPixels = static_cast<float>(printing::kPixelsPerInch) /
                                   static_cast<float>(printing::kPointsPerInch);
 
+// How much a newly recorded render time contributes to the moving average of
+// a page's render cost. High enough to adapt quickly when a page gets cheaper
+// or more expensive to render, e.g. once its resources are cached.
+constexpr double kRenderTimeSampleWeight = 0.5;
+
 // Page rotations in clockwise degrees.
 enum class Rotation {
   kRotate0 = 0,
@@ -1704,6 +1709,30 @@ void PDFiumPage::GenerateAndSendThumbnail(float device_pixel_ratio,
   std::move(send_callback).Run(GenerateThumbnail(device_pixel_ratio));
 }
 
+void PDFiumPage::RecordRenderTime(base::TimeDelta render_time,
+                                  int64_t pixel_count) {
+  if (pixel_count <= 0)
+    return;
+
+  double render_time_per_pixel_us =
+      render_time.InMicrosecondsF() / static_cast<double>(pixel_count);
+  if (render_time_per_pixel_us_.has_value()) {
+    render_time_per_pixel_us =
+        kRenderTimeSampleWeight * render_time_per_pixel_us +
+        (1 - kRenderTimeSampleWeight) * render_time_per_pixel_us_.value();
+  }
+  render_time_per_pixel_us_ = render_time_per_pixel_us;
+}
+
+std::optional<base::TimeDelta> PDFiumPage::EstimateRenderTime(
+    int64_t pixel_count) const {
+  if (!render_time_per_pixel_us_.has_value())
+    return std::nullopt;
+
+  return base::Microseconds(render_time_per_pixel_us_.value() *
+                            static_cast<double>(pixel_count));
+}
+
 void PDFiumPage::MarkAvailable() {
   available_ = true;
 
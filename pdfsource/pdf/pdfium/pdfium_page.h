@@ -5,6 +5,8 @@
 #ifndef PDF_PDFIUM_PDFIUM_PAGE_H_
 #define PDF_PDFIUM_PDFIUM_PAGE_H_
 
+#include <stdint.h>
+
 #include <map>
 #include <optional>
 #include <set>
@@ -15,6 +17,7 @@
 #include "base/functional/callback_forward.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/raw_ptr.h"
+#include "base/time/time.h"
 #include "pdf/page_orientation.h"
 #include "pdf/pdf_engine.h"
 #include "third_party/pdfium/public/cpp/fpdf_scopers.h"
@@ -236,6 +239,15 @@ class PDFiumPage {
   FPDF_PAGE page() const { return page_.get(); }
   FPDF_TEXTPAGE text_page() const { return text_page_.get(); }
 
+  // Records that PDFium spent `render_time` rendering `pixel_count` pixels of
+  // this page, to refine the estimate returned by EstimateRenderTime().
+  void RecordRenderTime(base::TimeDelta render_time, int64_t pixel_count);
+
+  // Returns how long rendering `pixel_count` pixels of this page is expected to
+  // take, based on the render times recorded so far, or std::nullopt if none
+  // were recorded yet.
+  std::optional<base::TimeDelta> EstimateRenderTime(int64_t pixel_count) const;
+
  private:
   friend class PDFiumPageLinkTest;
   friend class PDFiumTestBase;
@@ -444,6 +456,9 @@ class PDFiumPage {
   // objects.
   std::set<int> page_object_text_run_breaks_;
   base::OnceClosure thumbnail_callback_;
+  // Moving average of the time PDFium takes to render one pixel of this page,
+  // in microseconds. Unset until the page gets rendered.
+  std::optional<double> render_time_per_pixel_us_;
   bool available_;
 };
 
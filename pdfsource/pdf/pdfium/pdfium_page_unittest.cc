@@ -19,6 +19,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/test/scoped_feature_list.h"
 #include "base/test/test_discardable_memory_allocator.h"
+#include "base/time/time.h"
 #include "build/build_config.h"
 #include "pdf/accessibility_structs.h"
 #include "pdf/pdfium/pdfium_engine.h"
@@ -66,6 +67,23 @@ TEST(PDFiumPageHelperTest, ScopedUnloadPreventer) {
   prevent_unload3 = prevent_unload4;
 }
 
+TEST(PDFiumPageHelperTest, EstimateRenderTime) {
+  PDFiumPage page(/*engine=*/nullptr, 0);
+  EXPECT_FALSE(page.EstimateRenderTime(/*pixel_count=*/100));
+
+  // Empty renders carry no information about the render cost.
+  page.RecordRenderTime(base::Milliseconds(10), /*pixel_count=*/0);
+  EXPECT_FALSE(page.EstimateRenderTime(/*pixel_count=*/100));
+
+  page.RecordRenderTime(base::Milliseconds(10), /*pixel_count=*/1000);
+  EXPECT_EQ(base::Milliseconds(1), page.EstimateRenderTime(100));
+  EXPECT_EQ(base::Milliseconds(20), page.EstimateRenderTime(2000));
+
+  // Later render times get averaged in.
+  page.RecordRenderTime(base::Milliseconds(30), /*pixel_count=*/1000);
+  EXPECT_EQ(base::Milliseconds(2), page.EstimateRenderTime(100));
+}
+
 void CompareTextRuns(const AccessibilityTextRunInfo& expected_text_run,
                      const AccessibilityTextRunInfo& actual_text_run) {
   EXPECT_EQ(expected_text_run.len, actual_text_run.len);
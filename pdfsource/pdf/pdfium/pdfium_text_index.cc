@@ -0,0 +1,224 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/pdfium/pdfium_text_index.h"
+
+#include <stddef.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/i18n/string_search.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_util.h"
+#include "pdf/pdfium/pdfium_api_string_buffer_adapter.h"
+#include "pdf/pdfium/pdfium_page.h"
+#include "pdf/pdfium/pdfium_range.h"
+#include "third_party/pdfium/public/fpdf_text.h"
+#include "ui/gfx/geometry/rect_f.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// Simplify to \" for searching
+constexpr char16_t kHebrewPunctuationGershayimCharacter = 0x05F4;
+constexpr char16_t kLeftDoubleQuotationMarkCharacter = 0x201C;
+constexpr char16_t kRightDoubleQuotationMarkCharacter = 0x201D;
+
+// Simplify \' for searching
+constexpr char16_t kHebrewPunctuationGereshCharacter = 0x05F3;
+constexpr char16_t kLeftSingleQuotationMarkCharacter = 0x2018;
+constexpr char16_t kRightSingleQuotationMarkCharacter = 0x2019;
+
+}  // namespace
+
+char16_t SimplifyForSearch(char16_t c) {
+  switch (c) {
+    case kHebrewPunctuationGershayimCharacter:
+    case kLeftDoubleQuotationMarkCharacter:
+    case kRightDoubleQuotationMarkCharacter:
+      return u'\"';
+    case kHebrewPunctuationGereshCharacter:
+    case kLeftSingleQuotationMarkCharacter:
+    case kRightSingleQuotationMarkCharacter:
+      return u'\'';
+    default:
+      return c;
+  }
+}
+
+std::vector<std::vector<PDFEngine::Client::SearchStringResult>>
+SearchPageTexts(const std::vector<SharedPageText>& texts,
+                const std::u16string& term,
+                bool case_sensitive) {
+  std::vector<std::vector<PDFEngine::Client::SearchStringResult>> results;
+  results.reserve(texts.size());
+  for (const SharedPageText& shared_text : texts) {
+    const std::u16string& text = shared_text->data;
+    std::vector<PDFEngine::Client::SearchStringResult>& page_results =
+        results.emplace_back();
+    if (text.empty())
+      continue;
+
+    base::i18n::RepeatingStringSearch searcher(
+        /*find_this=*/term, /*in_this=*/text, case_sensitive);
+    int match_index;
+    int match_length;
+    while (searcher.NextMatchResult(match_index, match_length)) {
+      page_results.push_back(
+          {.start_index = match_index, .length = match_length});
+    }
+  }
+  return results;
+}
+
+PDFiumTextIndex::PageText::PageText() = default;
+
+PDFiumTextIndex::PageText::PageText(PageText&& other) noexcept = default;
+
+PDFiumTextIndex::PageText& PDFiumTextIndex::PageText::operator=(
+    PageText&& other) noexcept = default;
+
+PDFiumTextIndex::PageText::~PageText() = default;
+
+PDFiumTextIndex::PDFiumTextIndex() = default;
+
+PDFiumTextIndex::~PDFiumTextIndex() = default;
+
+// static
+PDFiumTextIndex::PageText PDFiumTextIndex::ExtractPageText(PDFiumPage& page) {
+  DCHECK(page.available());
+
+  PageText page_text;
+  const int char_count = page.GetCharCount();
+  if (char_count <= 0) {
+    page_text.text =
+        base::MakeRefCounted<base::RefCountedData<std::u16string>>();
+    return page_text;
+  }
+
+  std::u16string raw_text;
+  PDFiumAPIStringBufferAdapter<std::u16string> api_string_adapter(
+      &raw_text, char_count, false);
+  unsigned short* data =
+      reinterpret_cast<unsigned short*>(api_string_adapter.GetData());
+  int written = FPDFText_GetText(page.GetTextPage(), 0, char_count, data);
+  api_string_adapter.Close(written);
+
+  const gfx::RectF page_bounds = page.GetCroppedRect();
+  std::u16string text;
+  text.reserve(raw_text.size());
+  // Values in `removed_indices` are in the `text` index space and indicate a
+  // character was removed from `raw_text` before the given index. If multiple
+  // characters are removed in a row then there will be multiple entries with
+  // the same value.
+  std::vector<size_t> removed_indices;
+  // When walking through the page text collapse any whitespace regions,
+  // including \r and \n, down to a single ' ' character. This code does
+  // not use base::CollapseWhitespace(), because that function does not
+  // return where the collapsing occurs, but uses the same underlying list of
+  // whitespace characters. Calculating where the collapsed regions are after
+  // the fact is as complex as collapsing them manually.
+  for (size_t i = 0; i < raw_text.size(); i++) {
+    // Filter out characters outside the page bounds, which are semantically not
+    // part of the page.
+    if (!page.IsCharInPageBounds(i, page_bounds)) {
+      removed_indices.push_back(text.size());
+      continue;
+    }
+
+    char16_t c = raw_text[i];
+    // Collapse whitespace regions by inserting a ' ' into `text` and recording
+    // any removed whitespace indices as preceding it.
+    if (base::IsUnicodeWhitespace(c)) {
+      size_t whitespace_region_begin = i;
+      while (i < raw_text.size() && base::IsUnicodeWhitespace(raw_text[i]))
+        ++i;
+
+      size_t count = i - whitespace_region_begin - 1;
+      removed_indices.insert(removed_indices.end(), count, text.size());
+      text.push_back(' ');
+      if (i >= raw_text.size())
+        break;
+      c = raw_text[i];
+    }
+
+    if (IsIgnorableCharacter(c))
+      removed_indices.push_back(text.size());
+    else
+      text.push_back(SimplifyForSearch(c));
+  }
+
+  // Map each position of `text` back to `raw_text` by adding the characters
+  // removed up to it, and then from there to the page characters, since the
+  // page text may have generated characters like spaces.
+  page_text.char_indices.reserve(text.size() + 1);
+  size_t removed_count = 0;
+  for (size_t i = 0; i <= text.size(); ++i) {
+    while (removed_count < removed_indices.size() &&
+           removed_indices[removed_count] <= i) {
+      ++removed_count;
+    }
+    const int text_index = static_cast<int>(i + removed_count);
+
+    // The end of the page text is one past the last character, which PDFium
+    // has no character index for.
+    page_text.char_indices.push_back(
+        text_index >= char_count
+            ? char_count
+            : FPDFText_GetCharIndexFromTextIndex(page.GetTextPage(),
+                                                 text_index));
+  }
+  page_text.text = base::MakeRefCounted<base::RefCountedData<std::u16string>>(
+      std::move(text));
+  return page_text;
+}
+
+const PDFiumTextIndex::PageText* PDFiumTextIndex::GetPage(
+    size_t page_index) const {
+  if (page_index >= pages_.size() || !pages_[page_index])
+    return nullptr;
+
+  return &pages_[page_index].value();
+}
+
+bool PDFiumTextIndex::HasAllPages(size_t page_count) const {
+  if (page_count > pages_.size())
+    return false;
+
+  for (size_t i = 0; i < page_count; ++i) {
+    if (!pages_[i])
+      return false;
+  }
+  return true;
+}
+
+const PDFiumTextIndex::PageText& PDFiumTextIndex::AddPage(PDFiumPage& page) {
+  const size_t page_index = static_cast<size_t>(page.index());
+  if (page_index >= pages_.size())
+    pages_.resize(page_index + 1);
+
+  pages_[page_index] = ExtractPageText(page);
+  return pages_[page_index].value();
+}
+
+void PDFiumTextIndex::RemovePage(size_t page_index) {
+  if (page_index < pages_.size())
+    pages_[page_index].reset();
+}
+
+void PDFiumTextIndex::Truncate(size_t page_count) {
+  if (page_count < pages_.size())
+    pages_.resize(page_count);
+}
+
+void PDFiumTextIndex::Clear() {
+  pages_.clear();
+}
+
+}  // namespace chrome_pdf
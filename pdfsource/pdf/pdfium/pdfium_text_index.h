@@ -0,0 +1,101 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_PDFIUM_PDFIUM_TEXT_INDEX_H_
+#define PDF_PDFIUM_PDFIUM_TEXT_INDEX_H_
+
+#include <stddef.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "pdf/pdf_engine.h"
+
+namespace chrome_pdf {
+
+class PDFiumPage;
+
+// The text of a page. Never modified once extracted, so searches on other
+// threads can hold on to it instead of a copy.
+using SharedPageText =
+    scoped_refptr<const base::RefCountedData<std::u16string>>;
+
+// Maps the various kinds of quotation marks to the plain ASCII ones, so that
+// find matches them all.
+char16_t SimplifyForSearch(char16_t c);
+
+// Returns the matches of `term` in each of `texts`, found the same way
+// PDFEngine::Client::SearchString() finds them. Unlike the client, can be
+// called on any thread.
+std::vector<std::vector<PDFEngine::Client::SearchStringResult>>
+SearchPageTexts(const std::vector<SharedPageText>& texts,
+                const std::u16string& term,
+                bool case_sensitive);
+
+// The text of the pages of a document, prepared for find-in-page. Once a page
+// is in the index, searching it takes no calls into PDFium, and the page does
+// not need to be loaded.
+//
+// Searches still scan the text of each page. There is no n-gram or suffix
+// index, since find matches with ICU collation: a case-insensitive search also
+// ignores accents, and matches can take more or fewer characters than the
+// term, so exact n-grams of the term would miss matches. The index takes
+// about 6 bytes per character of page text: 2 for the text, and 4 for the
+// character index it maps back to.
+class PDFiumTextIndex {
+ public:
+  // The text of one page.
+  struct PageText {
+    PageText();
+    PageText(PageText&& other) noexcept;
+    PageText& operator=(PageText&& other) noexcept;
+    ~PageText();
+
+    // The text of the page with whitespace runs collapsed to a single space,
+    // ignorable characters and characters outside the page bounds removed,
+    // and quotation marks simplified. Never null.
+    SharedPageText text;
+
+    // The index of the page character at each position of `text`, plus one
+    // more entry for the end of `text`. A match of `text` from `start` to
+    // `end` covers the page characters from `char_indices[start]` to
+    // `char_indices[end]`.
+    std::vector<int> char_indices;
+  };
+
+  PDFiumTextIndex();
+  PDFiumTextIndex(const PDFiumTextIndex&) = delete;
+  PDFiumTextIndex& operator=(const PDFiumTextIndex&) = delete;
+  ~PDFiumTextIndex();
+
+  // Extracts the text of `page`, which must be available.
+  static PageText ExtractPageText(PDFiumPage& page);
+
+  // Returns the text of the page at `page_index`, or nullptr if the page is not
+  // in the index.
+  const PageText* GetPage(size_t page_index) const;
+
+  // Returns whether all of the first `page_count` pages are in the index.
+  bool HasAllPages(size_t page_count) const;
+
+  // Extracts the text of `page` and adds it to the index.
+  const PageText& AddPage(PDFiumPage& page);
+
+  // Drops the page at `page_index`, whose text changed.
+  void RemovePage(size_t page_index);
+
+  // Drops the pages from `page_count` on.
+  void Truncate(size_t page_count);
+
+  void Clear();
+
+ private:
+  std::vector<std::optional<PageText>> pages_;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_PDFIUM_PDFIUM_TEXT_INDEX_H_
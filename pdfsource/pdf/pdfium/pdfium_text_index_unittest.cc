@@ -0,0 +1,138 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/pdfium/pdfium_text_index.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "pdf/pdfium/pdfium_engine.h"
+#include "pdf/pdfium/pdfium_page.h"
+#include "pdf/pdfium/pdfium_test_base.h"
+#include "pdf/test/test_client.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+SharedPageText MakeSharedPageText(std::u16string text) {
+  return base::MakeRefCounted<base::RefCountedData<std::u16string>>(
+      std::move(text));
+}
+
+}  // namespace
+
+class PDFiumTextIndexTest : public PDFiumTestBase {
+ public:
+  void SetUp() override {
+    PDFiumTestBase::SetUp();
+    engine_ = InitializeEngine(&client_, FILE_PATH_LITERAL("hello_world2.pdf"));
+    ASSERT_TRUE(engine_);
+  }
+
+  void TearDown() override {
+    // Must reset the PDFiumEngine before PDFiumTestBase uninitializes PDFium
+    // altogether.
+    engine_.reset();
+    PDFiumTestBase::TearDown();
+  }
+
+  PDFiumEngine* engine() { return engine_.get(); }
+
+ private:
+  TestClient client_;
+  std::unique_ptr<PDFiumEngine> engine_;
+};
+
+TEST_P(PDFiumTextIndexTest, ExtractPageText) {
+  PDFiumPage page(engine(), 0);
+  page.MarkAvailable();
+
+  PDFiumTextIndex::PageText page_text =
+      PDFiumTextIndex::ExtractPageText(page);
+
+  // The line break between the two lines collapses into one space.
+  EXPECT_EQ(u"Hello, world! Goodbye, world!", page_text.text->data);
+  ASSERT_EQ(page_text.text->data.size() + 1, page_text.char_indices.size());
+  EXPECT_EQ(0, page_text.char_indices[0]);
+  EXPECT_EQ(13, page_text.char_indices[13]);
+  EXPECT_EQ(15, page_text.char_indices[14]);
+  EXPECT_EQ(29, page_text.char_indices[28]);
+
+  // The end of the text maps to the end of the page.
+  EXPECT_EQ(30, page_text.char_indices[29]);
+}
+
+TEST_P(PDFiumTextIndexTest, AddPage) {
+  PDFiumPage page(engine(), 1);
+  page.MarkAvailable();
+
+  PDFiumTextIndex text_index;
+  EXPECT_FALSE(text_index.GetPage(0));
+  EXPECT_FALSE(text_index.GetPage(1));
+
+  const PDFiumTextIndex::PageText& page_text = text_index.AddPage(page);
+  EXPECT_EQ(u"Hello, world! Goodbye, world!", page_text.text->data);
+  EXPECT_FALSE(text_index.GetPage(0));
+  EXPECT_EQ(&page_text, text_index.GetPage(1));
+
+  text_index.RemovePage(0);
+  EXPECT_TRUE(text_index.GetPage(1));
+  text_index.RemovePage(1);
+  EXPECT_FALSE(text_index.GetPage(1));
+  EXPECT_FALSE(text_index.HasAllPages(2));
+
+  text_index.AddPage(page);
+  text_index.Truncate(2);
+  EXPECT_TRUE(text_index.GetPage(1));
+  text_index.Truncate(1);
+  EXPECT_FALSE(text_index.GetPage(1));
+
+  text_index.AddPage(page);
+  text_index.Clear();
+  EXPECT_FALSE(text_index.GetPage(1));
+}
+
+TEST_P(PDFiumTextIndexTest, SimplifyForSearch) {
+  EXPECT_EQ(u'a', SimplifyForSearch(u'a'));
+  EXPECT_EQ(u'"', SimplifyForSearch(u'"'));
+  EXPECT_EQ(u'"', SimplifyForSearch(u'\u201C'));
+  EXPECT_EQ(u'"', SimplifyForSearch(u'\u201D'));
+  EXPECT_EQ(u'"', SimplifyForSearch(u'\u05F4'));
+  EXPECT_EQ(u'\'', SimplifyForSearch(u'\u2018'));
+  EXPECT_EQ(u'\'', SimplifyForSearch(u'\u2019'));
+  EXPECT_EQ(u'\'', SimplifyForSearch(u'\u05F3'));
+}
+
+TEST_P(PDFiumTextIndexTest, SearchPageTexts) {
+  const std::vector<SharedPageText> texts = {
+      MakeSharedPageText(u"Hello, world!"), MakeSharedPageText(u""),
+      MakeSharedPageText(u"WORLD world")};
+
+  std::vector<std::vector<PDFEngine::Client::SearchStringResult>> results =
+      SearchPageTexts(texts, u"world", /*case_sensitive=*/false);
+  ASSERT_EQ(3u, results.size());
+  ASSERT_EQ(1u, results[0].size());
+  EXPECT_EQ(7, results[0][0].start_index);
+  EXPECT_EQ(5, results[0][0].length);
+  EXPECT_TRUE(results[1].empty());
+  ASSERT_EQ(2u, results[2].size());
+  EXPECT_EQ(0, results[2][0].start_index);
+  EXPECT_EQ(6, results[2][1].start_index);
+
+  results = SearchPageTexts(texts, u"world", /*case_sensitive=*/true);
+  ASSERT_EQ(3u, results.size());
+  EXPECT_EQ(1u, results[0].size());
+  EXPECT_TRUE(results[1].empty());
+  ASSERT_EQ(1u, results[2].size());
+  EXPECT_EQ(6, results[2][0].start_index);
+}
+
+INSTANTIATE_TEST_SUITE_P(All, PDFiumTextIndexTest, testing::Bool());
+
+}  // namespace chrome_pdf
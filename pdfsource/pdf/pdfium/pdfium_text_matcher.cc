@@ -0,0 +1,99 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/pdfium/pdfium_text_matcher.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/i18n/string_search.h"
+
+namespace chrome_pdf {
+
+std::vector<CrossPageMatch> FindCrossPageMatches(
+    const std::vector<SharedPageText>& texts,
+    const std::u16string& term,
+    bool case_sensitive) {
+  using Position = CrossPageMatch::Position;
+
+  std::vector<CrossPageMatch> matches;
+  if (term.empty())
+    return matches;
+
+  // Leave room for matches that take more page text than the term has
+  // characters, like ones with accents in the page text.
+  const size_t context_length = 2 * term.size();
+  const int page_count = static_cast<int>(texts.size());
+  for (int next_page = 1; next_page < page_count; ++next_page) {
+    // Gather up to `context_length` characters on each side of the space
+    // before `next_page`, from as many pages as it takes. Remember where each
+    // character comes from. A space between pages maps to the end of the page
+    // before it.
+    std::u16string window;
+    std::vector<Position> positions;
+    for (int page = next_page - 1;
+         page >= 0 && window.size() < context_length; --page) {
+      const std::u16string& text = texts[page]->data;
+      if (page < next_page - 1) {
+        window.push_back(u' ');
+        positions.push_back({.page_index = page, .text_index = text.size()});
+      }
+      for (size_t i = text.size();
+           i > 0 && window.size() < context_length; --i) {
+        window.push_back(text[i - 1]);
+        positions.push_back({.page_index = page, .text_index = i - 1});
+      }
+    }
+    std::reverse(window.begin(), window.end());
+    std::reverse(positions.begin(), positions.end());
+
+    const size_t separator_index = window.size();
+    const size_t window_size = separator_index + 1 + context_length;
+    for (int page = next_page;
+         page < page_count && window.size() < window_size; ++page) {
+      window.push_back(u' ');
+      positions.push_back({.page_index = page - 1,
+                           .text_index = texts[page - 1]->data.size()});
+      const std::u16string& text = texts[page]->data;
+      for (size_t i = 0; i < text.size() && window.size() < window_size;
+           ++i) {
+        window.push_back(text[i]);
+        positions.push_back({.page_index = page, .text_index = i});
+      }
+    }
+
+    // Search the same way the pages get searched one at a time, so matches
+    // across pages fold case and accents like the other matches do.
+    base::i18n::RepeatingStringSearch searcher(
+        /*find_this=*/term, /*in_this=*/window, case_sensitive);
+    int match_index;
+    int match_length;
+    while (searcher.NextMatchResult(match_index, match_length)) {
+      if (match_length <= 0)
+        continue;
+
+      // Only keep the matches that start on the page before the space and
+      // end after it. Matches across more pages get found around the first
+      // space they cross.
+      const size_t start = static_cast<size_t>(match_index);
+      const size_t last = start + static_cast<size_t>(match_length) - 1;
+      if (start >= separator_index || last <= separator_index ||
+          positions[start].page_index != next_page - 1) {
+        continue;
+      }
+
+      // A space between pages already maps to the end of the page before it.
+      Position end = positions[last];
+      if (end.text_index < texts[end.page_index]->data.size())
+        ++end.text_index;
+      matches.push_back({.start = positions[start], .end = end});
+    }
+  }
+  return matches;
+}
+
+}  // namespace chrome_pdf
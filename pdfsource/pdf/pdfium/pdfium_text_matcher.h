@@ -0,0 +1,45 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_PDFIUM_PDFIUM_TEXT_MATCHER_H_
+#define PDF_PDFIUM_PDFIUM_TEXT_MATCHER_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "pdf/pdfium/pdfium_text_index.h"
+
+namespace chrome_pdf {
+
+// A match of a find term that starts on one page and continues on the pages
+// after it.
+struct CrossPageMatch {
+  // A position in the text of a page.
+  struct Position {
+    int page_index;
+    size_t text_index;
+  };
+
+  // Where the match starts.
+  Position start;
+
+  // Where the match ends. Exclusive.
+  Position end;
+};
+
+// Returns the matches of `term` in `texts`, the text of every page in order,
+// that continue on the pages after the one they start on, as if consecutive
+// pages were separated by a space. Matches the same way SearchPageTexts() does.
+// Unlike searching the pages one at a time, can take a while, but can be
+// called on any thread.
+std::vector<CrossPageMatch> FindCrossPageMatches(
+    const std::vector<SharedPageText>& texts,
+    const std::u16string& term,
+    bool case_sensitive);
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_PDFIUM_PDFIUM_TEXT_MATCHER_H_
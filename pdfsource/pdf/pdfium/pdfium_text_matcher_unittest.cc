@@ -0,0 +1,85 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/pdfium/pdfium_text_matcher.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "pdf/pdfium/pdfium_text_index.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FieldsAre;
+using ::testing::IsEmpty;
+
+std::vector<SharedPageText> MakePageTexts(
+    const std::vector<std::u16string>& texts) {
+  std::vector<SharedPageText> page_texts;
+  for (const std::u16string& text : texts) {
+    page_texts.push_back(
+        base::MakeRefCounted<base::RefCountedData<std::u16string>>(text));
+  }
+  return page_texts;
+}
+
+}  // namespace
+
+TEST(PDFiumTextMatcherTest, FindCrossPageMatches) {
+  const std::vector<SharedPageText> texts =
+      MakePageTexts({u"Hello, world!", u"Goodbye, world!"});
+
+  // Only the matches that span pages come in.
+  EXPECT_THAT(FindCrossPageMatches(texts, u"world", /*case_sensitive=*/true),
+              IsEmpty());
+
+  // Pages are separated by a space.
+  EXPECT_THAT(
+      FindCrossPageMatches(texts, u"! Goodbye, w", /*case_sensitive=*/true),
+      ElementsAre(FieldsAre(FieldsAre(0, 12u), FieldsAre(1, 10u))));
+}
+
+TEST(PDFiumTextMatcherTest, FindCrossPageMatchesAcrossShortPages) {
+  // The match is found once, around the first space it crosses.
+  EXPECT_THAT(FindCrossPageMatches(MakePageTexts({u"a", u"b", u"c"}), u"a b c",
+                                   /*case_sensitive=*/true),
+              ElementsAre(FieldsAre(FieldsAre(0, 0u), FieldsAre(2, 1u))));
+
+  // Empty pages still separate the pages around them.
+  EXPECT_THAT(FindCrossPageMatches(MakePageTexts({u"a", u"", u"b"}), u"a  b",
+                                   /*case_sensitive=*/true),
+              ElementsAre(FieldsAre(FieldsAre(0, 0u), FieldsAre(2, 1u))));
+}
+
+TEST(PDFiumTextMatcherTest, FindCrossPageMatchesFoldsLikeSearchPageTexts) {
+  const std::vector<SharedPageText> texts =
+      MakePageTexts({u"Caf\u00e9", u"Society"});
+
+  EXPECT_THAT(FindCrossPageMatches(texts, u"Caf\u00e9 Society",
+                                   /*case_sensitive=*/true),
+              ElementsAre(FieldsAre(FieldsAre(0, 0u), FieldsAre(1, 7u))));
+  EXPECT_THAT(
+      FindCrossPageMatches(texts, u"cafe society", /*case_sensitive=*/true),
+      IsEmpty());
+
+  // A case-insensitive search ignores case and accents, within a page and
+  // across pages alike.
+  ASSERT_THAT(SearchPageTexts(MakePageTexts({u"Caf\u00e9 Society"}),
+                              u"cafe society", /*case_sensitive=*/false),
+              ElementsAre(ElementsAre(FieldsAre(0, 12))));
+  EXPECT_THAT(
+      FindCrossPageMatches(texts, u"cafe society", /*case_sensitive=*/false),
+      ElementsAre(FieldsAre(FieldsAre(0, 0u), FieldsAre(1, 7u))));
+}
+
+}  // namespace chrome_pdf
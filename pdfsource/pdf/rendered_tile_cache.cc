@@ -0,0 +1,88 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/rendered_tile_cache.h"
+
+#include <tuple>
+#include <utility>
+
+#include "base/check_op.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+auto AsTuple(const RenderedTileCache::Key& key) {
+  return std::make_tuple(key.page_index, key.zoom, key.orientation,
+                         key.grayscale, key.annotations, key.background_color,
+                         key.page_size.width(), key.page_size.height(),
+                         key.rect.x(), key.rect.y(), key.rect.width(),
+                         key.rect.height());
+}
+
+}  // namespace
+
+bool RenderedTileCache::Key::operator<(const Key& other) const {
+  return AsTuple(*this) < AsTuple(other);
+}
+
+bool RenderedTileCache::Key::operator==(const Key& other) const {
+  return AsTuple(*this) == AsTuple(other);
+}
+
+RenderedTileCache::RenderedTileCache(size_t max_size_in_bytes)
+    : max_size_in_bytes_(max_size_in_bytes),
+      tiles_(base::LRUCache<Key, SkBitmap>::NO_AUTO_EVICT) {}
+
+RenderedTileCache::~RenderedTileCache() = default;
+
+const SkBitmap* RenderedTileCache::Get(const Key& key) {
+  auto it = tiles_.Get(key);
+  return it != tiles_.end() ? &it->second : nullptr;
+}
+
+bool RenderedTileCache::Contains(const Key& key) const {
+  return tiles_.Peek(key) != tiles_.end();
+}
+
+void RenderedTileCache::Put(const Key& key, SkBitmap bitmap) {
+  auto existing = tiles_.Peek(key);
+  if (existing != tiles_.end()) {
+    size_in_bytes_ -= existing->second.computeByteSize();
+    tiles_.Erase(existing);
+  }
+
+  const size_t bitmap_size = bitmap.computeByteSize();
+  if (bitmap_size > max_size_in_bytes_)
+    return;
+
+  while (size_in_bytes_ + bitmap_size > max_size_in_bytes_) {
+    DCHECK_GT(tiles_.size(), 0u);
+    auto oldest = tiles_.rbegin();
+    size_in_bytes_ -= oldest->second.computeByteSize();
+    tiles_.Erase(oldest);
+  }
+
+  size_in_bytes_ += bitmap_size;
+  tiles_.Put(key, std::move(bitmap));
+}
+
+void RenderedTileCache::InvalidatePage(int page_index) {
+  auto it = tiles_.begin();
+  while (it != tiles_.end()) {
+    if (it->first.page_index != page_index) {
+      ++it;
+      continue;
+    }
+    size_in_bytes_ -= it->second.computeByteSize();
+    it = tiles_.Erase(it);
+  }
+}
+
+void RenderedTileCache::Clear() {
+  tiles_.Clear();
+  size_in_bytes_ = 0;
+}
+
+}  // namespace chrome_pdf
@@ -0,0 +1,85 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PDF_RENDERED_TILE_CACHE_H_
+#define PDF_RENDERED_TILE_CACHE_H_
+
+#include <stddef.h>
+
+#include "base/containers/lru_cache.h"
+#include "pdf/page_orientation.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/geometry/rect.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace chrome_pdf {
+
+// Caches rendered page tiles, so regions that scroll back into view or get
+// invalidated without their contents changing can be copied instead of
+// rendered again. Entries are evicted in least recently used order once the
+// total size of the cached pixels exceeds a memory budget.
+class RenderedTileCache {
+ public:
+  // Identifies a rendered tile. Everything that affects the rendered pixels
+  // must be part of the key.
+  struct Key {
+    bool operator<(const Key& other) const;
+    bool operator==(const Key& other) const;
+
+    int page_index = -1;
+    double zoom = 1.0;
+    PageOrientation orientation = PageOrientation::kOriginal;
+    bool grayscale = false;
+    bool annotations = true;
+
+    // The color the page sides and shadow get drawn in.
+    SkColor background_color = SK_ColorTRANSPARENT;
+
+    // The size of the page's screen rectangle, including the surrounding
+    // border areas. Changes whenever the document layout changes.
+    gfx::Size page_size;
+
+    // The tile, relative to the top-left corner of the page's screen
+    // rectangle.
+    gfx::Rect rect;
+  };
+
+  explicit RenderedTileCache(size_t max_size_in_bytes);
+  RenderedTileCache(const RenderedTileCache&) = delete;
+  RenderedTileCache& operator=(const RenderedTileCache&) = delete;
+  ~RenderedTileCache();
+
+  // Returns the tile for `key`, or nullptr if it is not cached. Marks the tile
+  // as most recently used. The returned pointer is invalidated by any
+  // subsequent non-const call.
+  const SkBitmap* Get(const Key& key);
+
+  // Returns whether the tile for `key` is cached, without marking it as most
+  // recently used.
+  bool Contains(const Key& key) const;
+
+  // Caches `bitmap` for `key`, replacing any existing tile for `key`, and
+  // evicts least recently used tiles until the cache fits its memory budget.
+  // Does nothing if `bitmap` alone does not fit.
+  void Put(const Key& key, SkBitmap bitmap);
+
+  // Removes all the tiles for the page at `page_index`.
+  void InvalidatePage(int page_index);
+
+  // Removes all the tiles.
+  void Clear();
+
+  size_t size() const { return tiles_.size(); }
+  size_t size_in_bytes() const { return size_in_bytes_; }
+
+ private:
+  const size_t max_size_in_bytes_;
+  size_t size_in_bytes_ = 0;
+  base::LRUCache<Key, SkBitmap> tiles_;
+};
+
+}  // namespace chrome_pdf
+
+#endif  // PDF_RENDERED_TILE_CACHE_H_
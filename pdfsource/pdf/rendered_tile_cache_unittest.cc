@@ -0,0 +1,162 @@
+// Copyright 2024 The Chromium Authors
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pdf/rendered_tile_cache.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace chrome_pdf {
+
+namespace {
+
+// Each tile created by MakeTile() is 10x10 pixels, 4 bytes per pixel.
+constexpr size_t kTileSizeInBytes = 10 * 10 * 4;
+
+RenderedTileCache::Key MakeKey(int page_index, int x) {
+  RenderedTileCache::Key key;
+  key.page_index = page_index;
+  key.page_size = gfx::Size(100, 100);
+  key.rect = gfx::Rect(x, 0, 10, 10);
+  return key;
+}
+
+SkBitmap MakeTile(SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  bitmap.eraseColor(color);
+  return bitmap;
+}
+
+}  // namespace
+
+TEST(RenderedTileCacheTest, PutAndGet) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 4);
+  EXPECT_FALSE(cache.Get(MakeKey(0, 0)));
+
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(1, 0), MakeTile(SK_ColorGREEN));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(kTileSizeInBytes * 2, cache.size_in_bytes());
+
+  const SkBitmap* tile = cache.Get(MakeKey(0, 0));
+  ASSERT_TRUE(tile);
+  EXPECT_EQ(SK_ColorRED, tile->getColor(0, 0));
+
+  tile = cache.Get(MakeKey(1, 0));
+  ASSERT_TRUE(tile);
+  EXPECT_EQ(SK_ColorGREEN, tile->getColor(0, 0));
+
+  EXPECT_FALSE(cache.Get(MakeKey(0, 10)));
+}
+
+TEST(RenderedTileCacheTest, KeyIncludesRenderingParameters) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 4);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+
+  RenderedTileCache::Key key = MakeKey(0, 0);
+  key.zoom = 2.0;
+  EXPECT_FALSE(cache.Get(key));
+
+  key = MakeKey(0, 0);
+  key.orientation = PageOrientation::kClockwise90;
+  EXPECT_FALSE(cache.Get(key));
+
+  key = MakeKey(0, 0);
+  key.grayscale = true;
+  EXPECT_FALSE(cache.Get(key));
+
+  key = MakeKey(0, 0);
+  key.annotations = false;
+  EXPECT_FALSE(cache.Get(key));
+
+  key = MakeKey(0, 0);
+  key.background_color = SK_ColorGRAY;
+  EXPECT_FALSE(cache.Get(key));
+
+  key = MakeKey(0, 0);
+  key.page_size = gfx::Size(120, 100);
+  EXPECT_FALSE(cache.Get(key));
+
+  EXPECT_TRUE(cache.Get(MakeKey(0, 0)));
+}
+
+TEST(RenderedTileCacheTest, PutReplacesExistingTile) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 4);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorBLUE));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(kTileSizeInBytes, cache.size_in_bytes());
+
+  const SkBitmap* tile = cache.Get(MakeKey(0, 0));
+  ASSERT_TRUE(tile);
+  EXPECT_EQ(SK_ColorBLUE, tile->getColor(0, 0));
+}
+
+TEST(RenderedTileCacheTest, ContainsDoesNotAffectEvictionOrder) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 2);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(0, 10), MakeTile(SK_ColorGREEN));
+
+  EXPECT_TRUE(cache.Contains(MakeKey(0, 0)));
+  EXPECT_FALSE(cache.Contains(MakeKey(0, 20)));
+
+  // The first tile is still the oldest one.
+  cache.Put(MakeKey(0, 20), MakeTile(SK_ColorBLUE));
+  EXPECT_FALSE(cache.Contains(MakeKey(0, 0)));
+  EXPECT_TRUE(cache.Contains(MakeKey(0, 10)));
+  EXPECT_TRUE(cache.Contains(MakeKey(0, 20)));
+}
+
+TEST(RenderedTileCacheTest, EvictsLeastRecentlyUsed) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 2);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(0, 10), MakeTile(SK_ColorGREEN));
+
+  // Touch the first tile, so the second one becomes the oldest.
+  EXPECT_TRUE(cache.Get(MakeKey(0, 0)));
+
+  cache.Put(MakeKey(0, 20), MakeTile(SK_ColorBLUE));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(kTileSizeInBytes * 2, cache.size_in_bytes());
+  EXPECT_TRUE(cache.Get(MakeKey(0, 0)));
+  EXPECT_FALSE(cache.Get(MakeKey(0, 10)));
+  EXPECT_TRUE(cache.Get(MakeKey(0, 20)));
+}
+
+TEST(RenderedTileCacheTest, IgnoresTileLargerThanBudget) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes - 1);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.size_in_bytes());
+}
+
+TEST(RenderedTileCacheTest, InvalidatePage) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 4);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(1, 0), MakeTile(SK_ColorGREEN));
+  cache.Put(MakeKey(1, 10), MakeTile(SK_ColorBLUE));
+
+  cache.InvalidatePage(1);
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(kTileSizeInBytes, cache.size_in_bytes());
+  EXPECT_TRUE(cache.Get(MakeKey(0, 0)));
+  EXPECT_FALSE(cache.Get(MakeKey(1, 0)));
+  EXPECT_FALSE(cache.Get(MakeKey(1, 10)));
+}
+
+TEST(RenderedTileCacheTest, Clear) {
+  RenderedTileCache cache(/*max_size_in_bytes=*/kTileSizeInBytes * 4);
+  cache.Put(MakeKey(0, 0), MakeTile(SK_ColorRED));
+  cache.Put(MakeKey(1, 0), MakeTile(SK_ColorGREEN));
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_EQ(0u, cache.size_in_bytes());
+  EXPECT_FALSE(cache.Get(MakeKey(0, 0)));
+}
+
+}  // namespace chrome_pdf
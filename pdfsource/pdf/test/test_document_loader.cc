@@ -96,6 +96,13 @@ bool TestDocumentLoader::GetBlock(uint32_t position,
   return true;
 }
 
+base::span<const uint8_t> TestDocumentLoader::GetCompleteData() const {
+  if (!IsDocumentComplete())
+    return {};
+
+  return pdf_data_;
+}
+
 bool TestDocumentLoader::IsDataAvailable(uint32_t position,
                                          uint32_t size) const {
   CHECK_LE(position, GetDocumentSize());
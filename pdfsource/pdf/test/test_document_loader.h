@@ -33,6 +33,7 @@ class TestDocumentLoader : public DocumentLoader {
   bool Init(std::unique_ptr<URLLoaderWrapper> loader,
             const std::string& url) override;
   bool GetBlock(uint32_t position, uint32_t size, void* buf) const override;
+  base::span<const uint8_t> GetCompleteData() const override;
   bool IsDataAvailable(uint32_t position, uint32_t size) const override;
   void RequestData(uint32_t position, uint32_t size) override;
   bool IsDocumentComplete() const override;
@@ -61,6 +61,10 @@ bool TestPDFiumEngine::ReadLoadedBytes(uint32_t length, void* buffer) {
   return true;
 }
 
+base::span<const uint8_t> TestPDFiumEngine::GetLoadedBytes() {
+  return base::span(kLoadedData);
+}
+
 std::vector<uint8_t> TestPDFiumEngine::GetSaveData() {
   return std::vector<uint8_t>(std::begin(kSaveData), std::end(kSaveData));
 }
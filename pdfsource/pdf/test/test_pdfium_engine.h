@@ -9,6 +9,7 @@
 
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/values.h"
 #include "pdf/document_attachment_info.h"
 #include "pdf/document_metadata.h"
@@ -49,6 +50,7 @@ class TestPDFiumEngine : public PDFiumEngine {
               (const gfx::Rect&,
                SkBitmap&,
                std::vector<gfx::Rect>&,
+               std::vector<gfx::Rect>&,
                std::vector<gfx::Rect>&),
               (override));
 
@@ -84,6 +86,8 @@ class TestPDFiumEngine : public PDFiumEngine {
 
   MOCK_METHOD(bool, IsPageVisible, (int), (const override));
 
+  MOCK_METHOD(std::vector<int>, GetVisiblePages, (), (const override));
+
   MOCK_METHOD(gfx::Rect, GetPageContentsRect, (int), (override));
 
   MOCK_METHOD(gfx::Rect, GetPageScreenRect, (int), (const override));
@@ -97,6 +101,8 @@ class TestPDFiumEngine : public PDFiumEngine {
 
   bool ReadLoadedBytes(uint32_t length, void* buffer) override;
 
+  base::span<const uint8_t> GetLoadedBytes() override;
+
   std::vector<uint8_t> GetSaveData() override;
 
   MOCK_METHOD(void, SetCaretPosition, (const gfx::Point&), (override));